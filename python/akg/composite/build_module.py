@@ -634,6 +634,26 @@ def _build_json_list_func(desc_d, attrs, poly, target):
     return func(block_jsons, input_tensor_name, output_tensor_name, alloc_map_list, reuse_map_list, \
                 clean_op_map_list, attrs_list, poly, target)
 
+def _stitch_partition(desc_s, desc_d, attrs):
+    """
+    choose the stitch nodes of a graph which has no fusion info from graph kernel,
+    the graph is then split by stitch_json_split.
+    """
+    if not attrs or not attrs.get('enable_stitch_partition') or \
+            'parallel_fusion' in desc_d or 'buffer_stitch' in desc_d:
+        return
+    stitch_op = tvm.get_global_func("composite_stitch_partition")(desc_s)
+    if stitch_op:
+        desc_d['buffer_stitch'] = {'stitch_op': [[node.value for node in nodes] for nodes in stitch_op]}
+        logging.info("stitch nodes chosen by partition search: %s", desc_d['buffer_stitch']['stitch_op'])
+
+def _set_gpu_target_attrs(attrs):
+    """fill the attrs that describe the gpu of the current device, unless the caller set them"""
+    if 'sm_count' not in attrs:
+        ctx = tvm.gpu(0)
+        if ctx.exist:
+            attrs['sm_count'] = ctx.multi_processor_count
+
 def _build_to_gpu_func(desc_s, desc_d, attrs=None, poly=False):
     """
     build kernel with compute description in json format
@@ -645,6 +665,10 @@ def _build_to_gpu_func(desc_s, desc_d, attrs=None, poly=False):
     Returns:
        Module.
     """
+    if attrs is None:
+        attrs = {'dim': ''}
+    _set_gpu_target_attrs(attrs)
+    _stitch_partition(desc_s, desc_d, attrs)
     if os.getenv('MS_GRAPH_KERNEL_TILING'):
         repository_gpu = read_repo_file(str(os.getenv('MS_GRAPH_KERNEL_TILING')))
     elif 'buffer_stitch' in desc_d:
@@ -659,8 +683,6 @@ def _build_to_gpu_func(desc_s, desc_d, attrs=None, poly=False):
             if not repo:
                 return default
         return repo
-    if attrs is None:
-        attrs = {'dim': ''}
     compute, shape, dtype = generate_trait(desc_d)
     batchmatmul = _is_batchmatmul(desc_d)
     if batchmatmul:
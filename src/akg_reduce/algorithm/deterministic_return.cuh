@@ -0,0 +1,160 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AKG_REDUCE_DETERMINISTIC_RETURN_H
+#define AKG_REDUCE_DETERMINISTIC_RETURN_H
+#include "../utils/util.cuh"
+
+namespace akg_reduce {
+
+/**
+ * @brief Launches of kernels with deterministic return in flight, told apart by the address of their output.
+ * A device runs at most 128 kernels at once, so that the table never fills up.
+ */
+constexpr int MAX_DETERMINISTIC_LAUNCHES = 128;
+
+struct DeterministicLaunches {
+  int lock;
+  unsigned long long keys[MAX_DETERMINISTIC_LAUNCHES];
+  char *workspaces[MAX_DETERMINISTIC_LAUNCHES];
+};
+
+__device__ __forceinline__ DeterministicLaunches &GetDeterministicLaunches() {
+  static DeterministicLaunches launches;
+  return launches;
+}
+
+/**
+ * @brief Workspace of the launch writing to key, the first block of the launch that returns allocates it in the
+ * device heap and clears it.
+ */
+__device__ __forceinline__ char *AcquireDeterministicWorkspace(const unsigned long long key, const size_t bytes) {
+  DeterministicLaunches &launches = GetDeterministicLaunches();
+  volatile unsigned long long *keys = launches.keys;
+  char *volatile *workspaces = launches.workspaces;
+  char *workspace = nullptr;
+  bool done = false;
+  // the lock is taken and released in one branch, so that the threads of a warp never wait for each other.
+  while (!done) {
+    if (atomicCAS(&launches.lock, 0, 1) != 0) {
+      continue;
+    }
+    __threadfence();
+    int free_idx = -1;
+    for (int i = 0; i < MAX_DETERMINISTIC_LAUNCHES && workspace == nullptr; ++i) {
+      if (keys[i] == key) {
+        workspace = workspaces[i];
+      } else if (free_idx < 0 && keys[i] == 0) {
+        free_idx = i;
+      }
+    }
+    if (workspace == nullptr && free_idx >= 0) {
+      workspace = static_cast<char *>(malloc(bytes));
+      if (workspace != nullptr) {
+        memset(workspace, 0, bytes);
+        keys[free_idx] = key;
+        workspaces[free_idx] = workspace;
+      }
+    }
+    __threadfence();
+    atomicExch(&launches.lock, 0);
+    done = true;
+  }
+  if (workspace == nullptr) {
+    // the device heap is exhausted, fail the launch instead of writing wrong results.
+    __trap();
+  }
+  return workspace;
+}
+
+/**
+ * @brief Frees the workspace of the launch writing to key, after all its blocks returned.
+ */
+__device__ __forceinline__ void ReleaseDeterministicWorkspace(const unsigned long long key) {
+  DeterministicLaunches &launches = GetDeterministicLaunches();
+  volatile unsigned long long *keys = launches.keys;
+  char *volatile *workspaces = launches.workspaces;
+  char *workspace = nullptr;
+  bool done = false;
+  while (!done) {
+    if (atomicCAS(&launches.lock, 0, 1) != 0) {
+      continue;
+    }
+    __threadfence();
+    for (int i = 0; i < MAX_DETERMINISTIC_LAUNCHES && workspace == nullptr; ++i) {
+      if (keys[i] == key) {
+        workspace = workspaces[i];
+        workspaces[i] = nullptr;
+        keys[i] = 0;
+      }
+    }
+    __threadfence();
+    atomicExch(&launches.lock, 0);
+    done = true;
+  }
+  free(workspace);
+}
+
+/**
+ * @brief Deterministic return function, from shared memory to global memory without atomic ops on data.
+ *
+ * Every block stores its partial result into a slot of a workspace in global memory, the last arriving block
+ * then combines all the slots of the output by a tree with a fixed shape and writes the output. The result
+ * doesn't depend on the order of blocks, and the output doesn't need to be cleared before launch.
+ * The workspace is allocated per launch, so that launches of the same kernel on different streams don't share it.
+ *
+ * @tparam T                  Dtype: half, float, double, int, signed char, bool;
+ * @tparam ReduceOp           Operators for reduce: SumOp, MaxOp, MinOp, AndOp, OrOp;
+ * @tparam OutputSize         Number of elements of the output tensor;
+ * @tparam ReduceBlocks       Number of blocks combined into one output element;
+ */
+template <typename T, typename ReduceOp, size_t OutputSize, size_t ReduceBlocks>
+__device__ __forceinline__ void AkgDeterministicReturn(const T shared_result, // Reduction result on the shared memory
+                                                       T *output,             // Global output address
+                                                       const ReduceOp op,     // The operator
+                                                       const int output_idx,  // Flattened index of the output
+                                                       const int block_idx    // Index of current block in the reduction
+) {
+  // The slots of every output fill whole cache lines, so that no stale line is cached in L1 before the
+  // last block reads them. They are followed by the arrival counter of every output and the number of
+  // returns of the launch.
+  constexpr size_t SlotStride = AlignedSlotStride(ReduceBlocks, sizeof(T));
+  constexpr size_t SlotBytes = OutputSize * SlotStride * sizeof(T);
+  const unsigned long long key = reinterpret_cast<unsigned long long>(output - output_idx);
+  char *workspace = AcquireDeterministicWorkspace(key, SlotBytes + (OutputSize + 1) * sizeof(unsigned int));
+  unsigned int *arrived = reinterpret_cast<unsigned int *>(workspace + SlotBytes);
+  unsigned int *returned = arrived + OutputSize;
+
+  T *slots = reinterpret_cast<T *>(workspace) + output_idx * SlotStride;
+  slots[block_idx] = shared_result;
+  __threadfence();
+  if (atomicAdd(&arrived[output_idx], 1U) == ReduceBlocks - 1) {
+    __threadfence();
+    for (size_t stride = 1; stride < ReduceBlocks; stride *= 2) {
+      for (size_t i = 0; i + stride < ReduceBlocks; i += 2 * stride) {
+        slots[i] = op(slots[i], slots[i + stride]);
+      }
+    }
+    output[0] = slots[0];
+  }
+  if (atomicAdd(returned, 1U) == OutputSize * ReduceBlocks - 1) {
+    ReleaseDeterministicWorkspace(key);
+  }
+}
+
+}  // namespace akg_reduce
+
+#endif  // AKG_REDUCE_DETERMINISTIC_RETURN_H
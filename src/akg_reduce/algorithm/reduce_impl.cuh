@@ -67,6 +67,28 @@ __inline__ __device__ void ReduceDirectionX(const ReduceOp op,  // The operator
   }
 }
 
+/**
+ * @brief  The enter of reduce2D-X reduction for short rows, one warp segment per row.
+ *         Only selected when IsWarpRowReducible holds for the kernel.
+ *
+ * @tparam T          Dtype: half, float, double, int
+ * @tparam ReduceOp   Operators for reduce: SumOp, MaxOp, MinOp
+ * @tparam BlockDimX  Real blockDim.x, a power of two not greater than 32
+ */
+template <typename T, typename ReduceOp, size_t BlockDimX>
+__inline__ __device__ void ReduceDirectionXWarp(const ReduceOp op,  // The operator
+                                                T *output,          // Addr of output
+                                                const T acc         // Aggregated value in current thread
+) {
+  const int tx = RowLane(blockDim.x * threadIdx.y + threadIdx.x, BlockDimX);
+
+  T result = WarpRowReduce<ReduceOp, BlockDimX>(acc, op);
+
+  if (tx == 0) {
+    output[0] = op(output[0], result);
+  }
+}
+
 /**
  * @brief  The enter of reduce2D-Y reduction.
  * 
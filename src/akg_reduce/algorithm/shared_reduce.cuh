@@ -108,6 +108,43 @@ __device__ __forceinline__ void WarpReduceOneByte(T *shared_buf,    // Shared me
   }
 }
 
+/**
+ * \brief Reduction of rows with at most 32 threads, each row lives in a segment of one warp.
+ *
+ * \par
+ * - Supports 1D or 2D reduction computation. The reduction direction is along x-axis.
+ * - Works on registers only, neither shared memory nor __syncthreads are needed, so a block can
+ * - loop over many short rows cheaply.
+ * - Exclude cases when T == bool/signed char, since shfl.sync funcs only support 16 bits,
+ * - 32 bits and 64 bits.
+ *
+ * \tparam ReduceOp          Reduce operator type
+ * \tparam BlockDimX         Real blockDim.x, a power of two not greater than 32
+ * \tparam T                 Dtype of reduction
+ **/
+template <typename ReduceOp, size_t BlockDimX, typename T>
+__device__ __forceinline__ T WarpRowReduce(const T local_acc, // Aggregated value in current thread
+                                           const ReduceOp op  // Reduce operator
+) {
+  T local_sum = local_acc;
+  if (BlockDimX >= 32) {
+    local_sum = op(local_sum, __shfl_down_sync(0xFFFFFFFF, local_sum, 16, BlockDimX));
+  }
+  if (BlockDimX >= 16) {
+    local_sum = op(local_sum, __shfl_down_sync(0xFFFFFFFF, local_sum, 8, BlockDimX));
+  }
+  if (BlockDimX >= 8) {
+    local_sum = op(local_sum, __shfl_down_sync(0xFFFFFFFF, local_sum, 4, BlockDimX));
+  }
+  if (BlockDimX >= 4) {
+    local_sum = op(local_sum, __shfl_down_sync(0xFFFFFFFF, local_sum, 2, BlockDimX));
+  }
+  if (BlockDimX >= 2) {
+    local_sum = op(local_sum, __shfl_down_sync(0xFFFFFFFF, local_sum, 1, BlockDimX));
+  }
+  return local_sum;
+}
+
 /**
  * \brief Reduction in a block along x axis.
  *
@@ -326,8 +363,15 @@ __device__ __forceinline__ void HalvedReduce2DX(T *shared_buf,     // Shared mem
       shared_buf[tid] = op(shared_buf[tid + UpperBound], shared_buf[tid]);
     }
     __syncthreads();
-    
-    ReduceXInBlock<ReduceOp, UpperBound>(shared_buf, op, tx, ty);
+
+    // rows of BlockDimX threads do not line up with warps, so the rest of the tree stays in shared memory
+    // instead of going through shfl funcs, which need every lane of a warp in the same row.
+    for (int half = UpperBound / 2; half > 0; half /= 2) {
+      if (tx < half) {
+        shared_buf[tid] = op(shared_buf[tid], shared_buf[tid + half]);
+      }
+      __syncthreads();
+    }
   }
 }
 
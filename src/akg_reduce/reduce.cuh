@@ -18,6 +18,7 @@
 #define AKG_REDUCE_H
 #include "./utils/util.cuh"
 #include "./algorithm/reduce_impl.cuh"
+#include "./algorithm/deterministic_return.cuh"
 #include "./operators/reduce_operators.cuh"
 
 namespace akg_reduce {
@@ -32,7 +33,7 @@ namespace akg_reduce {
  * @tparam ReduceOp           Operators for reduce: SumOp, MaxOp, MinOp, AndOp, OrOp
  * @tparam BlockDimX          Real blockDim.x
  * @tparam BlockDimY          Real blockDim.y
- * @tparam ReduceType         Types of reduce: ALL_REDUCE(0), REDUCE2D_X(1), REDUCE2D_Y(2)
+ * @tparam ReduceType         Types of reduce: ALL_REDUCE(0), REDUCE2D_X(1), REDUCE2D_Y(2), REDUCE2D_X_WARP(3)
  */
 template <typename T, typename ReduceOp, size_t BlockDimX, size_t BlockDimY, int ReduceType>
 __inline__ __device__ void AkgReduce(const ReduceOp op,         // The operator
@@ -53,6 +54,12 @@ __inline__ __device__ void AkgReduce(const ReduceOp op,         // The operator
     return;
   }
 
+  // reduce short rows from direction x inside warps
+  if (ReduceType == REDUCE2D_X_WARP) {
+    ReduceDirectionXWarp<T, ReduceOp, BlockDimX>(op, output_array, acc);
+    return;
+  }
+
   // reduce data from direction y
   if (ReduceType == REDUCE2D_Y) {
     ReduceDirectionY<T, ReduceOp, BlockDimX, BlockDimY>(op, output_array, shared_array, acc, sharedmem_x);
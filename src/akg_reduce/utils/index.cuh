@@ -0,0 +1,76 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AKG_REDUCE_INDEX_H
+#define AKG_REDUCE_INDEX_H
+#include <stddef.h>
+
+/*********************************************************
+ * Index math shared by the reduce algorithms.
+ * Free of cuda headers, so that it can be emulated on the host.
+ * ********************************************************/
+#ifdef __CUDACC__
+#define AKG_REDUCE_HOST_DEVICE __host__ __device__
+#else
+#define AKG_REDUCE_HOST_DEVICE
+#endif
+
+namespace akg_reduce {
+
+const int WARPSIZE = 32;
+
+AKG_REDUCE_HOST_DEVICE constexpr bool IsPowOfTwo(const unsigned int num) { return !(num & (num - 1)); }
+
+/**
+ * @brief Largest power of two that is not greater than length.
+ */
+AKG_REDUCE_HOST_DEVICE constexpr int GetUpperBound(const int length, const int upper_bound = 1) {
+  return upper_bound * 2 <= length ? GetUpperBound(length, upper_bound * 2) : upper_bound;
+}
+
+/**
+ * @brief Whether rows of BlockDimX threads can be reduced by shfl functions only.
+ *
+ * Every row has to live in one warp, the whole block has to be made of full warps,
+ * and shfl.sync funcs don't support one byte dtypes.
+ */
+AKG_REDUCE_HOST_DEVICE constexpr bool IsWarpRowReducible(const int block_dim_x, const int block_threads,
+                                                         const int dtype_bytes) {
+  return block_dim_x > 0 && block_dim_x <= WARPSIZE && IsPowOfTwo(block_dim_x) && block_threads % WARPSIZE == 0 &&
+         dtype_bytes > 1;
+}
+
+/**
+ * @brief Position of thread tid inside its row of width threads, used for one-dim mapping.
+ */
+AKG_REDUCE_HOST_DEVICE constexpr int RowLane(const int tid, const int width) { return tid % width; }
+
+/**
+ * @brief Row handled by thread tid, when every row occupies width threads.
+ */
+AKG_REDUCE_HOST_DEVICE constexpr int RowIndex(const int tid, const int width) { return tid / width; }
+
+/**
+ * @brief Elements between the workspace slots of two outputs in AkgDeterministicReturn, rounded up to whole
+ * cache lines of 128 bytes.
+ */
+AKG_REDUCE_HOST_DEVICE constexpr size_t AlignedSlotStride(const size_t reduce_blocks, const size_t dtype_bytes) {
+  return (reduce_blocks * dtype_bytes + 127) / 128 * 128 / dtype_bytes;
+}
+
+}  // namespace akg_reduce
+
+#endif  // AKG_REDUCE_INDEX_H
@@ -19,13 +19,14 @@
 #include <iostream>
 #include <cuda_fp16.h>
 #include <string.h>
+#include "./index.cuh"
 
 namespace akg_reduce {
 
 const int ALL_REDUCE = 0;
 const int REDUCE2D_X = 1;
 const int REDUCE2D_Y = 2;
-const int WARPSIZE = 32;
+const int REDUCE2D_X_WARP = 3;
 
 // Error detection functions
 #ifndef GetGpuErr
@@ -69,18 +70,6 @@ __host__ __device__ T TypeTransform(Y y) {
     return (T)y;
 }
 
-__host__ __device__ constexpr bool IsPowOfTwo(const unsigned int num) { 
-  return !(num & (num - 1)); 
-}
-
-__host__ __device__ constexpr int GetUpperBound(const int length) {
-  int upper_bound = 1;
-  while (upper_bound * 2 <= length) {
-    upper_bound *= 2;
-  }
-  return upper_bound;
-}
-
 }  // namespace akg_reduce
 
 #endif  // AKG_REDUCE_UTIL_H
\ No newline at end of file
@@ -39,6 +39,7 @@ TVM_REGISTER_API("ir_pass.LoopPartitionCCE").set_body([](const TVMArgs args, TVM
 
 REGISTER_PASS(AutoPoly);
 REGISTER_PASS(GenTuningSpace);
+REGISTER_PASS(IslCtxPoolReport);
 REGISTER_PASS(ReplaceSeparator);
 REGISTER_PASS(RewriteMultiValueFunc);
 REGISTER_PASS(RenameRealize);
@@ -51,5 +52,7 @@ REGISTER_PASS(TestCanProveWithPosParam);
 REGISTER_PASS(RemoveFakeOp);
 REGISTER_PASS(InjectDoubleBufferScopeOnGpu);
 REGISTER_PASS(InjectTransferBufferScope);
+REGISTER_PASS(SpecializeKernelVersion);
+REGISTER_PASS(InjectAsyncCopyPipeline);
 }  // namespace ir
 }  // namespace akg
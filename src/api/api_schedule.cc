@@ -23,5 +23,6 @@
 namespace akg {
 namespace schedule {
 TVM_REGISTER_API("schedule.AutoInline").set_body_typed(AutoInline);
+TVM_REGISTER_API("schedule.AutoFuse").set_body_typed(AutoFuse);
 }  // namespace schedule
 }  // namespace akg
@@ -486,7 +486,8 @@ NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeR
   // Phase 0
   Target target_platform = Target::Create(target);
   if (polyhedral && global_attrs.GetBoolAttr(kEnableAutoInline, true)) {
-    akg::schedule::AutoInline(sch, target_platform, global_attrs.GetBoolAttr(kEnableCSE, false));
+    static_cast<void>(akg::schedule::AutoInline(sch, target_platform, global_attrs.GetBoolAttr(kEnableCSE, false),
+                                                global_attrs.GetBoolAttr(kEnableInlineCostModel, false)));
   }
   if (target_platform->device_type == kDLGPU && polyhedral && global_attrs.GetBoolAttr(kEnableAutoFuse, true)) {
     akg::schedule::AutoFuse(sch);
@@ -547,6 +548,9 @@ NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeR
     stmt = NEXT_PASS(CanonicalSimplify, stmt);
 
     // Phase 2
+    if (polyhedral && global_attrs.GetBoolAttr(kEnableMultiVersion, false)) {
+      stmt = NEXT_PASS(SpecializeKernelVersion, stmt);
+    }
     if (!simple_mode) {
       stmt = NEXT_PASS(LoopPartition, stmt, config->partition_const_loop);
     }
@@ -556,12 +560,19 @@ NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeR
       stmt = NEXT_PASS(VectorizeLoop, stmt);
     }
     stmt = NEXT_PASS(InjectVirtualThread, stmt);
-    if (polyhedral && global_attrs.GetBoolAttr(kEnableDoubleBuffer, false)) {
+    // cp.async pipelining is only worth it on targets with asynchronous copies, so it is enabled per kernel.
+    int async_copy_stages = global_attrs.GetIntAttr(kAsyncCopyStages, 0);
+    bool async_copy =
+      polyhedral && async_copy_stages > 1 && !global_attrs.GetBoolAttr(kEnableTransferBuffer, false);
+    if (polyhedral && (global_attrs.GetBoolAttr(kEnableDoubleBuffer, false) || async_copy)) {
       stmt = NEXT_PASS(InjectDoubleBufferScopeOnGpu, stmt);
     }
     if (polyhedral && global_attrs.GetBoolAttr(kEnableTransferBuffer, false)) {
       stmt = NEXT_PASS(InjectTransferBufferScope, stmt);
     }
+    if (async_copy) {
+      stmt = NEXT_PASS(InjectAsyncCopyPipeline, stmt, async_copy_stages);
+    }
     stmt = NEXT_PASS(InjectDoubleBuffer, stmt, config->double_buffer_split_loop,
                      global_attrs.GetBoolAttr(kEnableTransferBuffer, false));
     stmt = NEXT_PASS(StorageRewrite, stmt);
@@ -52,6 +52,8 @@ constexpr auto kEnableBisectOptimize = "enable_bisect_optimize";
 constexpr auto kEnableCoverProtectOptimize = "enable_cover_protect_optimize";
 constexpr auto kEnableDoubleBuffer = "enable_double_buffer";
 constexpr auto kEnableTransferBuffer = "enable_transfer_buffer";
+constexpr auto kEnableMultiVersion = "enable_multi_version";
+constexpr auto kAsyncCopyStages = "async_copy_stages";
 constexpr auto kEnableUnrollLoop = "enable_unroll_loop";
 constexpr auto kAlgebraSimplify = "enable_algebra_simplify";
 constexpr auto kPromoteCommonExpr = "promote_common_expr";
@@ -78,6 +80,7 @@ constexpr auto kAkgTargetHostName = "stackvm";
 constexpr auto kEnableAutoInline = "enable_auto_inline";
 constexpr auto kEnableAutoFuse = "enable_auto_fuse";
 constexpr auto kEnableCSE = "enable_common_subexpr_elim";
+constexpr auto kEnableInlineCostModel = "enable_inline_cost_model";
 constexpr auto kEnableFeatureLibrary = "enable_feature_library";
 constexpr auto kEnableFeatureLibraryPrePoly = "enable_feature_library_pre_poly";
 constexpr auto kEnableHoistCondWrite = "enable_hoist_cond_write";
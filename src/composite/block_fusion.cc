@@ -28,6 +28,12 @@ constexpr int BLOCKIDX_LEN = 9;
 constexpr int THREADX_LEN = 10;
 constexpr int BLOCKIDXX_LEN = 10;
 constexpr int THREADXX_LEN = 11;
+// Above this number of parts, blocks are dispatched by a binary search over the part offsets.
+constexpr size_t LINEAR_DISPATCH_LIMIT = 4;
+// Relative costs used to estimate the work of one thread in a part.
+constexpr int64_t ARITH_COST = 1;
+constexpr int64_t MEM_ACCESS_COST = 4;
+constexpr int64_t CALL_COST = 8;
 struct FuncInfo {
   Stmt stmt;
   Var block;
@@ -36,6 +42,8 @@ struct FuncInfo {
   Var thread;
   std::string origin_thread_name;
   Expr thread_ext = make_const(Int(32), 1);
+  int64_t thread_cost{0};
+  bool block_independent{true};
 };
 
 bool IsVarDefault(const Var &var) { return var->name_hint == "v"; }
@@ -225,6 +233,69 @@ class RemoveDimAttr : public IRMutator {
   }
 };
 
+// Estimate the work of one thread of a part, and whether its threads cooperate inside a block.
+class PartCostEstimator : public IRVisitor {
+ public:
+  void Visit_(const For *op) final {
+    int64_t extent = op->extent.as<IntImm>() ? op->extent.as<IntImm>()->value : 1;
+    int64_t outer = scale_;
+    scale_ *= std::max<int64_t>(extent, 1);
+    IRVisitor::Visit_(op);
+    scale_ = outer;
+  }
+
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key == "storage_scope" && op->value.as<StringImm>()->value == "shared") {
+      block_independent_ = false;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Load *op) final {
+    cost_ += MEM_ACCESS_COST * scale_;
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Store *op) final {
+    cost_ += MEM_ACCESS_COST * scale_;
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Call *op) final {
+    // Barriers, warp shuffles and library calls (e.g. akg_reduce) rely on the threads of one block or warp.
+    if (op->call_type == Call::Extern || op->is_intrinsic(air::ir::intrinsic::tvm_storage_sync) ||
+        op->is_intrinsic(air::ir::intrinsic::tvm_warp_shuffle) ||
+        op->is_intrinsic(air::ir::intrinsic::tvm_thread_allreduce)) {
+      block_independent_ = false;
+    }
+    cost_ += CALL_COST * scale_;
+    IRVisitor::Visit_(op);
+  }
+
+#define COUNT_ARITH(OP)                \
+  void Visit_(const OP *op) final {    \
+    cost_ += ARITH_COST * scale_;      \
+    IRVisitor::Visit_(op);             \
+  }
+  COUNT_ARITH(Add)
+  COUNT_ARITH(Sub)
+  COUNT_ARITH(Mul)
+  COUNT_ARITH(Div)
+  COUNT_ARITH(Mod)
+  COUNT_ARITH(FloorDiv)
+  COUNT_ARITH(FloorMod)
+  COUNT_ARITH(Min)
+  COUNT_ARITH(Max)
+  COUNT_ARITH(Select)
+#undef COUNT_ARITH
+
+  int64_t cost_{0};
+  bool block_independent_{true};
+
+ private:
+  int64_t scale_{1};
+};
+
 class BlockIndexRewrite final : public IRMutator {
  public:
   explicit BlockIndexRewrite(int offset) : offset_(offset) {}
@@ -309,6 +380,51 @@ class LowerBlockFusion {
     }
   }
 
+  void EstimateCost(std::vector<FuncInfo> &funcs_) {
+    for (auto &func : funcs_) {
+      PartCostEstimator estimator;
+      estimator.Visit(func.stmt);
+      func.thread_cost = std::max<int64_t>(estimator.cost_, 1);
+      func.block_independent = estimator.block_independent_;
+    }
+  }
+
+  // Parts whose threads never cooperate do not need their original block shape. Their blocks and threads are
+  // flattened into one index, which is split again over the fused thread extent, so that the surplus threads of
+  // every block are not left idle. Each thread still runs a single iteration of the part.
+  void RemapToFusedThreads(std::vector<FuncInfo> &funcs_, size_t max_thread_num) {
+    if (IsVarDefault(block_var_) || IsVarDefault(thread_var_)) {
+      return;
+    }
+    for (auto &func : funcs_) {
+      int64_t thread_num = func.thread_ext.as<IntImm>()->value;
+      int64_t block_num = func.block_ext.as<IntImm>()->value;
+      if (!func.block_independent || thread_num <= 0 || thread_num >= static_cast<int64_t>(max_thread_num)) {
+        continue;
+      }
+      int64_t max_threads = static_cast<int64_t>(max_thread_num);
+      int64_t total = thread_num * block_num;
+      Expr global_idx = block_var_ * static_cast<int>(max_threads) + thread_var_;
+      std::unordered_map<const Variable *, Expr> vmap;
+      vmap[block_var_.get()] = truncdiv(global_idx, static_cast<int>(thread_num));
+      vmap[thread_var_.get()] = truncmod(global_idx, static_cast<int>(thread_num));
+      func.stmt = Substitute(func.stmt, vmap);
+      if (total % max_threads != 0) {
+        func.stmt = IfThenElse::make(global_idx < static_cast<int>(total), func.stmt);
+      }
+      func.block_ext = make_const(Int(32), (total + max_threads - 1) / max_threads);
+      func.thread_ext = make_const(Int(32), max_threads);
+    }
+  }
+
+  // Blocks are issued roughly in blockIdx order, so placing the parts with the most expensive blocks first lets
+  // the cheap blocks of the other parts fill the SMs behind them instead of waiting on the largest part.
+  void BalanceParts(std::vector<FuncInfo> &funcs_) {
+    std::stable_sort(funcs_.begin(), funcs_.end(), [](const FuncInfo &a, const FuncInfo &b) {
+      return a.thread_cost * a.thread_ext.as<IntImm>()->value > b.thread_cost * b.thread_ext.as<IntImm>()->value;
+    });
+  }
+
   void UpdateOffSet(std::vector<size_t> &block_info, std::vector<size_t> &max_block_info, std::vector<FuncInfo> &funcs_,
                     size_t &max_thread_num, size_t &max_block) {
     for (auto &func : funcs_) {
@@ -329,8 +445,28 @@ class LowerBlockFusion {
     }
   }
 
+  Stmt GuardThread(const size_t &max_thread_num, const FuncInfo &func, const Var &fusion_tx) {
+    int fthread_num = func.thread_ext.as<IntImm>()->value;
+    bool thread_overflow = static_cast<int>(max_thread_num) > fthread_num;
+    return thread_overflow ? IfThenElse::make(fusion_tx < fthread_num, func.stmt) : func.stmt;
+  }
+
+  Stmt DispatchPart(const size_t &max_thread_num, std::vector<FuncInfo> &funcs_, const Var &fusion_bx,
+                    const Var &fusion_tx, const std::vector<size_t> &max_block_info, size_t begin, size_t end) {
+    if (end - begin == 1) {
+      return GuardThread(max_thread_num, funcs_[begin], fusion_tx);
+    }
+    size_t mid = begin + (end - begin) / 2;
+    Stmt first = DispatchPart(max_thread_num, funcs_, fusion_bx, fusion_tx, max_block_info, begin, mid);
+    Stmt second = DispatchPart(max_thread_num, funcs_, fusion_bx, fusion_tx, max_block_info, mid, end);
+    return IfThenElse::make(fusion_bx < static_cast<int>(max_block_info[mid - 1]), first, second);
+  }
+
   Stmt MergeIr(const size_t &max_thread_num, std::vector<FuncInfo> &funcs_, Var fusion_bx, Var fusion_tx,
                const std::vector<size_t> &max_block_info) {
+    if (funcs_.size() > LINEAR_DISPATCH_LIMIT) {
+      return DispatchPart(max_thread_num, funcs_, fusion_bx, fusion_tx, max_block_info, 0, funcs_.size());
+    }
     int fthread_num = funcs_.back().thread_ext.as<IntImm>()->value;
     bool thread_overflow = static_cast<int>(max_thread_num) > fthread_num;
     Stmt res_stmt =
@@ -371,7 +507,14 @@ class LowerBlockFusion {
     // 3.remove dim info
     RemoveDimInfo(funcs_);
 
-    // 4.update offset of blockIdx.x
+    // 4.balance the parts by their estimated cost, then update offset of blockIdx.x
+    EstimateCost(funcs_);
+    size_t max_part_thread = 0;
+    for (const auto &func : funcs_) {
+      max_part_thread = std::max(max_part_thread, static_cast<size_t>(func.thread_ext.as<IntImm>()->value));
+    }
+    RemapToFusedThreads(funcs_, max_part_thread);
+    BalanceParts(funcs_);
     std::vector<size_t> block_info;
     std::vector<size_t> max_block_info;
     size_t max_thread_num = 0;
@@ -392,7 +535,7 @@ class LowerBlockFusion {
     // 5.merge ir with IfThenElse
     // a.update thread_overflow by comparing thread extent with final extent
     // b.update thread condition
-    // c.update block condition
+    // c.update block condition, with a binary search over the offsets when there are many parts
     Stmt res_stmt = MergeIr(max_thread_num, funcs_, fusion_bx, fusion_tx, max_block_info);
 
     // 6.add new dim attr
@@ -1114,7 +1114,9 @@ class CompositeJsonListGpu : public CompositeJsonList {
     std::vector<Expr> loop_extent_array;
     std::vector<GridBlockDims> dim_array;
     std::vector<StitchOpType> ir_type_array;
-    for (auto &stitch_json : Downcast<Array<Expr>>(block_json)) {
+    auto stitch_jsons = Downcast<Array<Expr>>(block_json);
+    for (size_t i = 0; i < stitch_jsons.size(); ++i) {
+      Expr stitch_json = stitch_jsons[i];
       ++each_ir_idx_;
       std::vector<OpDesc> op_v = ParseOpDesc(stitch_json.as<StringImm>()->value);
       using std::placeholders::_1;
@@ -1130,10 +1132,17 @@ class CompositeJsonListGpu : public CompositeJsonList {
       if (each_ir_idx_ == 1) loop_extent_array = stitch_attr_info.loop_extent;
       stitch_attr_info.loop_extent = loop_extent_array;  // only care about loop from first ir.
       dim_array.push_back(dims);                         // save current dims into array.
-      IrAttrInfo ir_attr_info = GetIRAttr(stitch_type, stitch_attr_info, ir_type_array, dim_array, attrs);
+      IrAttrInfo ir_attr_info = GetIRAttr(stitch_type, stitch_attr_info, ir_type_array, dim_array, stitch_attr,
+                                          i + 1 == stitch_jsons.size(), attrs);
       ir_type_array.push_back(stitch_type);  // Note this should be done AFTER GetIrAttr.
       stitch_attr.broadcast_size = ir_attr_info.broadcast_size;
       stitch_attr.switch_x_2_y= ir_attr_info.switch_x_2_y;
+      if (stitch_type == StitchOpType::Matmul) {
+        stitch_attr.matmul_shape = stitch_attr_info.iter_shape;
+        stitch_attr.matmul_tile = GetMatmulBlockTile(stitch_attr_info.iter_shape, ir_attr_info.dims);
+        CHECK(!stitch_attr.matmul_tile.empty()) << "Matmul output can not be evenly tiled by blocks.";
+        stitch_attr.matmul_dims = ir_attr_info.dims;
+      }
       auto new_attrs = BindBlockAndThread(ir_attr_info.dims, poly_, ir_attr_info.attrs);
       auto single_ir =
         String2LowerStmt(stitch_json.as<StringImm>(), new_attrs, ir_attr_info.grid_dims, ir_attr_info.block_dims, true);
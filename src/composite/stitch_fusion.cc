@@ -55,6 +55,83 @@ Var GetReplaceVar(const Var &var, std::unordered_map<std::string, Var> &vars, co
   return replace;
 }
 
+std::vector<int64_t> GetMatmulBlockTile(const Array<Expr> &shape, const GridBlockDims &dims) {
+  // blockIdx.x, blockIdx.y and blockIdx.z map the innermost three axes of the matmul output.
+  std::vector<int> grid = {dims.griddim_x, dims.griddim_y, dims.griddim_z};
+  std::vector<int64_t> tile(shape.size(), 1);
+  for (size_t i = 0; i < shape.size(); ++i) {
+    auto extent = shape[shape.size() - 1 - i].as<IntImm>();
+    int64_t grid_dim = i < grid.size() ? grid[i] : 1;
+    if (extent == nullptr || extent->value % grid_dim != 0) {
+      return {};
+    }
+    tile[shape.size() - 1 - i] = extent->value / grid_dim;
+  }
+  return tile;
+}
+
+std::vector<size_t> ColorBufferIntervals(const std::vector<StitchBufferInterval> &intervals) {
+  std::vector<size_t> order(intervals.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&intervals](size_t a, size_t b) {
+    if (intervals[a].start != intervals[b].start) {
+      return intervals[a].start < intervals[b].start;
+    }
+    return intervals[a].size > intervals[b].size;
+  });
+
+  // last ir using each buffer and its size
+  std::vector<int> buf_end;
+  std::vector<uint64_t> buf_size;
+  std::vector<size_t> slots(intervals.size(), 0);
+  for (auto i : order) {
+    const auto &interval = intervals[i];
+    size_t best = buf_end.size();
+    for (size_t buf = 0; buf < buf_end.size(); ++buf) {
+      if (buf_end[buf] >= interval.start) {
+        continue;
+      }
+      if (best == buf_end.size()) {
+        best = buf;
+        continue;
+      }
+      bool fit = buf_size[buf] >= interval.size;
+      bool best_fit = buf_size[best] >= interval.size;
+      bool smaller_fit = fit && (!best_fit || buf_size[buf] < buf_size[best]);
+      bool larger_unfit = !fit && !best_fit && buf_size[buf] > buf_size[best];
+      if (smaller_fit || larger_unfit) {
+        best = buf;
+      }
+    }
+    if (best == buf_end.size()) {
+      buf_end.push_back(interval.end);
+      buf_size.push_back(interval.size);
+    } else {
+      buf_end[best] = interval.end;
+      buf_size[best] = std::max(buf_size[best], interval.size);
+    }
+    slots[i] = best;
+  }
+  return slots;
+}
+
+// Map the flattened global index of the matmul output to the index inside the tile computed by one block.
+Expr MatmulLocalIndex(const Expr &index, const Array<Expr> &shape, const std::vector<int64_t> &tile) {
+  CHECK_EQ(shape.size(), tile.size());
+  Expr local_index = make_zero(index.type());
+  Expr global_stride = make_const(index.type(), 1);
+  Expr local_stride = make_const(index.type(), 1);
+  for (size_t i = shape.size(); i > 0; --i) {
+    Expr coord = floormod(floordiv(index, global_stride), shape[i - 1]);
+    local_index = local_index + floormod(coord, make_const(index.type(), tile[i - 1])) * local_stride;
+    global_stride = global_stride * shape[i - 1];
+    local_stride = local_stride * make_const(index.type(), tile[i - 1]);
+  }
+  return Simplify(local_index);
+}
+
 struct StoreWithLoopVar {
   Expr old_index;
   std::vector<Var> loopvars;
@@ -245,9 +322,22 @@ class StitchMutate : public IRMutator {
         Var shared = new_buffer ? Var(shared_name) : vars_[shared_name];
         vars_[shared_name] = shared;
         stitch_buffer_map_[shared_name] = info;
+        Expr new_index;
+        if (stitch_type_ == StitchOpType::Matmul) {
+          // one block owns a whole output tile of matmul, so index the tile instead of dropping blockIdx.
+          matmul_bufs_.insert(shared_name);
+          new_index = MatmulLocalIndex(this->Mutate(index), store_attr_.matmul_shape, store_attr_.matmul_tile);
+        } else {
+          // the buffer may be reused by a later subgraph.
+          matmul_bufs_.erase(shared_name);
+        }
         fix_producer_ = true;
-        auto stmt = Store::make(shared, this->Mutate(op->value), this->Mutate(index), op->predicate);
+        Expr value = this->Mutate(op->value);
+        if (!new_index.defined()) {
+          new_index = this->Mutate(index);
+        }
         fix_producer_ = false;
+        auto stmt = Store::make(shared, value, new_index, op->predicate);
         if (!loops_.empty()) {
           CollectStoreWithLoopVar(stmt);
         }
@@ -255,6 +345,9 @@ class StitchMutate : public IRMutator {
         return stmt;
       } else {
         vars_[name] = var;
+        if (stitch_type_ == StitchOpType::Matmul) {
+          matmul_bufs_.insert(name);
+        }
       }
     }
     if (stitch_type_ == StitchOpType::Broadcast)
@@ -279,6 +372,14 @@ class StitchMutate : public IRMutator {
       if (kv.second.name == name || kv.first == name) {
         auto info = kv.second;
         Var replace = GetReplaceVar(var, vars_, kv.first, info);
+        if (info.type == StorageType::Shared && matmul_bufs_.count(info.buf_name)) {
+          index = MatmulLocalIndex(this->Mutate(index), store_attr_.matmul_shape, store_attr_.matmul_tile);
+          return Load::make(op->type, replace, index, op->predicate);
+        }
+        if (info.type == StorageType::Global && matmul_bufs_.count(kv.first)) {
+          // the global matmul output is written with its global index.
+          return Load::make(op->type, replace, this->Mutate(index), op->predicate);
+        }
         if (info.type == StorageType::Shared || info.type == StorageType::Global) {
           fix_consumer_ = true;
           index = this->Mutate(index);
@@ -324,6 +425,8 @@ class StitchMutate : public IRMutator {
  private:
   bool fix_producer_{false};
   bool fix_consumer_{false};
+  // stitch buffers written by a matmul subgraph.
+  std::unordered_set<std::string> matmul_bufs_;
   std::unordered_map<Expr, Expr, air::NodeHash, air::NodeEqual> broadcast_substitute_;
   std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map_;
   std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map_;
@@ -406,22 +509,59 @@ Stmt EmitUnifyIterVars(Stmt &stmt, std::unordered_map<NodeRef, Expr, air::NodeHa
 }
 
 int AvgType(std::vector<StitchOpType> &type_array) {
-  if (type_array.empty()) return 0;
   int sum = 0;
+  int num = 0;
   for (auto &i : type_array) {
+    // matmul subgraphs decide the dims of their epilogues on their own, see GetMatmulIRAttr.
+    if (i == StitchOpType::Matmul) continue;
     sum += static_cast<int>(i);
+    ++num;
+  }
+  return num == 0 ? 0 : sum / num;
+}
+
+IrAttrInfo GetMatmulIRAttr(StitchOpType type, BufferStitchAttr &stitch_attr_info, const StitchAttrInfo &stitch_attr,
+                           bool is_last_ir, IrAttrInfo &ir_attr_info) {
+  // The epilogue reuses the dims of matmul and is tiled as the block tile of matmul, so that each block consumes
+  // the matmul tile it has just produced in the stitch buffer.
+  auto dims = type == StitchOpType::Matmul ? stitch_attr_info.dims : stitch_attr.matmul_dims;
+  ir_attr_info.dims = dims;
+  ir_attr_info.grid_dims = dims.griddim_x * dims.griddim_y * dims.griddim_z;
+  ir_attr_info.block_dims = dims.blockdim_x * dims.blockdim_y * dims.blockdim_z;
+  if (type == StitchOpType::Matmul) {
+    return ir_attr_info;
   }
-  return sum / static_cast<int>(type_array.size());
+  auto tile = GetMatmulBlockTile(stitch_attr_info.iter_shape, dims);
+  CHECK(!tile.empty()) << "Matmul epilogue can not be tiled as matmul blocks.";
+  std::string dim_string;
+  for (size_t i = 0; i < tile.size(); ++i) {
+    std::string tile_size = std::to_string(tile[i]);
+    dim_string += (i == 0 ? "" : " ") + std::string("0 ") + std::to_string(i) + " " + tile_size + " " + tile_size;
+  }
+  ir_attr_info.attrs.Set("dim", StringImm::make(dim_string));
+  if (type >= StitchOpType::Reduce2D_X && ir_attr_info.grid_dims > 1) {
+    // reduce axes of the epilogue may be split between blocks. The partial results of the blocks can only be
+    // combined by atomic add in global memory, never in a shared stitch buffer, and no later ir can wait for them.
+    CHECK(is_last_ir) << "The reduction of a matmul epilogue is split between " << ir_attr_info.grid_dims
+                      << " blocks, it must be the last stitched ir.";
+    ir_attr_info.attrs.Set("enable_atomic_add", Expr(1));
+  }
+  return ir_attr_info;
 }
 
 IrAttrInfo GetIRAttr(StitchOpType type, BufferStitchAttr &stitch_attr_info, std::vector<StitchOpType> &type_array,
-                     std::vector<GridBlockDims> &dim_array, const Map<std::string, NodeRef> &attrs) {
+                     std::vector<GridBlockDims> &dim_array, const StitchAttrInfo &stitch_attr, bool is_last_ir,
+                     const Map<std::string, NodeRef> &attrs) {
   // note: type_array dose NOT include current ir type.
   IrAttrInfo ir_attr_info;
   ir_attr_info.attrs = attrs;
   // In all stitch cases, grid_dims betweem irs are the same.
   auto grid_dims = dim_array[0].griddim_x * dim_array[0].griddim_y * dim_array[0].griddim_z;
   ir_attr_info.grid_dims = grid_dims;
+  if (type == StitchOpType::Matmul ||
+      std::find(type_array.begin(), type_array.end(), StitchOpType::Matmul) != type_array.end()) {
+    return GetMatmulIRAttr(type, stitch_attr_info, stitch_attr, is_last_ir, ir_attr_info);
+  }
 
   switch (type) {
     case StitchOpType::Broadcast:
@@ -19,7 +19,7 @@
 
 namespace akg {
 enum class StorageType { Shared, Global, Unknown };
-enum class StitchOpType { Unknown = -1, Elem, Broadcast, Reduce2D_X, All_Reduce, Reduce2D_Y };
+enum class StitchOpType { Unknown = -1, Elem, Broadcast, Reduce2D_X, All_Reduce, Reduce2D_Y, Matmul };
 
 struct StitchBufferInfo {
   std::string name;
@@ -39,6 +39,11 @@ struct StitchAttrInfo {
   Expr broadcast_size;
   std::vector<StitchOpType> type_array;
   bool switch_x_2_y{false};
+  // output shape of the stitched matmul and the part of it computed by one block.
+  Array<Expr> matmul_shape;
+  std::vector<int64_t> matmul_tile;
+  // dims the stitched matmul ir is lowered with, its epilogues reuse them.
+  GridBlockDims matmul_dims;
 };
 
 struct IrAttrInfo {
@@ -51,6 +56,18 @@ struct IrAttrInfo {
   bool switch_x_2_y{false};
 };
 
+// live range of a stitch buffer, in indexes of the stitched irs, both ends included.
+struct StitchBufferInterval {
+  int start{0};
+  int end{0};
+  uint64_t size{0};
+};
+
+// Pack the live ranges into shared buffers and return the buffer of each one; two intervals share a buffer only if
+// their irs are disjoint. Intervals are taken by start, each goes to the smallest free buffer that holds it, or grows
+// the largest free buffer when none does.
+std::vector<size_t> ColorBufferIntervals(const std::vector<StitchBufferInterval> &intervals);
+
 class StitchBufAlloc : public IRVisitor {
  public:
   explicit StitchBufAlloc(air::DataType data_type = Float(32)) : data_type_(data_type){};
@@ -80,7 +97,6 @@ class StitchBufAlloc : public IRVisitor {
       if (name == "EMPTY") {
         break;
       }
-      auto alloc_info = it.second[0].as<StringImm>()->value;
       auto alloc_size = it.second[1].as<IntImm>()->value;
       std::string ir_var = name;
       StitchBufferInfo info;
@@ -91,65 +107,76 @@ class StitchBufAlloc : public IRVisitor {
       stitch_buffer_map[ir_var] = info;
     }
 
-    for (const auto &it : alloc_map) {
-      std::string name = it.first;
-      auto alloc_info = it.second[0].as<StringImm>()->value;
+    // the reuse suggested by the splitter is replaced by the live ranges of the stitch buffers in stitch_irs.
+    std::vector<StitchBufferInfo> stitch_bufs;
+    std::vector<StitchBufferInterval> intervals;
+    // shared buffers of ops that are revoked and placed in the slot of the stitch buffer, by index in stitch_bufs.
+    std::unordered_map<size_t, std::string> revoked_bufs;
+    auto add_stitch_buffer = [&](const std::string &name, const Array<NodeRef> &alloc, bool revocable) {
       CHECK_GT(total_block_, 0);
-      uint64_t alloc_size_per_block = it.second[1].as<IntImm>()->value / total_block_;
-      // first, check whether variable is already in buf_within_op_map. If NOT, do allocation or reuse.
+      uint64_t alloc_size_per_block = alloc[1].as<IntImm>()->value / total_block_;
       CHECK(outputs2args.find(name) != outputs2args.end());
       std::string ir_var = outputs2args.at(name).as<BufferNode>()->name;
       std::string shared_name = ir_var + "_shared";
-      std::string ir_var_shared;
-      if (buf_within_op_map.find(shared_name) != buf_within_op_map.end()) {
-        ir_var_shared = shared_name;
-      } else {
-        allocated_share_size_ += alloc_size_per_block * data_type_.bytes();
-        ir_var_shared = ir_var + "_shared_stitch";
-      }
-
       StitchBufferInfo info;
       info.name = name;
       info.type = StorageType::Shared;
-      info.buf_name = ir_var_shared;
+      info.buf_name = ir_var;
       info.alloc_size = alloc_size_per_block;
-      stitch_buffer_map[ir_var] = info;
-      buf_alloc_op_[ir_var] = info;
+      std::vector<std::string> accesses = {name, ir_var};
+      auto within_op = buf_within_op_map.find(shared_name);
+      if (within_op != buf_within_op_map.end()) {
+        if (!revocable) {
+          // the op already allocates the tensor in shared memory, keep it.
+          info.buf_name = shared_name;
+          stitch_buffer_map[ir_var] = info;
+          return;
+        }
+        // the splitter suggests reusing a stitch buffer, so the shared buffer of the op moves into the slot.
+        allocated_share_size_ -= within_op->second.alloc_size * data_type_.bytes();
+        allocate_revoke.push_back(shared_name);
+        info.alloc_size = std::max(info.alloc_size, within_op->second.alloc_size);
+        revoked_bufs[stitch_bufs.size()] = shared_name;
+        accesses.push_back(shared_name);
+      }
+      stitch_bufs.push_back(info);
+      intervals.push_back(GetLiveRange(accesses, info.alloc_size));
+    };
+    for (const auto &it : alloc_map) {
+      add_stitch_buffer(it.first, it.second, false);
     }
-
     for (const auto &it : reuse_map) {
-      std::string name = it.first;
-      if (name == "EMPTY") {
+      if (it.first == "EMPTY") {
         break;
       }
-      auto alloc_info = it.second[0].as<StringImm>()->value;
-      uint64_t alloc_size_per_block = it.second[1].as<IntImm>()->value / total_block_;
-      CHECK(outputs2args.find(alloc_info) != outputs2args.end());
-      CHECK(outputs2args.find(name) != outputs2args.end());
-      auto ir_var_reuse = outputs2args.at(alloc_info).as<BufferNode>()->name;
-      auto ir_var = outputs2args.at(name).as<BufferNode>()->name;
-      auto alloc_stitch_info = buf_alloc_op_[ir_var_reuse];
-      std::string shared_name = ir_var + "_shared";
+      add_stitch_buffer(it.first, it.second, true);
+    }
 
-      if (buf_within_op_map.find(shared_name) != buf_within_op_map.end()) {
-        // add replaced buffer into stitch_buffer_map.
-        StitchBufferInfo info;
-        info.name = name;
-        info.type = StorageType::Shared;
-        info.buf_name = alloc_stitch_info.buf_name;
-        info.alloc_size = alloc_size_per_block;
-        stitch_buffer_map[shared_name] = info;
-        // remember to reduce allocated_share_size_ due to reuse.
-        allocated_share_size_ -= alloc_size_per_block * data_type_.bytes();
-        allocate_revoke.push_back(shared_name);
+    auto slots = ColorBufferIntervals(intervals);
+    std::unordered_map<size_t, StitchBufferInfo> slot_infos;
+    for (size_t i = 0; i < stitch_bufs.size(); ++i) {
+      auto &slot_info = slot_infos[slots[i]];
+      if (slot_info.buf_name.empty()) {
+        slot_info = stitch_bufs[i];
+        slot_info.buf_name = stitch_bufs[i].buf_name + "_shared_stitch";
+      }
+      slot_info.alloc_size = std::max(slot_info.alloc_size, stitch_bufs[i].alloc_size);
+    }
+    for (const auto &it : slot_infos) {
+      allocated_share_size_ += it.second.alloc_size * data_type_.bytes();
+      buf_alloc_op_[it.second.buf_name] = it.second;
+    }
+    for (size_t i = 0; i < stitch_bufs.size(); ++i) {
+      const auto &slot_info = slot_infos[slots[i]];
+      StitchBufferInfo info = stitch_bufs[i];
+      info.buf_name = slot_info.buf_name;
+      // the first store of the slot allocates it, so every member carries the size of the whole slot.
+      info.alloc_size = slot_info.alloc_size;
+      stitch_buffer_map[stitch_bufs[i].buf_name] = info;
+      auto revoked = revoked_bufs.find(i);
+      if (revoked != revoked_bufs.end()) {
+        stitch_buffer_map[revoked->second] = info;
       }
-      StitchBufferInfo info;
-      info.name = name;
-      info.type = StorageType::Shared;
-      info.buf_name = alloc_stitch_info.buf_name;
-      info.alloc_size = alloc_size_per_block;
-      stitch_buffer_map[ir_var] = info;
-      buf_alloc_op_.erase(ir_var_reuse);
     }
 
     if (allocated_share_size_ >= MEM_LIMIT) {
@@ -160,10 +187,10 @@ class StitchBufAlloc : public IRVisitor {
                 });
       auto overflow_size = allocated_share_size_ - MEM_LIMIT;
       bool cover_overflow_size = false;
-      std::string moveout_var;
+      std::string moveout_slot;
       for (const auto &iv : reuse_free_map) {
         if (iv.second.alloc_size * data_type_.bytes() >= overflow_size) {
-          moveout_var = iv.first;
+          moveout_slot = iv.first;
           cover_overflow_size = true;
         } else {
           break;
@@ -171,20 +198,14 @@ class StitchBufAlloc : public IRVisitor {
       }
 
       if (cover_overflow_size) {
-        auto moveout_info = stitch_buffer_map[moveout_var];
-        moveout_info.type = StorageType::Global;
-        moveout_info.buf_name = moveout_info.buf_name + "_global";
-        stitch_buffer_map[moveout_var] = moveout_info;
+        MoveOutSlot(moveout_slot);
       }
       if (!cover_overflow_size) {
-        auto covered_size = 0;
+        uint64_t covered_size = 0;
         for (const auto &iv : reuse_free_map) {
-          auto moveout_info = stitch_buffer_map[iv.first];
-          covered_size += iv.second.alloc_size;
-          moveout_info.type = StorageType::Global;
-          moveout_info.buf_name = moveout_info.buf_name + "_global";
-          stitch_buffer_map[iv.first].type = StorageType::Global;
-          if (static_cast<uint64_t>(covered_size) >= overflow_size) {
+          MoveOutSlot(iv.first);
+          covered_size += iv.second.alloc_size * data_type_.bytes();
+          if (covered_size >= overflow_size) {
             break;
           }
         }
@@ -247,7 +268,60 @@ class StitchBufAlloc : public IRVisitor {
     IRVisitor::Visit(op->body);
   }
 
+  void Visit_(const Store *op) final {
+    AddAccess(op->buffer_var->name_hint);
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Load *op) final {
+    AddAccess(op->buffer_var->name_hint);
+    IRVisitor::Visit_(op);
+  }
+
+  void AddAccess(const std::string &name) {
+    auto it = buf_live_range_.find(name);
+    if (it == buf_live_range_.end()) {
+      buf_live_range_[name] = std::make_pair(ir_idx_, ir_idx_);
+    } else {
+      it->second.first = std::min(it->second.first, ir_idx_);
+      it->second.second = std::max(it->second.second, ir_idx_);
+    }
+  }
+
+  // the irs between the first and the last access of the buffer, under any of its names.
+  StitchBufferInterval GetLiveRange(const std::vector<std::string> &names, uint64_t size) {
+    StitchBufferInterval interval;
+    interval.size = size;
+    bool accessed = false;
+    for (const auto &buf : names) {
+      auto it = buf_live_range_.find(buf);
+      if (it == buf_live_range_.end()) {
+        continue;
+      }
+      interval.start = accessed ? std::min(interval.start, it->second.first) : it->second.first;
+      interval.end = accessed ? std::max(interval.end, it->second.second) : it->second.second;
+      accessed = true;
+    }
+    if (!accessed) {
+      // unknown live range, keep the buffer alive in all irs.
+      interval.start = 0;
+      interval.end = ir_idx_;
+    }
+    return interval;
+  }
+
+  void MoveOutSlot(const std::string &slot_name) {
+    for (auto &kv : stitch_buffer_map) {
+      if (kv.second.type == StorageType::Shared && kv.second.buf_name == slot_name) {
+        kv.second.type = StorageType::Global;
+        kv.second.buf_name = kv.second.buf_name + "_global";
+      }
+    }
+  }
+
   air::DataType data_type_;
+  // first and last ir accessing each buffer
+  std::unordered_map<std::string, std::pair<int, int>> buf_live_range_;
   std::unordered_map<std::string, StitchBufferInfo> buf_alloc_op_;
   int ir_idx_ = 0;
   int total_block_ = 0;
@@ -270,9 +344,17 @@ class BufferStitchAttr : public GridBlockDimsAttr {
     for (auto &op : op_v) {
       auto out_shape = op.output_tensor_info[0].shape_;
       auto out_size = GetShapeSize(out_shape);
+      if (IsMatmul(op.op_name)) {
+        // the epilogue ops in the same subgraph keep the matmul tiling, so the subgraph is a matmul one.
+        json_str = json.as<StringImm>();
+        iter_shape = out_shape;
+        SetStitchType(StitchOpType::Matmul);
+        continue;
+      }
       if (IsReduce(op.op_name)) {
         json_str = json.as<StringImm>();
         CHECK_EQ(op.input_tensor_info.size(), 1) << "Number of Input for Reduce op should be only one.";
+        iter_shape = op.input_tensor_info[0].shape_;
         auto reduce_axis = Downcast<Array<Integer>>(op.attrs["axis"]);
         bool reduce_inner = reduce_axis.empty();
         auto innermost_axis = static_cast<int>(op.input_tensor_info[0].shape_.size() - 1);
@@ -296,6 +378,9 @@ class BufferStitchAttr : public GridBlockDimsAttr {
       }
 
       if (IsElemwise(op.op_name)) {
+        if (iter_shape.empty()) {
+          iter_shape = out_shape;
+        }
         for (auto &input : op.input_tensor_info) {
           if (!input.has_value_) {
             if (!EqualShape(input.shape_, out_shape)) {
@@ -336,12 +421,16 @@ class BufferStitchAttr : public GridBlockDimsAttr {
   const std::function<Stmt(const StringImm *, const Map<std::string, NodeRef> &, bool, bool)> func_;
   Expr broadcast_size;
   Expr elemwise_size;
+  // shape of the iteration domain: output shape of matmul or elemwise ops, input shape of reduce ops.
+  Array<Expr> iter_shape;
   std::vector<Expr> loop_extent;
   StitchOpType stitch_type_{StitchOpType::Unknown};
 };
 
+std::vector<int64_t> GetMatmulBlockTile(const Array<Expr> &shape, const GridBlockDims &dims);
 IrAttrInfo GetIRAttr(StitchOpType type, BufferStitchAttr &stitch_attr_info, std::vector<StitchOpType> &type_array,
-                     std::vector<GridBlockDims> &dim_array, const Map<std::string, NodeRef> &attrs);
+                     std::vector<GridBlockDims> &dim_array, const StitchAttrInfo &stitch_attr, bool is_last_ir,
+                     const Map<std::string, NodeRef> &attrs);
 Stmt StitchFusionGpu(std::vector<Stmt> &stitch_irs, StitchAttrInfo &store_attr,
                   std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map,
                   std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map,
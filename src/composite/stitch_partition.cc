@@ -0,0 +1,245 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <tvm/api_registry.h>
+#include "composite/util.h"
+
+namespace akg {
+namespace {
+// At most 2^12 combinations of optional stitch nodes are scored, the rest are never chosen.
+constexpr size_t MAX_OPTIONAL_CANDIDATES = 12;
+constexpr int64_t MAX_GRID_DIM = 65535;
+
+struct PartitionTensor {
+  std::string name;
+  int64_t bytes{0};
+  int producer{-1};
+  std::vector<int> consumers;
+  bool is_output{false};
+};
+
+struct PartitionScore {
+  int64_t global_bytes{0};
+  size_t stitch_num{0};
+  bool operator<(const PartitionScore &other) const {
+    return global_bytes != other.global_bytes ? global_bytes < other.global_bytes : stitch_num < other.stitch_num;
+  }
+};
+
+/*!
+ * \brief Choose the stitch nodes of a composite graph. Reduce outputs consumed by broadcast and matmul outputs
+ *  must be stitched, any other multi-used intermediate may be. Each candidate set is scored by the global memory
+ *  traffic of the stitched kernel: the subgraph of a stitch node is the backward closure of it, so graph inputs
+ *  are re-read by every subgraph that needs them, and stitch buffers that do not fit in shared memory go through
+ *  global memory.
+ */
+class StitchPartitioner {
+ public:
+  explicit StitchPartitioner(const std::string &json_str) : json_str_(json_str) {}
+
+  Array<NodeRef> Run() {
+    BuildGraph();
+    CollectCandidates();
+    if (must_stitch_.empty()) {
+      return {};
+    }
+    EstimateBlockNum();
+    std::vector<std::string> best = must_stitch_;
+    PartitionScore best_score = Score(best);
+    size_t optional_num = std::min(optional_.size(), MAX_OPTIONAL_CANDIDATES);
+    for (uint64_t mask = 1; mask < (static_cast<uint64_t>(1) << optional_num); ++mask) {
+      std::vector<std::string> stitch_nodes = must_stitch_;
+      for (size_t i = 0; i < optional_num; ++i) {
+        if (mask & (static_cast<uint64_t>(1) << i)) {
+          stitch_nodes.push_back(optional_[i]);
+        }
+      }
+      auto score = Score(stitch_nodes);
+      if (score < best_score) {
+        best_score = score;
+        best = stitch_nodes;
+      }
+    }
+    std::sort(best.begin(), best.end(), [this](const std::string &a, const std::string &b) {
+      return tensors_[a].producer < tensors_[b].producer;
+    });
+    Array<NodeRef> stitch_op;
+    for (const auto &name : best) {
+      stitch_op.push_back(Array<Expr>{StringImm::make(name)});
+    }
+    return stitch_op;
+  }
+
+ private:
+  static int64_t ShapeSize(const Array<Expr> &shape) {
+    int64_t size = 1;
+    for (const auto &dim : shape) {
+      CHECK(dim.as<IntImm>()) << "Stitch partition only supports static shapes.";
+      size *= dim.as<IntImm>()->value;
+    }
+    return size;
+  }
+
+  void BuildGraph() {
+    op_descs_ = ParseOpDesc(json_str_);
+    for (size_t i = 0; i < op_descs_.size(); ++i) {
+      const auto &op = op_descs_[i];
+      for (const auto &input : op.input_tensor_info) {
+        if (input.has_value_) continue;
+        AddTensor(input).consumers.push_back(static_cast<int>(i));
+      }
+      for (const auto &output : op.output_tensor_info) {
+        AddTensor(output).producer = static_cast<int>(i);
+      }
+    }
+    picojson::value v = String2Json(json_str_);
+    const picojson::object &obj = v.get<picojson::object>();
+    auto it = obj.find("output_desc");
+    if (it != obj.end() && it->second.is<picojson::array>()) {
+      for (const auto &output : it->second.get<picojson::array>()) {
+        auto name = output.get<picojson::object>().at("tensor_name").get<std::string>();
+        if (tensors_.count(name)) {
+          tensors_[name].is_output = true;
+        }
+      }
+    }
+  }
+
+  PartitionTensor &AddTensor(const TensorInfo &info) {
+    auto &tensor = tensors_[info.name_];
+    if (tensor.name.empty()) {
+      tensor.name = info.name_;
+      tensor.bytes = ShapeSize(info.shape_) * info.dtype_.bytes();
+      shapes_[info.name_] = info.shape_;
+    }
+    return tensor;
+  }
+
+  bool IsBroadcastSource(const std::string &name, int consumer) {
+    const auto &op = op_descs_[consumer];
+    return IsElemwise(op.op_name) && !EqualShape(shapes_[name], op.output_tensor_info[0].shape_);
+  }
+
+  void CollectCandidates() {
+    for (const auto &op : op_descs_) {
+      if (op.output_tensor_info.empty()) continue;
+      const auto &name = op.output_tensor_info[0].name_;
+      const auto &tensor = tensors_[name];
+      if (tensor.consumers.empty()) continue;
+      bool must = IsMatmul(op.op_name);
+      if (IsReduce(op.op_name)) {
+        must = std::any_of(tensor.consumers.begin(), tensor.consumers.end(),
+                           [this, &name](int consumer) { return IsBroadcastSource(name, consumer); });
+        if (must && first_reduce_output_.empty()) {
+          first_reduce_output_ = name;
+        }
+      }
+      if (must) {
+        must_stitch_.push_back(name);
+      } else if (tensor.consumers.size() > 1) {
+        optional_.push_back(name);
+      }
+    }
+    // larger tensors save more traffic when they are kept, so they are searched first.
+    std::stable_sort(optional_.begin(), optional_.end(), [this](const std::string &a, const std::string &b) {
+      return tensors_[a].bytes > tensors_[b].bytes;
+    });
+  }
+
+  void EstimateBlockNum() {
+    // every block of a stitched kernel owns some rows of the first reduce.
+    block_num_ = 1;
+    if (!first_reduce_output_.empty()) {
+      block_num_ = std::max<int64_t>(1, std::min(ShapeSize(shapes_[first_reduce_output_]), MAX_GRID_DIM));
+    }
+  }
+
+  PartitionScore Score(const std::vector<std::string> &stitch_nodes) {
+    std::unordered_set<std::string> stitch_set(stitch_nodes.begin(), stitch_nodes.end());
+    PartitionScore score;
+    score.stitch_num = stitch_nodes.size();
+    // each stitch node and the final outputs close one subgraph.
+    std::vector<std::vector<std::string>> subgraph_outputs;
+    for (const auto &name : stitch_nodes) {
+      subgraph_outputs.push_back({name});
+    }
+    std::vector<std::string> final_outputs;
+    for (const auto &kv : tensors_) {
+      if (kv.second.is_output && !stitch_set.count(kv.first)) {
+        final_outputs.push_back(kv.first);
+      }
+    }
+    subgraph_outputs.push_back(final_outputs);
+    for (const auto &outputs : subgraph_outputs) {
+      score.global_bytes += GraphInputBytes(outputs, stitch_set);
+    }
+    // stitch buffers stay in shared memory in topological order until the capacity is used up.
+    std::vector<std::string> ordered(stitch_nodes);
+    std::sort(ordered.begin(), ordered.end(), [this](const std::string &a, const std::string &b) {
+      return tensors_[a].producer < tensors_[b].producer;
+    });
+    int64_t shared_bytes = 0;
+    for (const auto &name : ordered) {
+      int64_t bytes_per_block = (tensors_[name].bytes + block_num_ - 1) / block_num_;
+      if (shared_bytes + bytes_per_block <= MEM_LIMIT) {
+        shared_bytes += bytes_per_block;
+      } else {
+        score.global_bytes += 2 * tensors_[name].bytes;
+      }
+    }
+    return score;
+  }
+
+  int64_t GraphInputBytes(const std::vector<std::string> &outputs, const std::unordered_set<std::string> &stitch_set) {
+    int64_t bytes = 0;
+    std::unordered_set<std::string> visited;
+    std::vector<std::string> stack(outputs);
+    while (!stack.empty()) {
+      auto name = stack.back();
+      stack.pop_back();
+      if (visited.count(name)) continue;
+      visited.insert(name);
+      const auto &tensor = tensors_[name];
+      if (tensor.producer < 0) {
+        bytes += tensor.bytes;
+        continue;
+      }
+      for (const auto &input : op_descs_[tensor.producer].input_tensor_info) {
+        if (input.has_value_) continue;
+        // inputs produced by other stitch nodes are read from the stitch buffer.
+        if (stitch_set.count(input.name_) && std::find(outputs.begin(), outputs.end(), input.name_) == outputs.end()) {
+          continue;
+        }
+        stack.push_back(input.name_);
+      }
+    }
+    return bytes;
+  }
+
+  std::string json_str_;
+  std::vector<OpDesc> op_descs_;
+  std::unordered_map<std::string, PartitionTensor> tensors_;
+  std::unordered_map<std::string, Array<Expr>> shapes_;
+  std::vector<std::string> must_stitch_;
+  std::vector<std::string> optional_;
+  std::string first_reduce_output_;
+  int64_t block_num_{1};
+};
+}  // namespace
+
+Array<NodeRef> StitchPartition(const std::string &json_str) { return StitchPartitioner(json_str).Run(); }
+
+TVM_REGISTER_GLOBAL("composite_stitch_partition").set_body_typed(StitchPartition);
+}  // namespace akg
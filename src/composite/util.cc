@@ -52,6 +52,7 @@ bool IsReduce(const std::string &op_name) {
   std::unordered_set<std::string> elems = {"ReduceSum", "ReduceMax", "ReduceMin"};
   return elems.find(op_name) != elems.end();
 }
+bool IsMatmul(const std::string &op_name) { return op_name == "Matmul" || op_name == "BatchMatMul"; }
 bool IsTransform(const std::string &op_name) {
   // if topi support more, add to this list
   std::unordered_set<std::string> elems = {"Reshape", "ExpandDims", "Squeeze", "Flatten", "ProccessNode"};
@@ -46,6 +46,7 @@ bool IsThreadIdxY(const std::string &name);
 bool IsThreadIdxZ(const std::string &name);
 picojson::value String2Json(const std::string &json_str);
 bool IsReduce(const std::string &op_name);
+bool IsMatmul(const std::string &op_name);
 bool IsTransform(const std::string &op_name);
 bool IsInplaceAssign(const std::string &op_name);
 bool IsAssign(const std::string &op_name);
@@ -101,6 +102,7 @@ struct OpDesc {
   std::vector<TensorInfo> input_tensor_info;
   std::vector<TensorInfo> output_tensor_info;
 };
+std::vector<OpDesc> ParseOpDesc(const std::string &json_str);
 
 struct Graph {
   FuncRefGraph pre_graph;
@@ -74,6 +74,12 @@ Array<NodeRef> AutoPoly(const Stmt &body, const Map<Tensor, Buffer> &extern_buff
 NodeRef GenTuningSpace(const Stmt &body, std::string target, const Map<Tensor, Buffer> &extern_buffer,
                        const Map<std::string, NodeRef> &attrs, const bool is_specgemm, Schedule sch = Schedule());
 
+/*!
+ * \brief Isl contexts allocated and reused by the AutoPoly and GenTuningSpace calls of the current thread,
+ *  and the compile time saved by reusing them.
+ */
+std::string IslCtxPoolReport();
+
 Expr CastNormalize(const Expr &expr, const air::DataType cast_type);
 
 Stmt InjectDoubleBufferScopeOnGpu(Stmt stmt);
@@ -86,6 +92,26 @@ Stmt InjectDoubleBufferScopeOnGpu(Stmt stmt);
  * \return The statement after transformed.
  */
 Stmt InjectTransferBufferScope(Stmt stmt);
+/*!
+ * \brief Emit a guard-free version of each GPU kernel whose remainder guards only fail on the last block along
+ * blockIdx.x. The kernel is split into a main launch over the leading blocks, with the guards removed, and a tail
+ * launch over the last block that keeps them. The host function dispatches both launches after SplitHostDevice.
+ *
+ * \param stmt The statement to be transformed.
+ * \return The statement after transformed.
+ */
+Stmt SpecializeKernelVersion(const Stmt &stmt);
+/*!
+ * \brief Pipeline the shared memory fetches marked by InjectDoubleBufferScopeOnGpu over up to \p stages buffers with
+ * cp.async, so that the fetches of the next stages - 1 iterations overlap the computation of the current one. The
+ * number of stages is reduced until the extra buffers fit in the shared memory of a block. Fetches that are not plain
+ * copies are left to InjectDoubleBuffer.
+ *
+ * \param stmt The statement to be transformed.
+ * \param stages The maximum number of stages.
+ * \return The statement after transformed.
+ */
+Stmt InjectAsyncCopyPipeline(const Stmt &stmt, int stages);
 /*!
  * \brief Simplify expr using custom cce simplifiers.
  *
@@ -23,7 +23,14 @@
 
 namespace akg {
 namespace schedule {
-TVM_DLL void AutoInline(air::Schedule sch, const air::Target &target, bool enable_cse);
+/*!
+ * \brief Inline the injective ops of the schedule. On gpu, enable_cost_model weighs the recomputation of each
+ *  candidate against the traffic of its buffer.
+ * \return the decision of the cost model for each candidate op, by op name.
+ */
+TVM_DLL air::Map<std::string, air::Map<std::string, air::Expr>> AutoInline(air::Schedule sch,
+                                                                         const air::Target &target, bool enable_cse,
+                                                                         bool enable_cost_model = false);
 
 TVM_DLL void AutoFuse(air::Schedule sch);
 }  // namespace schedule
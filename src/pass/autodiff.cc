@@ -14,7 +14,13 @@
  * limitations under the License.
  */
 #include "pass/autodiff.h"
+#include <tvm/attrs.h>
 #include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+
+#include <sstream>
+#include <unordered_set>
+
 #include "ir_pass.h"
 #include "pass/autodiff_cce.h"
 #include "pass/zero_elimination.h"
@@ -357,6 +363,189 @@ Tensor DiffBuildingBlock(const Tensor &output, const Tensor &input, const Tensor
   return result;
 }
 
+namespace {
+/*!
+ * \brief Structural hash of a compute op. The axes and the reduction vars are hashed by position and the constants by
+ *  value, tensors and free vars by node. Equal hashes do not imply equal ops, SameCompute confirms the match.
+ */
+size_t ComputeHash(const ComputeOpNode *op) {
+  std::unordered_map<const Variable *, size_t> bound;
+  for (const auto &iv : op->axis) {
+    bound.emplace(iv->var.get(), bound.size());
+  }
+  for (const auto &body : op->body) {
+    air::ir::PostOrderVisit(body, [&bound](const NodeRef &node) {
+      if (auto reduce = node.as<Reduce>()) {
+        for (const auto &iv : reduce->axis) {
+          bound.emplace(iv->var.get(), bound.size());
+        }
+      }
+    });
+  }
+  size_t hash = dmlc::HashCombine(std::hash<std::string>()(op->tag), air::AttrsHash()(op->attrs));
+  auto visit = [&hash, &bound](const NodeRef &node) {
+    hash = dmlc::HashCombine(hash, std::hash<std::string>()(node->GetTypeKey()));
+    if (auto expr = node.as<air::BaseExprNode>()) {
+      hash = dmlc::HashCombine(hash, air::AttrsHash()(expr->type));
+    }
+    if (auto imm = node.as<IntImm>()) {
+      hash = dmlc::HashCombine(hash, imm->value);
+    } else if (auto imm = node.as<UIntImm>()) {
+      hash = dmlc::HashCombine(hash, imm->value);
+    } else if (auto imm = node.as<FloatImm>()) {
+      hash = dmlc::HashCombine(hash, imm->value);
+    } else if (auto imm = node.as<StringImm>()) {
+      hash = dmlc::HashCombine(hash, imm->value);
+    } else if (auto var = node.as<Variable>()) {
+      auto it = bound.find(var);
+      hash = it != bound.end() ? dmlc::HashCombine(hash, it->second)
+                               : dmlc::HashCombine(hash, static_cast<const Node *>(var));
+    } else if (auto call = node.as<Call>()) {
+      hash = dmlc::HashCombine(hash, call->name);
+      hash = dmlc::HashCombine(hash, call->func.get());
+      hash = dmlc::HashCombine(hash, call->value_index);
+    }
+  };
+  for (const auto &iv : op->axis) {
+    air::ir::PostOrderVisit(iv->dom->min, visit);
+    air::ir::PostOrderVisit(iv->dom->extent, visit);
+  }
+  for (const auto &body : op->body) {
+    air::ir::PostOrderVisit(body, visit);
+  }
+  return hash;
+}
+
+// Two compute ops are the same when their bodies are equal once the axes of b are replaced by the axes of a.
+bool SameCompute(const ComputeOpNode *a, const ComputeOpNode *b) {
+  if (a->tag != b->tag || !air::AttrsEqual()(a->attrs, b->attrs) || a->axis.size() != b->axis.size() ||
+      a->body.size() != b->body.size()) {
+    return false;
+  }
+  std::unordered_map<const Variable *, Expr> vmap;
+  for (size_t i = 0; i < a->axis.size(); ++i) {
+    if (!Equal(a->axis[i]->dom->min, b->axis[i]->dom->min) ||
+        !Equal(a->axis[i]->dom->extent, b->axis[i]->dom->extent)) {
+      return false;
+    }
+    vmap[b->axis[i]->var.get()] = a->axis[i]->var;
+  }
+  // the reduction vars are tied by Equal itself.
+  for (size_t i = 0; i < a->body.size(); ++i) {
+    if (!Equal(a->body[i], Substitute(b->body[i], vmap))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief Hash-consing of the tensors built by Differentiate. Compute ops whose bodies are identical up to the names of
+ *  their vars, that read the same tensors, are represented by one tensor, so a sub-Jacobian shared by several
+ *  consumers is computed once. Sharing a tensor stores it, refusing to share recomputes it in each consumer, and the
+ *  total size of the shared tensors is bounded by the checkpoint budget (negative means unbounded).
+ */
+class AdjointHashCons {
+ public:
+  AdjointHashCons(const std::unordered_set<Tensor> &forward, int64_t checkpoint_bytes)
+      : forward_(forward), checkpoint_bytes_(checkpoint_bytes) {}
+
+  Tensor Share(const Tensor &tensor) {
+    if (!tensor.defined() || forward_.count(tensor) || checkpoint_bytes_ == 0) {
+      return tensor;
+    }
+    auto it = repr_.find(tensor);
+    if (it != repr_.end()) {
+      return it->second;
+    }
+    Tensor res = tensor;
+    if (auto compute = tensor->op.as<ComputeOpNode>()) {
+      std::unordered_map<Tensor, Tensor> rmap;
+      for (const auto &input : compute->InputTensors()) {
+        Tensor shared = Share(input);
+        if (!shared.same_as(input)) {
+          rmap[input] = shared;
+        }
+      }
+      Operation op = rmap.empty() ? tensor->op : compute->ReplaceInputs(tensor->op, rmap);
+      Operation found = Canonical(op, &ops_);
+      if (!found.same_as(op) && Store(found)) {
+        op = found;
+      }
+      res = op.output(tensor->value_index);
+    }
+    repr_[tensor] = res;
+    return res;
+  }
+
+  // Whether a tensor already built may be read by one more consumer, it is stored if so.
+  bool Reuse(const Tensor &tensor) { return forward_.count(tensor) || Store(tensor->op); }
+
+  // Two calls of fdiff on identical outputs with the same input and head give identical results.
+  std::string DiffKey(const Tensor &output, const Tensor &input, const Tensor &head) {
+    std::ostringstream os;
+    os << Canonical(output->op, &diff_ops_).get() << "#" << output->value_index << "#" << input.get() << "#"
+       << head.get();
+    return os.str();
+  }
+
+ private:
+  using OpBuckets = std::unordered_map<size_t, std::vector<Operation>>;
+
+  // The first op seen that is the same as op, op itself if there is none.
+  Operation Canonical(const Operation &op, OpBuckets *buckets) {
+    auto compute = op.as<ComputeOpNode>();
+    if (compute == nullptr) {
+      return op;
+    }
+    auto &bucket = (*buckets)[ComputeHash(compute)];
+    for (const auto &candidate : bucket) {
+      if (candidate.same_as(op) || SameCompute(candidate.as<ComputeOpNode>(), compute)) {
+        return candidate;
+      }
+    }
+    bucket.push_back(op);
+    return op;
+  }
+
+  bool Store(const Operation &op) {
+    if (stored_.count(op.get())) {
+      return true;
+    }
+    if (checkpoint_bytes_ < 0) {
+      stored_.insert(op.get());
+      return true;
+    }
+    int64_t bytes = 0;
+    for (int i = 0; i < op->num_outputs(); ++i) {
+      int64_t size = op->output_dtype(i).bytes();
+      for (const auto &dim : op->output_shape(i)) {
+        auto imm = dim.as<IntImm>();
+        if (imm == nullptr) {
+          return false;
+        }
+        size *= imm->value;
+      }
+      bytes += size;
+    }
+    if (stored_bytes_ + bytes > checkpoint_bytes_) {
+      return false;
+    }
+    stored_bytes_ += bytes;
+    stored_.insert(op.get());
+    return true;
+  }
+
+  const std::unordered_set<Tensor> &forward_;
+  int64_t checkpoint_bytes_;
+  int64_t stored_bytes_{0};
+  std::unordered_map<Tensor, Tensor> repr_;
+  OpBuckets ops_;
+  OpBuckets diff_ops_;
+  std::unordered_set<const Node *> stored_;
+};
+}  // namespace
+
 DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &inputs, const Tensor &head_or_null,
                                     const Map<std::string, NodeRef> &attrs, const Array<Tensor> &new_pld_array,
                                     const FDiffBuildingBlock &fdiff, const Map<Tensor, Array<Tensor>> &override_deps) {
@@ -410,6 +599,19 @@ DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &i
     }
   }
 
+  AttrMap in_attrs;
+  if (attrs.defined()) {
+    in_attrs = attrs;
+  }
+
+  // Identical adjoint parts are shared while they fit in the checkpoint budget, in bytes, and recomputed beyond it.
+  std::unordered_set<Tensor> forward({output});
+  for (const auto &pair : reverse_dependencies) {
+    forward.insert(pair.first);
+  }
+  AdjointHashCons hash_cons(forward, in_attrs.GetIntAttr("ad_checkpoint_bytes", -1));
+  std::unordered_map<std::string, Tensor> diff_cache;
+
   // Individual summands of the adjoints
   std::unordered_map<Tensor, Map<Tensor, Tensor>> summands;
 
@@ -422,7 +624,7 @@ DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &i
   // tensor, adds it to the map, and returns it
   std::function<Tensor(const Tensor &)> compute_adjoint;
   compute_adjoint = [&compute_adjoint, &adjoints, &summands, &reverse_dependencies, &fdiff, &attrs, &new_pld_array,
-                     &head, &output](const Tensor &tensor) {
+                     &head, &output, &hash_cons, &diff_cache](const Tensor &tensor) {
     if (!adjoints.count(tensor)) {
       // Here the adjoint hasn't been computed yet
       Tensor res_adjoint;
@@ -433,19 +635,28 @@ DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &i
         Array<Expr> result_shape(head->shape.begin(),
                                  head->shape.end() + static_cast<size_t>(0 - output->shape.size()));
         std::copy(tensor->shape.begin(), tensor->shape.end(), std::back_inserter(result_shape.CopyOnWrite()->data));
-        res_adjoint = topi::full(result_shape, output->dtype, make_zero(output->dtype));
+        res_adjoint = hash_cons.Share(topi::full(result_shape, output->dtype, make_zero(output->dtype)));
       } else {
         // The new adjoint is computed as a sum of the reverse dependencies' adjoints multiplied
         // by the corresponding "local" jacobians (dDep/dTensor). The computation of the jacobian
         // and the multiplication is done in the function fdiff (DiffBuildingBlock by default).
         for (const Tensor &dep : deps) {
-          Tensor part = fdiff(dep, tensor, compute_adjoint(dep), attrs, new_pld_array);
+          Tensor dep_adjoint = compute_adjoint(dep);
+          std::string diff_key = hash_cons.DiffKey(dep, tensor, dep_adjoint);
+          auto cached = diff_cache.find(diff_key);
+          Tensor part;
+          if (cached != diff_cache.end() && hash_cons.Reuse(cached->second)) {
+            part = cached->second;
+          } else {
+            part = hash_cons.Share(fdiff(dep, tensor, dep_adjoint, attrs, new_pld_array));
+            diff_cache[diff_key] = part;
+          }
           if (res_adjoint.get()) {
             if (res_adjoint->dtype != part->dtype) {
-              res_adjoint = topi::cast(res_adjoint, part->dtype);
+              res_adjoint = hash_cons.Share(topi::cast(res_adjoint, part->dtype));
             }
           }
-          res_adjoint = res_adjoint.get() ? topi::add(res_adjoint, part) : part;
+          res_adjoint = res_adjoint.get() ? hash_cons.Share(topi::add(res_adjoint, part)) : part;
 
           // Add this part to summands
           auto &summands_of_adjoint = summands[tensor];
@@ -477,11 +688,6 @@ DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &i
   // Compute an adjoint for each input
   std::transform(inputs.begin(), inputs.end(), std::back_inserter(result.CopyOnWrite()->data), compute_adjoint);
 
-  AttrMap in_attrs;
-  if (attrs.defined()) {
-    in_attrs = attrs;
-  }
-
   bool tensor_optimize_ = (in_attrs.GetIntAttr("tensor_optimize", 0) != 0);
   if (!tensor_optimize_) {
     return DifferentiationResultNode::make(result, adjoints, summands);
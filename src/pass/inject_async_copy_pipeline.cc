@@ -0,0 +1,508 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/arithmetic.h>
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <tvm/ir_visitor.h>
+#include <ir_pass.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace akg {
+namespace ir {
+namespace {
+constexpr auto kCpAsync = "akg_cp_async";
+constexpr auto kCpAsyncCommit = "akg_cp_async_commit";
+constexpr auto kCpAsyncWait = "akg_cp_async_wait";
+constexpr auto kPromoteVectorization = "promote_vectorization";
+constexpr auto kSharedScope = "shared";
+// static shared memory of one block
+constexpr int64_t kSharedMemoryBudget = 49152;
+
+bool IsCpAsyncBytes(int64_t bytes) { return bytes == 4 || bytes == 8 || bytes == 16; }
+
+bool IsUnitRamp(const Expr &index) {
+  auto ramp = index.as<Ramp>();
+  return ramp == nullptr || is_one(ramp->stride);
+}
+
+Expr RampBase(const Expr &index) {
+  auto ramp = index.as<Ramp>();
+  return ramp != nullptr ? ramp->base : index;
+}
+
+Stmt MakeCpAsync(const Var &dst, const Expr &dst_index, const Var &src, const Expr &src_index, const Type &type,
+                 int64_t bytes) {
+  auto address_of = [&type](const Var &buf, const Expr &index) {
+    return Call::make(Handle(), air::ir::intrinsic::tvm_address_of,
+                      {Load::make(type, buf, index, const_true(1))}, Call::PureIntrinsic);
+  };
+  return Evaluate::make(Call::make(Int(32), kCpAsync,
+                                   {address_of(dst, dst_index), address_of(src, src_index),
+                                    make_const(Int(32), bytes)},
+                                   Call::Extern));
+}
+
+Stmt MakeCommitGroup() { return Evaluate::make(Call::make(Int(32), kCpAsyncCommit, {}, Call::Extern)); }
+
+Stmt MakeWaitGroup(int pending) {
+  return Evaluate::make(Call::make(Int(32), kCpAsyncWait, {make_const(Int(32), pending)}, Call::Extern));
+}
+
+Stmt MakeSharedSync() {
+  return Evaluate::make(Call::make(Int(32), air::ir::intrinsic::tvm_storage_sync, {StringImm::make(kSharedScope)},
+                                   Call::Intrinsic));
+}
+
+/*!
+ * \brief Turn the global to shared copies of one fetch block into cp.async calls that write the given stage of the
+ *  pipelined buffers. Any store that is not a plain copy of 4, 8 or 16 bytes fails the whole block.
+ */
+class AsyncCopyRewriter : public IRMutator {
+ public:
+  AsyncCopyRewriter(const std::unordered_map<const Variable *, Expr> &strides,
+                    const std::unordered_set<const Variable *> &local_buffers, const Expr &stage)
+      : strides_(strides), local_buffers_(local_buffers), stage_(stage) {}
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == kPromoteVectorization) {
+      // the vectorized copy is issued as one cp.async, the vectorize hint must not leak to the next loop.
+      Stmt body = Mutate(op->body);
+      if (body.as<For>() == nullptr) {
+        return body;
+      }
+      return AttrStmt::make(op->node, op->attr_key, op->value, body);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    auto store = op->body.as<Store>();
+    auto extent = op->extent.as<IntImm>();
+    if (store == nullptr || extent == nullptr || store->value.type().lanes() != 1) {
+      return IRMutator::Mutate_(op, s);
+    }
+    auto load = store->value.as<Load>();
+    int64_t bytes = extent->value * store->value.type().bits() / 8;
+    if (load == nullptr || !IsCpAsyncBytes(bytes) || !IsCopy(store, load)) {
+      return IRMutator::Mutate_(op, s);
+    }
+    Array<Expr> dst = air::arith::DetectLinearEquation(store->index, {op->loop_var});
+    Array<Expr> src = air::arith::DetectLinearEquation(load->index, {op->loop_var});
+    if (dst.size() != 2 || src.size() != 2 || !is_one(dst[0]) || !is_one(src[0])) {
+      return IRMutator::Mutate_(op, s);
+    }
+    std::unordered_map<const Variable *, Expr> vmap{{op->loop_var.get(), op->min}};
+    ++copy_num_;
+    return MakeCpAsync(store->buffer_var, air::ir::Substitute(store->index, vmap) + Offset(store->buffer_var),
+                       load->buffer_var, air::ir::Substitute(load->index, vmap), load->type, bytes);
+  }
+
+  Stmt Mutate_(const Store *op, const Stmt &s) final {
+    auto load = op->value.as<Load>();
+    int64_t bytes = op->value.type().bits() * op->value.type().lanes() / 8;
+    if (load == nullptr || !IsCpAsyncBytes(bytes) || !IsCopy(op, load) || !IsUnitRamp(op->index) ||
+        !IsUnitRamp(load->index)) {
+      failed_ = true;
+      return s;
+    }
+    ++copy_num_;
+    return MakeCpAsync(op->buffer_var, RampBase(op->index) + Offset(op->buffer_var), load->buffer_var,
+                       RampBase(load->index), load->type.element_of(), bytes);
+  }
+
+  bool failed_{false};
+  int copy_num_{0};
+
+ private:
+  bool IsCopy(const Store *store, const Load *load) {
+    return strides_.count(store->buffer_var.get()) && !local_buffers_.count(load->buffer_var.get()) &&
+           (!store->predicate.defined() || is_one(store->predicate)) &&
+           (!load->predicate.defined() || is_one(load->predicate));
+  }
+
+  Expr Offset(const Var &buf) { return stage_ * strides_.at(buf.get()); }
+
+  const std::unordered_map<const Variable *, Expr> &strides_;
+  const std::unordered_set<const Variable *> &local_buffers_;
+  Expr stage_;
+};
+
+/*!
+ * \brief Count the accesses of one buffer. Every read goes through Load or tvm_access_ptr, any other use of the
+ *  buffer var is counted as raw and keeps the buffer out of the pipeline.
+ */
+class BufferAccessCounter : public IRVisitor {
+ public:
+  explicit BufferAccessCounter(const Variable *buf) : buf_(buf) {}
+
+  void Visit_(const Load *op) final {
+    reads_ += op->buffer_var.get() == buf_;
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Store *op) final {
+    writes_ += op->buffer_var.get() == buf_;
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Call *op) final {
+    if (op->is_intrinsic(air::ir::intrinsic::tvm_access_ptr) && op->args[1].as<Variable>() == buf_) {
+      ++reads_;
+      for (size_t i = 2; i < op->args.size(); ++i) {
+        Visit(op->args[i]);
+      }
+      return;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Variable *op) final { raw_ += op == buf_; }
+
+  int reads_{0};
+  int writes_{0};
+  int raw_{0};
+
+ private:
+  const Variable *buf_;
+};
+
+struct FetchSite {
+  const AttrStmt *attr{nullptr};
+  // an IfThenElse between the loop and the fetch makes the number of committed groups data dependent.
+  bool conditional{false};
+  std::unordered_set<const Variable *> let_vars;
+};
+
+struct PipelineLoop {
+  std::vector<FetchSite> sites;
+  std::vector<const Variable *> buffers;
+  int stages{0};
+};
+
+struct BufferEntry {
+  std::string scope;
+  int64_t elements{-1};
+  int64_t bytes{-1};
+};
+
+/*!
+ * \brief Collect the double buffer scopes marked by InjectDoubleBufferScopeOnGpu, grouped by the innermost loop
+ *  that carries them.
+ */
+class PipelineCandidateCollector : public IRVisitor {
+ public:
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key == air::ir::attr::storage_scope) {
+      scopes_[op->node.as<Variable>()] = op->value.as<StringImm>()->value;
+    } else if (op->attr_key == air::ir::attr::double_buffer_scope && !frames_.empty()) {
+      FetchSite site;
+      site.attr = op;
+      site.conditional = frames_.back().conditional > 0;
+      site.let_vars = frames_.back().let_vars;
+      loops_[frames_.back().loop].sites.push_back(site);
+      if (std::find(loop_order_.begin(), loop_order_.end(), frames_.back().loop) == loop_order_.end()) {
+        loop_order_.push_back(frames_.back().loop);
+      }
+      return;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Allocate *op) final {
+    BufferEntry entry;
+    entry.scope = scopes_.count(op->buffer_var.get()) ? scopes_[op->buffer_var.get()] : "";
+    int32_t size = op->constant_allocation_size();
+    if (size > 0) {
+      entry.elements = static_cast<int64_t>(size) * op->type.lanes();
+      entry.bytes = entry.elements * op->type.bits() / 8;
+    }
+    buffers_[op->buffer_var.get()] = entry;
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const For *op) final {
+    frames_.push_back(Frame{op, 0, {}});
+    IRVisitor::Visit_(op);
+    frames_.pop_back();
+  }
+
+  void Visit_(const IfThenElse *op) final {
+    if (!frames_.empty()) ++frames_.back().conditional;
+    IRVisitor::Visit_(op);
+    if (!frames_.empty()) --frames_.back().conditional;
+  }
+
+  void Visit_(const LetStmt *op) final {
+    if (frames_.empty()) {
+      IRVisitor::Visit_(op);
+      return;
+    }
+    Visit(op->value);
+    frames_.back().let_vars.insert(op->var.get());
+    Visit(op->body);
+    frames_.back().let_vars.erase(op->var.get());
+  }
+
+  std::unordered_map<const Variable *, std::string> scopes_;
+  std::unordered_map<const Variable *, BufferEntry> buffers_;
+  std::unordered_map<const For *, PipelineLoop> loops_;
+  std::vector<const For *> loop_order_;
+
+ private:
+  struct Frame {
+    const For *loop;
+    int conditional;
+    std::unordered_set<const Variable *> let_vars;
+  };
+  std::vector<Frame> frames_;
+};
+
+/*!
+ * \brief Software pipeline the shared memory fetches of a loop over N stages with cp.async. The fetches of the first
+ *  N - 1 iterations are issued before the loop, and iteration k issues the fetch of iteration k + N - 1 at the place
+ *  of the original fetch, then waits until the group of iteration k has landed. Every fetch site commits one group
+ *  per iteration, empty or not, so the number of groups in flight is static.
+ *  cp.async.wait_group only orders the copies of the issuing thread, so the pass does not rely on the barriers of
+ *  the original double buffer: a shared barrier before each issue keeps the overwritten stage from being read by a
+ *  slower thread, and a shared barrier after each wait makes the copies of all threads visible.
+ */
+class AsyncCopyPipelineInjector : public IRMutator {
+ public:
+  explicit AsyncCopyPipelineInjector(int max_stages) : max_stages_(max_stages) {}
+
+  Stmt Inject(const Stmt &stmt) {
+    collector_.Visit(stmt);
+    for (const auto &kv : collector_.buffers_) {
+      if (kv.second.scope != kSharedScope) {
+        local_buffers_.insert(kv.first);
+      }
+    }
+    int64_t shared_bytes = 0;
+    for (const auto &kv : collector_.buffers_) {
+      if (kv.second.scope == kSharedScope && kv.second.bytes > 0) {
+        shared_bytes += kv.second.bytes;
+      }
+    }
+    for (auto loop : collector_.loop_order_) {
+      auto &info = collector_.loops_[loop];
+      if (!Accept(stmt, loop, &info)) {
+        continue;
+      }
+      int64_t stage_bytes = 0;
+      for (auto buf : info.buffers) {
+        stage_bytes += collector_.buffers_[buf].bytes;
+      }
+      int64_t fit = 1 + (kSharedMemoryBudget - shared_bytes) / stage_bytes;
+      info.stages = static_cast<int>(std::min<int64_t>(max_stages_, fit));
+      if (info.stages < 2) {
+        continue;
+      }
+      shared_bytes += (info.stages - 1) * stage_bytes;
+      for (auto buf : info.buffers) {
+        const auto &entry = collector_.buffers_[buf];
+        strides_[buf] = make_const(Int(32), entry.elements);
+        stages_[buf] = info.stages;
+      }
+      for (const auto &site : info.sites) {
+        sites_.insert(site.attr);
+      }
+      pipelines_[loop] = &info;
+    }
+    if (pipelines_.empty()) {
+      return stmt;
+    }
+    return air::ir::ConvertSSA(Mutate(stmt));
+  }
+
+  Stmt Mutate_(const Allocate *op, const Stmt &s) final {
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    auto it = stages_.find(op->buffer_var.get());
+    if (it == stages_.end()) {
+      return stmt;
+    }
+    op = stmt.as<Allocate>();
+    Array<Expr> extents{make_const(op->extents[0].type(), it->second)};
+    for (const auto &e : op->extents) {
+      extents.push_back(e);
+    }
+    return Allocate::make(op->buffer_var, op->type, extents, op->condition, op->body, op->new_expr,
+                          op->free_function);
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    auto it = pipelines_.find(op);
+    if (it == pipelines_.end()) {
+      return IRMutator::Mutate_(op, s);
+    }
+    const PipelineLoop &info = *it->second;
+    Expr stages = make_const(op->loop_var.type(), info.stages);
+    Expr iter = op->loop_var - op->min;
+    for (auto buf : info.buffers) {
+      read_stage_[buf] = truncmod(iter, stages);
+    }
+    const For *outer_loop = loop_;
+    int outer_pending = pending_groups_;
+    loop_ = op;
+    pending_groups_ = static_cast<int>(info.sites.size()) * (info.stages - 1);
+    Stmt body = Mutate(op->body);
+    loop_ = outer_loop;
+    pending_groups_ = outer_pending;
+    for (auto buf : info.buffers) {
+      read_stage_.erase(buf);
+    }
+
+    // the stages may still be read by the previous run of the loop.
+    std::vector<Stmt> prologue{MakeSharedSync()};
+    for (int stage = 0; stage < info.stages - 1; ++stage) {
+      Expr ahead = make_const(op->loop_var.type(), stage);
+      for (const auto &site : info.sites) {
+        Stmt fetch = MakeFetch(site.attr->body, op->loop_var, op->min + ahead, ahead);
+        prologue.push_back(IfThenElse::make(ahead < op->extent, fetch));
+        prologue.push_back(MakeCommitGroup());
+      }
+    }
+    Stmt loop = For::make(op->loop_var, op->min, op->extent, op->for_type, op->device_api, body);
+    return Block::make(Block::make(prologue), loop);
+  }
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key != air::ir::attr::double_buffer_scope || !sites_.count(op)) {
+      return IRMutator::Mutate_(op, s);
+    }
+    CHECK(loop_ != nullptr);
+    Expr stages = make_const(loop_->loop_var.type(), stages_[op->node.as<Variable>()]);
+    Expr next = loop_->loop_var - loop_->min + stages - make_const(stages.type(), 1);
+    Stmt fetch = MakeFetch(op->body, loop_->loop_var, loop_->loop_var + stages - make_const(stages.type(), 1),
+                           truncmod(next, stages));
+    return Block::make({MakeSharedSync(), IfThenElse::make(next < loop_->extent, fetch), MakeCommitGroup(),
+                        MakeWaitGroup(pending_groups_), MakeSharedSync()});
+  }
+
+  Expr Mutate_(const Load *op, const Expr &e) final {
+    Expr expr = IRMutator::Mutate_(op, e);
+    auto it = read_stage_.find(op->buffer_var.get());
+    if (it == read_stage_.end()) {
+      return expr;
+    }
+    op = expr.as<Load>();
+    return Load::make(op->type, op->buffer_var, StageIndex(op->buffer_var.get(), op->index), op->predicate);
+  }
+
+  Expr Mutate_(const Call *op, const Expr &e) final {
+    Expr expr = IRMutator::Mutate_(op, e);
+    op = expr.as<Call>();
+    if (!op->is_intrinsic(air::ir::intrinsic::tvm_access_ptr) || !op->args[1].as<Variable>() ||
+        !read_stage_.count(op->args[1].as<Variable>())) {
+      return expr;
+    }
+    Array<Expr> args(op->args);
+    args.Set(2, op->args[2] + read_stage_[op->args[1].as<Variable>()] * strides_[op->args[1].as<Variable>()]);
+    return Call::make(op->type, op->name, args, op->call_type, op->func, op->value_index);
+  }
+
+ private:
+  bool Accept(const Stmt &root, const For *loop, PipelineLoop *info) {
+    if (auto extent = loop->extent.as<IntImm>()) {
+      if (extent->value < 2) return false;
+    }
+    std::unordered_map<const Variable *, int> site_writes;
+    for (const auto &site : info->sites) {
+      auto buf = site.attr->node.as<Variable>();
+      auto entry = collector_.buffers_.find(buf);
+      if (site.conditional || entry == collector_.buffers_.end() || entry->second.scope != kSharedScope ||
+          entry->second.bytes <= 0) {
+        return false;
+      }
+      bool use_let = false;
+      air::ir::PostOrderVisit(site.attr->body, [&use_let, &site](const NodeRef &node) {
+        if (auto var = node.as<Variable>()) use_let = use_let || site.let_vars.count(var);
+      });
+      if (use_let) return false;
+      if (std::find(info->buffers.begin(), info->buffers.end(), buf) == info->buffers.end()) {
+        info->buffers.push_back(buf);
+      }
+    }
+    std::unordered_map<const Variable *, Expr> strides;
+    for (auto buf : info->buffers) {
+      strides[buf] = make_const(Int(32), 0);
+    }
+    for (const auto &site : info->sites) {
+      AsyncCopyRewriter rewriter(strides, local_buffers_, make_const(Int(32), 0));
+      rewriter.Mutate(site.attr->body);
+      if (rewriter.failed_ || rewriter.copy_num_ == 0) {
+        return false;
+      }
+      for (auto buf : info->buffers) {
+        BufferAccessCounter counter(buf);
+        counter.Visit(site.attr->body);
+        site_writes[buf] += counter.writes_;
+      }
+    }
+    // the buffers must be written by the fetches only and read inside the loop only.
+    for (auto buf : info->buffers) {
+      BufferAccessCounter in_root(buf);
+      in_root.Visit(root);
+      BufferAccessCounter in_loop(buf);
+      in_loop.Visit(GetRef<Stmt>(loop));
+      if (in_root.raw_ != 0 || in_root.reads_ != in_loop.reads_ || in_root.writes_ != site_writes[buf]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  Stmt MakeFetch(const Stmt &fetch, const Var &loop_var, const Expr &iter, const Expr &stage) {
+    std::unordered_map<const Variable *, Expr> vmap{{loop_var.get(), iter}};
+    AsyncCopyRewriter rewriter(strides_, local_buffers_, stage);
+    Stmt stmt = rewriter.Mutate(air::ir::Substitute(fetch, vmap));
+    CHECK(!rewriter.failed_);
+    return stmt;
+  }
+
+  Expr StageIndex(const Variable *buf, const Expr &index) {
+    Expr offset = read_stage_[buf] * strides_[buf];
+    if (index.type().lanes() > 1) {
+      offset = Broadcast::make(offset, index.type().lanes());
+    }
+    return offset + index;
+  }
+
+  int max_stages_;
+  PipelineCandidateCollector collector_;
+  std::unordered_set<const Variable *> local_buffers_;
+  std::unordered_map<const For *, const PipelineLoop *> pipelines_;
+  std::unordered_set<const AttrStmt *> sites_;
+  std::unordered_map<const Variable *, Expr> strides_;
+  std::unordered_map<const Variable *, int> stages_;
+  std::unordered_map<const Variable *, Expr> read_stage_;
+  const For *loop_{nullptr};
+  int pending_groups_{0};
+};
+}  // namespace
+
+Stmt InjectAsyncCopyPipeline(const Stmt &stmt, int stages) {
+  if (stages < 2) {
+    return stmt;
+  }
+  return AsyncCopyPipelineInjector(stages).Inject(stmt);
+}
+}  // namespace ir
+}  // namespace akg
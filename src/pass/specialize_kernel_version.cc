@@ -0,0 +1,243 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/arithmetic.h>
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <tvm/ir_visitor.h>
+#include <ir_pass.h>
+
+#include <unordered_map>
+
+namespace akg {
+namespace ir {
+namespace {
+constexpr auto kBlockIdxX = "blockIdx.x";
+
+/*!
+ * \brief Collect the launch dimensions (thread_extent attrs) of one kernel.
+ */
+class LaunchDimCollector : public IRVisitor {
+ public:
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key == air::ir::attr::thread_extent) {
+      const IterVarNode *iv = op->node.as<IterVarNode>();
+      CHECK(iv);
+      dom_map_.Set(iv->var, Range::make_by_min_extent(0, op->value));
+      if (iv->thread_tag == kBlockIdxX) {
+        block_x_ = GetRef<IterVar>(iv);
+        block_x_extent_ = op->value;
+      }
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  Map<Var, Range> dom_map_;
+  IterVar block_x_;
+  Expr block_x_extent_;
+};
+
+/*!
+ * \brief Drop the guards that always hold when blockIdx.x stays below the last block, while they
+ *  can fail on the last block. Guards that hold on every block are left to the later simplifier.
+ */
+class TailGuardEliminator : public IRMutator {
+ public:
+  TailGuardEliminator(const Map<Var, Range> &dom_map, const Var &block_x, int64_t main_blocks)
+      : dom_map_(dom_map), block_x_(block_x), main_blocks_(main_blocks) {}
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    dom_map_.Set(op->loop_var, Range::make_by_min_extent(op->min, op->extent));
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const LetStmt *op, const Stmt &s) final {
+    let_map_[op->var.get()] = op->value;
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    let_map_.erase(op->var.get());
+    return stmt;
+  }
+
+  Stmt Mutate_(const IfThenElse *op, const Stmt &s) final {
+    Expr cond = op->condition;
+    if (auto call = cond.as<Call>()) {
+      if (call->is_intrinsic(Call::likely)) {
+        cond = call->args[0];
+      }
+    }
+    cond = air::ir::Substitute(cond, let_map_);
+    if (!CanProve(cond, false) && CanProve(cond, true)) {
+      ++eliminated_;
+      return Mutate(op->then_case);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  int eliminated_{0};
+
+ private:
+  bool CanProve(const Expr &cond, bool restrict_block) {
+    air::arith::Analyzer analyzer;
+    for (const auto &kv : dom_map_) {
+      if (restrict_block && kv.first.same_as(block_x_)) {
+        analyzer.Bind(kv.first, Range::make_by_min_extent(0, static_cast<int>(main_blocks_)));
+      } else {
+        analyzer.Bind(kv.first, kv.second);
+      }
+    }
+    return analyzer.CanProve(cond);
+  }
+
+  Map<Var, Range> dom_map_;
+  Var block_x_;
+  int64_t main_blocks_;
+  std::unordered_map<const Variable *, Expr> let_map_;
+};
+
+/*!
+ * \brief Reset the extent of one launch dimension, optionally binding it to another iter var.
+ */
+class LaunchDimRewriter : public IRMutator {
+ public:
+  LaunchDimRewriter(const IterVar &iv, const IterVar &new_iv, int64_t extent)
+      : iv_(iv), new_iv_(new_iv), extent_(extent) {}
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == air::ir::attr::thread_extent && op->node.same_as(iv_)) {
+      Stmt body = Mutate(op->body);
+      return AttrStmt::make(new_iv_, op->attr_key, make_const(op->value.type(), extent_), body);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+ private:
+  IterVar iv_;
+  IterVar new_iv_;
+  int64_t extent_;
+};
+
+/*!
+ * \brief Give every buffer allocated inside a kernel a fresh var, so that the copy of a kernel
+ *  does not share allocations with the original one in StorageRewrite.
+ */
+class AllocateRenamer : public IRMutator {
+ public:
+  Stmt Rename(const Stmt &s) {
+    air::ir::PostOrderVisit(s, [this](const NodeRef &node) {
+      if (auto op = node.as<Allocate>()) {
+        vmap_[op->buffer_var.get()] = Var(op->buffer_var->name_hint + "_tail", op->buffer_var.type());
+      }
+    });
+    return Mutate(s);
+  }
+
+  Expr Mutate_(const Variable *op, const Expr &e) final {
+    auto it = vmap_.find(op);
+    return it != vmap_.end() ? Expr(it->second) : e;
+  }
+
+  Expr Mutate_(const Load *op, const Expr &e) final {
+    Expr expr = IRMutator::Mutate_(op, e);
+    op = expr.as<Load>();
+    auto it = vmap_.find(op->buffer_var.get());
+    if (it == vmap_.end()) {
+      return expr;
+    }
+    return Load::make(op->type, it->second, op->index, op->predicate);
+  }
+
+  Stmt Mutate_(const Store *op, const Stmt &s) final {
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    op = stmt.as<Store>();
+    auto it = vmap_.find(op->buffer_var.get());
+    if (it == vmap_.end()) {
+      return stmt;
+    }
+    return Store::make(it->second, op->value, op->index, op->predicate);
+  }
+
+  Stmt Mutate_(const Allocate *op, const Stmt &s) final {
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    op = stmt.as<Allocate>();
+    auto it = vmap_.find(op->buffer_var.get());
+    CHECK(it != vmap_.end());
+    return Allocate::make(it->second, op->type, op->extents, op->condition, op->body, op->new_expr,
+                          op->free_function);
+  }
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    op = stmt.as<AttrStmt>();
+    auto var = op->node.as<Variable>();
+    if (var == nullptr || vmap_.count(var) == 0) {
+      return stmt;
+    }
+    return AttrStmt::make(vmap_[var], op->attr_key, op->value, op->body);
+  }
+
+ private:
+  std::unordered_map<const Variable *, Var> vmap_;
+};
+
+/*!
+ * \brief Emit two versions of each kernel whose remainder guards only fail on the last block of
+ *  blockIdx.x: a guard-free main kernel over the leading blocks and the original, guarded kernel
+ *  for the last block. Both are launched from the host function after SplitHostDevice.
+ */
+class KernelVersionSpecializer : public IRMutator {
+ public:
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key != air::ir::attr::thread_extent) {
+      return IRMutator::Mutate_(op, s);
+    }
+    LaunchDimCollector collector;
+    collector.Visit(s);
+    if (!collector.block_x_.defined()) {
+      return s;
+    }
+    auto extent = collector.block_x_extent_.as<IntImm>();
+    if (extent == nullptr || extent->value <= 1) {
+      return s;
+    }
+    int64_t main_blocks = extent->value - 1;
+    IterVar block_x = collector.block_x_;
+
+    TailGuardEliminator eliminator(collector.dom_map_, block_x->var, main_blocks);
+    Stmt main_kernel = eliminator.Mutate(s);
+    if (eliminator.eliminated_ == 0) {
+      return s;
+    }
+    IterVar main_iv = IterVarNode::make(Range::make_by_min_extent(0, static_cast<int>(main_blocks)), block_x->var,
+                                        block_x->iter_type, block_x->thread_tag);
+    main_kernel = LaunchDimRewriter(block_x, main_iv, main_blocks).Mutate(main_kernel);
+
+    Var tail_var(block_x->var->name_hint, block_x->var.type());
+    IterVar tail_iv =
+      IterVarNode::make(Range::make_by_min_extent(0, 1), tail_var, block_x->iter_type, block_x->thread_tag);
+    Stmt tail_kernel = air::ir::Substitute(
+      s, Map<Var, Expr>{{block_x->var, tail_var + make_const(tail_var.type(), main_blocks)}});
+    tail_kernel = LaunchDimRewriter(block_x, tail_iv, 1).Mutate(tail_kernel);
+    tail_kernel = AllocateRenamer().Rename(tail_kernel);
+
+    return Block::make(main_kernel, tail_kernel);
+  }
+};
+}  // namespace
+
+Stmt SpecializeKernelVersion(const Stmt &stmt) { return KernelVersionSpecializer().Mutate(stmt); }
+}  // namespace ir
+}  // namespace akg
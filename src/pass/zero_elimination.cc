@@ -28,6 +28,8 @@
 #include <op/op_util.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <map>
 #include <set>
 #include <utility>
@@ -1488,8 +1490,9 @@ Expr SimplifyRemainder(const Expr &expr) {
 
 // Rewrite the system of inequalities using Fourier-Motzkin elimination
 // Note that variable ranges help a lot, so this parameter is even non-optional
-SolveSystemOfInequalitiesResult SolveSystemOfInequalities(const Array<Expr> &inequalities, const Array<Var> &variables,
-                                                          const Map<Var, Range> &vranges) {
+SolveSystemOfInequalitiesResult SolveSystemOfInequalitiesFourierMotzkin(const Array<Expr> &inequalities,
+                                                                        const Array<Var> &variables,
+                                                                        const Map<Var, Range> &vranges) {
   SolveSystemOfInequalitiesResult res;
   res.variables = variables;
 
@@ -1738,6 +1741,74 @@ SolveSystemOfInequalitiesResult SolveSystemOfInequalities(const Array<Expr> &ine
   return res;
 }
 
+enum class InequalitySolver { FOURIER_MOTZKIN, ISL, COMPARE };
+
+// The backend is chosen by AKG_INEQUALITY_SOLVER: "isl", "compare", or Fourier-Motzkin by default.
+InequalitySolver GetInequalitySolver() {
+  static const InequalitySolver solver = []() {
+    const char *env = std::getenv("AKG_INEQUALITY_SOLVER");
+    std::string name = env != nullptr ? env : "";
+    if (name == "isl") {
+      return InequalitySolver::ISL;
+    } else if (name == "compare") {
+      return InequalitySolver::COMPARE;
+    }
+    return InequalitySolver::FOURIER_MOTZKIN;
+  }();
+  return solver;
+}
+
+// Check that the results of both backends describe the same set, and report the time each of them takes.
+SolveSystemOfInequalitiesResult CompareInequalitySolvers(const Array<Expr> &inequalities, const Array<Var> &variables,
+                                                         const Map<Var, Range> &vranges) {
+  auto start = std::chrono::steady_clock::now();
+  SolveSystemOfInequalitiesResult fm_res = SolveSystemOfInequalitiesFourierMotzkin(inequalities, variables, vranges);
+  auto fm_end = std::chrono::steady_clock::now();
+  SolveSystemOfInequalitiesResult isl_res;
+  bool affine = SolveSystemOfInequalitiesIsl(inequalities, variables, vranges, &isl_res);
+  auto isl_end = std::chrono::steady_clock::now();
+  auto fm_us = std::chrono::duration_cast<std::chrono::microseconds>(fm_end - start).count();
+  auto isl_us = std::chrono::duration_cast<std::chrono::microseconds>(isl_end - fm_end).count();
+  if (!affine) {
+    LOG(INFO) << "SolveSystemOfInequalities: fourier-motzkin " << fm_us
+              << "us, isl failed on a system that is not affine or has coefficients out of 64 bits";
+    return fm_res;
+  }
+  Array<Expr> fm_conds = fm_res.as_conditions();
+  Array<Expr> isl_conds = isl_res.as_conditions();
+  auto implies = [&vranges](const Array<Expr> &from, const Array<Expr> &to) {
+    Expr premise = All(from);
+    return std::all_of(to.begin(), to.end(),
+                       [&premise, &vranges](const Expr &c) { return CanProve(Or::make(Not::make(premise), c), vranges); });
+  };
+  bool same = implies(fm_conds, isl_conds) && implies(isl_conds, fm_conds);
+  LOG(INFO) << "SolveSystemOfInequalities: fourier-motzkin " << fm_us << "us, " << fm_conds.size() << " conditions; isl "
+            << isl_us << "us, " << isl_conds.size() << " conditions";
+  if (!same) {
+    LOG(WARNING) << "SolveSystemOfInequalities backends disagree (or the difference cannot be proven) on "
+                 << inequalities << "\n  fourier-motzkin: " << fm_conds << "\n  isl: " << isl_conds;
+  }
+  return fm_res;
+}
+
+SolveSystemOfInequalitiesResult SolveSystemOfInequalities(const Array<Expr> &inequalities, const Array<Var> &variables,
+                                                          const Map<Var, Range> &vranges) {
+  switch (GetInequalitySolver()) {
+    case InequalitySolver::ISL: {
+      SolveSystemOfInequalitiesResult res;
+      if (SolveSystemOfInequalitiesIsl(inequalities, variables, vranges, &res)) {
+        return res;
+      }
+      // ISL only takes affine systems.
+      return SolveSystemOfInequalitiesFourierMotzkin(inequalities, variables, vranges);
+    }
+    case InequalitySolver::COMPARE:
+      return CompareInequalitySolvers(inequalities, variables, vranges);
+    default:
+      return SolveSystemOfInequalitiesFourierMotzkin(inequalities, variables, vranges);
+  }
+}
+
 // Deskew the given domain
 DomainTransformation DeskewDomain(const Domain &domain) {
   // Resulting ranges will contain ranges for the new variables and for the variables that are
@@ -2465,6 +2536,19 @@ TVM_REGISTER_API("ir_pass.SolveSystemOfInequalities").set_body([](const TVMArgs
   *ret = SolveSystemOfInequalities(args[0], args[1], args[2]).as_conditions();
 });
 
+TVM_REGISTER_API("ir_pass.SolveSystemOfInequalitiesFourierMotzkin")
+  .set_body([](const TVMArgs args, TVMRetValue *ret) {
+    *ret = SolveSystemOfInequalitiesFourierMotzkin(args[0], args[1], args[2]).as_conditions();
+  });
+
+TVM_REGISTER_API("ir_pass.SolveSystemOfInequalitiesIsl").set_body([](const TVMArgs args, TVMRetValue *ret) {
+  Array<Expr> inequalities = args[0];
+  SolveSystemOfInequalitiesResult res;
+  CHECK(SolveSystemOfInequalitiesIsl(inequalities, args[1], args[2], &res))
+    << "isl can not solve the system " << inequalities;
+  *ret = res.as_conditions();
+});
+
 TVM_REGISTER_API("ir_pass.SimplifyDomain").set_body([](const TVMArgs args, TVMRetValue *ret) {
   if (args.size() == 1) {
     *ret = SimplifyDomain(args[0]);
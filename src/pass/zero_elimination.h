@@ -263,6 +263,30 @@ TVM_DLL SolveSystemOfInequalitiesResult SolveSystemOfInequalities(const Array<Ex
                                                                   const Array<Var> &variables,
                                                                   const Map<Var, Range> &vranges);
 
+/*!
+ * \brief The Fourier-Motzkin backend of SolveSystemOfInequalities.
+ */
+TVM_DLL SolveSystemOfInequalitiesResult SolveSystemOfInequalitiesFourierMotzkin(const Array<Expr> &inequalities,
+                                                                                const Array<Var> &variables,
+                                                                                const Map<Var, Range> &vranges);
+
+/*!
+ * \brief The ISL backend of SolveSystemOfInequalities.
+ *
+ *  The (in)equalities are converted to an ISL basic set whose parameters are the free variables that are not in
+ *  `variables`. The variables are eliminated in the same order as Fourier-Motzkin does, and ISL removes the
+ *  redundant constraints after each elimination, so the result has the same form with fewer bounds.
+ *
+ * \return false if some (in)equality or range is not affine, in which case `res` is left untouched.
+ */
+TVM_DLL bool SolveSystemOfInequalitiesIsl(const Array<Expr> &inequalities, const Array<Var> &variables,
+                                          const Map<Var, Range> &vranges, SolveSystemOfInequalitiesResult *res);
+
+/*!
+ * \brief Rewrite every comparison into the form a == 0, a != 0, a <= 0, and sometimes for floats a < 0.
+ */
+TVM_DLL Expr NormalizeComparisons(const Expr &expr);
+
 // Number of times to solve system of equiation and transform the domain.
 const int N_REPEAT_TRANSFORM = 2;
 
@@ -0,0 +1,332 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <isl/constraint.h>
+#include <isl/ctx.h>
+#include <isl/local_space.h>
+#include <isl/set.h>
+#include <isl/space.h>
+#include <isl/val.h>
+#include <tvm/arithmetic.h>
+#include <tvm/ir.h>
+#include <tvm/ir_pass.h>
+#include <pass/ir_util.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pass/zero_elimination.h"
+
+namespace akg {
+namespace ir {
+namespace {
+struct ExprLess {
+  bool operator()(const Expr &l, const Expr &r) const { return Compare(l, r) < 0; }
+};
+
+struct ExprEq {
+  bool operator()(const Expr &l, const Expr &r) const { return Compare(l, r) == 0; }
+};
+
+/*!
+ * \brief An affine constraint `sum(coefs[i] * dims[i]) + constant >= 0` (or `== 0`) over the variables followed by
+ *  the parameters of the system, which is the form ISL stores constraints in.
+ */
+struct AffineConstraint {
+  std::vector<int64_t> coefs;
+  int64_t constant{0};
+  bool equality{false};
+};
+
+bool GetInt64(__isl_take isl_val *val, int64_t *value) {
+  bool ok = isl_val_is_int(val) == isl_bool_true;
+  if (ok) {
+    long num = isl_val_get_num_si(val);
+    ok = isl_val_cmp_si(val, num) == 0;
+    *value = static_cast<int64_t>(num);
+  }
+  static_cast<void>(isl_val_free(val));
+  return ok;
+}
+
+// isl_ctx is not thread safe, each thread keeps one context for all the systems it solves.
+isl_ctx *GetIslCtx() {
+  struct CtxHolder {
+    isl_ctx *ctx{isl_ctx_alloc()};
+    ~CtxHolder() { isl_ctx_free(ctx); }
+  };
+  static thread_local CtxHolder holder;
+  return holder.ctx;
+}
+
+/*!
+ * \brief Solve the system of inequalities of SolveSystemOfInequalities with ISL. Variables are eliminated one by one
+ *  as in Fourier-Motzkin, but redundant constraints are dropped by ISL after every elimination instead of being
+ *  compared pairwise with CanProve, which keeps the number of constraints small on domains with many variables.
+ *  Like Fourier-Motzkin, the elimination is done over the rationals: an integer elimination of a variable whose
+ *  coefficient is not 1 would introduce an integer division, which has no form in the result.
+ */
+class IslInequalitySolver {
+ public:
+  IslInequalitySolver(const Array<Expr> &inequalities, const Array<Var> &variables, const Map<Var, Range> &vranges)
+      : inequalities_(inequalities), vranges_(vranges) {
+    for (const auto &v : variables) {
+      dims_.push_back(v);
+    }
+    var_num_ = dims_.size();
+    type_ = variables.empty() ? Int(32) : variables[0].type();
+  }
+
+  ~IslInequalitySolver() {
+    if (bset_ != nullptr) {
+      static_cast<void>(isl_basic_set_free(bset_));
+    }
+  }
+
+  bool Solve(SolveSystemOfInequalitiesResult *res) {
+    res->variables = Array<Var>(dims_.begin(), dims_.begin() + var_num_);
+    std::vector<AffineConstraint> constraints;
+    if (!Linearize(&constraints)) {
+      return false;
+    }
+    BuildSet(constraints);
+    if (isl_basic_set_is_empty(bset_) == isl_bool_true) {
+      return Contradiction(res);
+    }
+    bset_ = isl_basic_set_set_rational(bset_);
+    for (size_t i = 0; i < var_num_; ++i) {
+      bset_ = isl_basic_set_detect_equalities(bset_);
+      bset_ = isl_basic_set_remove_redundancies(bset_);
+      if (!ExtractBounds(i, res)) {
+        return false;
+      }
+      bset_ = isl_basic_set_eliminate(bset_, isl_dim_set, static_cast<unsigned>(i), 1);
+    }
+    bset_ = isl_basic_set_remove_redundancies(bset_);
+    std::vector<AffineConstraint> rest;
+    if (!GetConstraints(&rest)) {
+      return false;
+    }
+    for (const auto &c : rest) {
+      Expr lhs = ToExpr(c, dims_.size());
+      Expr cond = c.equality ? EQ::make(lhs, make_zero(type_)) : GE::make(lhs, make_zero(type_));
+      cond = SuperSimplify(cond, vranges_);
+      if (is_const_int(cond, 0)) {
+        return Contradiction(res);
+      }
+      if (!is_const_int(cond, 1) && !CanProve(cond, vranges_)) {
+        res->other_conditions.push_back(cond);
+      }
+    }
+    for (const auto &e : unhandled_) {
+      res->other_conditions.push_back(e);
+    }
+    return true;
+  }
+
+ private:
+  bool Linearize(std::vector<AffineConstraint> *constraints) {
+    std::unordered_set<const Variable *> known;
+    for (const auto &v : dims_) {
+      known.insert(v.get());
+    }
+    auto collect_params = [this, &known](const NodeRef &node) {
+      auto var = node.as<Variable>();
+      if (var != nullptr && !known.count(var)) {
+        known.insert(var);
+        dims_.push_back(GetRef<Var>(var));
+      }
+    };
+    std::vector<Expr> normalized;
+    for (const auto &ineq : inequalities_) {
+      Expr e = NormalizeComparisons(SuperSimplify(ineq, vranges_));
+      if (is_const_int(e, 1)) continue;
+      if (e.as<LE>() == nullptr && e.as<EQ>() == nullptr) {
+        // not an affine (in)equality, it is kept as it is.
+        unhandled_.push_back(e);
+        continue;
+      }
+      air::ir::PostOrderVisit(e, collect_params);
+      normalized.push_back(e);
+    }
+    for (size_t i = 0; i < var_num_; ++i) {
+      if (!vranges_.count(dims_[i])) continue;
+      const Range &range = vranges_[dims_[i]];
+      air::ir::PostOrderVisit(range->min, collect_params);
+      air::ir::PostOrderVisit(range->extent, collect_params);
+      normalized.push_back(NormalizeComparisons(range->min <= dims_[i]));
+      normalized.push_back(NormalizeComparisons(dims_[i] <= range->min + range->extent - 1));
+    }
+    Array<Var> all_dims(dims_.begin(), dims_.end());
+    for (const auto &e : normalized) {
+      // both forms are `a <= 0` or `a == 0`, ISL wants `-a >= 0` and `a == 0`.
+      const LE *le = e.as<LE>();
+      Expr lhs = le != nullptr ? le->a : e.as<EQ>()->a;
+      Array<Expr> coefs = air::arith::DetectLinearEquation(lhs, all_dims);
+      if (coefs.empty()) {
+        return false;
+      }
+      AffineConstraint c;
+      c.equality = le == nullptr;
+      int64_t sign = c.equality ? 1 : -1;
+      for (const auto &coef : coefs) {
+        const int64_t *value = as_const_int(SuperSimplify(coef));
+        if (value == nullptr) {
+          return false;
+        }
+        c.coefs.push_back(sign * *value);
+      }
+      c.constant = c.coefs.back();
+      c.coefs.pop_back();
+      constraints->push_back(c);
+    }
+    return true;
+  }
+
+  void BuildSet(const std::vector<AffineConstraint> &constraints) {
+    unsigned n_param = static_cast<unsigned>(dims_.size() - var_num_);
+    isl_space *space = isl_space_set_alloc(ctx_, n_param, static_cast<unsigned>(var_num_));
+    isl_local_space *ls = isl_local_space_from_space(isl_space_copy(space));
+    bset_ = isl_basic_set_universe(space);
+    for (const auto &c : constraints) {
+      isl_constraint *cons = c.equality ? isl_constraint_alloc_equality(isl_local_space_copy(ls))
+                                        : isl_constraint_alloc_inequality(isl_local_space_copy(ls));
+      for (size_t i = 0; i < c.coefs.size(); ++i) {
+        if (c.coefs[i] == 0) continue;
+        auto type = i < var_num_ ? isl_dim_set : isl_dim_param;
+        auto pos = static_cast<int>(i < var_num_ ? i : i - var_num_);
+        cons = isl_constraint_set_coefficient_val(cons, type, pos, isl_val_int_from_si(ctx_, c.coefs[i]));
+      }
+      cons = isl_constraint_set_constant_val(cons, isl_val_int_from_si(ctx_, c.constant));
+      bset_ = isl_basic_set_add_constraint(bset_, cons);
+    }
+    static_cast<void>(isl_local_space_free(ls));
+  }
+
+  bool GetConstraints(std::vector<AffineConstraint> *constraints) {
+    if (isl_basic_set_dim(bset_, isl_dim_div) != 0) {
+      return false;
+    }
+    struct Collector {
+      IslInequalitySolver *solver;
+      std::vector<AffineConstraint> *constraints;
+      bool ok;
+    } collector{this, constraints, true};
+    auto fn = [](__isl_take isl_constraint *cons, void *user) -> isl_stat {
+      auto collector = static_cast<Collector *>(user);
+      AffineConstraint c;
+      c.equality = isl_constraint_is_equality(cons) == isl_bool_true;
+      size_t var_num = collector->solver->var_num_;
+      for (size_t i = 0; i < collector->solver->dims_.size() && collector->ok; ++i) {
+        auto type = i < var_num ? isl_dim_set : isl_dim_param;
+        auto pos = static_cast<int>(i < var_num ? i : i - var_num);
+        int64_t value = 0;
+        collector->ok = GetInt64(isl_constraint_get_coefficient_val(cons, type, pos), &value);
+        c.coefs.push_back(value);
+      }
+      collector->ok = collector->ok && GetInt64(isl_constraint_get_constant_val(cons), &c.constant);
+      collector->constraints->push_back(c);
+      static_cast<void>(isl_constraint_free(cons));
+      return isl_stat_ok;
+    };
+    isl_stat status = isl_basic_set_foreach_constraint(bset_, fn, &collector);
+    return status == isl_stat_ok && collector.ok;
+  }
+
+  Expr ToExpr(const AffineConstraint &c, size_t skip) {
+    Expr res = make_const(type_, c.constant);
+    for (size_t i = 0; i < dims_.size(); ++i) {
+      if (i == skip || c.coefs[i] == 0) continue;
+      res = res + make_const(dims_[i].type(), c.coefs[i]) * dims_[i];
+    }
+    return res;
+  }
+
+  bool ExtractBounds(size_t i, SolveSystemOfInequalitiesResult *res) {
+    std::vector<AffineConstraint> constraints;
+    if (!GetConstraints(&constraints)) {
+      return false;
+    }
+    int64_t coef_lcm = 1;
+    for (const auto &c : constraints) {
+      if (c.coefs[i] != 0) {
+        coef_lcm = air::ir::lcm(coef_lcm, std::abs(c.coefs[i]));
+      }
+    }
+    // a*x + r >= 0 is a lower bound of x when a > 0 and an upper bound otherwise.
+    std::vector<Expr> lower;
+    std::vector<Expr> upper;
+    std::vector<Expr> equal;
+    for (const auto &c : constraints) {
+      int64_t a = c.coefs[i];
+      if (a == 0) continue;
+      Expr rest = ToExpr(c, i);
+      Expr bound = a > 0 ? make_zero(type_) - rest : rest;
+      bound = SuperSimplify(make_const(type_, coef_lcm / std::abs(a)) * bound, vranges_);
+      if (c.equality) {
+        equal.push_back(bound);
+      } else if (a > 0) {
+        lower.push_back(bound);
+      } else {
+        upper.push_back(bound);
+      }
+    }
+    for (std::vector<Expr> *bounds : {&lower, &upper, &equal}) {
+      std::sort(bounds->begin(), bounds->end(), ExprLess());
+      bounds->erase(std::unique(bounds->begin(), bounds->end(), ExprEq()), bounds->end());
+    }
+    auto &bnds = res->bounds[dims_[i].get()];
+    bnds.coef = make_const(dims_[i].type(), coef_lcm);
+    bnds.lower = lower;
+    bnds.upper = upper;
+    bnds.equal = equal;
+    return true;
+  }
+
+  bool Contradiction(SolveSystemOfInequalitiesResult *res) {
+    for (size_t i = 0; i < var_num_; ++i) {
+      auto &bnds = res->bounds[dims_[i].get()];
+      bnds.coef = make_const(dims_[i].type(), 1);
+    }
+    res->other_conditions = {const_false()};
+    return true;
+  }
+
+  Array<Expr> inequalities_;
+  Map<Var, Range> vranges_;
+  // the variables to solve followed by the parameters of the system.
+  std::vector<Var> dims_;
+  size_t var_num_{0};
+  Type type_;
+  std::vector<Expr> unhandled_;
+  isl_ctx *ctx_{GetIslCtx()};
+  isl_basic_set *bset_{nullptr};
+};
+}  // namespace
+
+bool SolveSystemOfInequalitiesIsl(const Array<Expr> &inequalities, const Array<Var> &variables,
+                                  const Map<Var, Range> &vranges, SolveSystemOfInequalitiesResult *res) {
+  SolveSystemOfInequalitiesResult isl_res;
+  if (!IslInequalitySolver(inequalities, variables, vranges).Solve(&isl_res)) {
+    return false;
+  }
+  *res = isl_res;
+  return true;
+}
+}  // namespace ir
+}  // namespace akg
@@ -25,6 +25,7 @@
 
 #include "poly/poly_util.h"
 #include "poly/dma_inject.h"
+#include "poly/schedule_snapshot.h"
 
 namespace akg {
 namespace ir {
@@ -340,6 +341,17 @@ void AnalysisResult::DumpScopDataBasics(std::ofstream &of) {
     }
     of << "]" << std::endl;
   }
+
+  PrintHeader(of, "thread_order");
+  for (const auto &decision : GetThreadOrderDecisions()) {
+    for (size_t i = 0; i < decision.orders.size(); ++i) {
+      of << (i == decision.best ? "* " : "  ") << "[ ";
+      for (auto member : decision.orders[i]) {
+        of << member << " ";
+      }
+      of << "] transactions " << decision.transactions[i] << std::endl;
+    }
+  }
 }
 
 void ScopInfo::DumpScopDataAdvanced(std::ofstream &of) {
@@ -490,7 +502,11 @@ void ScopInfo::DumpSchTree(const std::string &file_name, const isl::schedule &sc
   std::stringstream final_file_name;
   final_file_name << std::setw(2) << std::setfill('0') << dump_schtree_count << "_" << file_name
                   << std::string(mmu_info_.IsSpecGemm() ? "_specgemm" : "");
-  if (user_config_.GetDumpPassIr()) {
+  if (user_config_.GetDumpPassIr() && user_config_.GetDumpScheduleSnapshot()) {
+    static_cast<void>(DumpScheduleSnapshotToFile(CreateDumpDir(final_file_name.str()) + SNAPSHOT_SUFFIX,
+                                                 MakeScheduleSnapshot(sch_dump, analysis_result_)));
+    dump_schtree_count++;
+  } else if (user_config_.GetDumpPassIr()) {
 #if DUMP_IR
     DumpSchTreeImpl(CreateDumpDir(final_file_name.str()), sch_dump);
     dump_schtree_count++;
@@ -24,6 +24,7 @@ namespace ir {
 namespace poly {
 Stmt EmitForTensorCore(Stmt stmt, TensorCoreInfo &info);
 Stmt EmitForTensorCoreDesignOne(Stmt stmt, TensorCoreInfo &info);
+Stmt FragmentEpilogueFusion(const Stmt &stmt, TensorCoreInfo &info);
 }  // namespace poly
 }  // namespace ir
 }  // namespace akg
@@ -19,6 +19,8 @@
  */
 
 #include "emit_pass.h"
+#include <functional>
+#include <sstream>
 #include <stack>
 
 namespace akg {
@@ -654,6 +656,356 @@ class DeleteUselessAttr : public IRMutator {
   }
 };
 
+// Replace the tensor reads of an epilogue value by the elements of the fragments that hold them.
+class FragmentValueRewriter : public IRMutator {
+ public:
+  explicit FragmentValueRewriter(std::function<Expr(const Call *)> rewrite) : rewrite_(rewrite) {}
+
+  Expr Mutate_(const Call *op, const Expr &e) final {
+    if (op->call_type == Call::Halide) {
+      return rewrite_(op);
+    }
+    return IRMutator::Mutate_(op, e);
+  }
+
+ private:
+  std::function<Expr(const Call *)> rewrite_;
+};
+
+/*
+ * The elementwise epilogue of a fragment store. The fragment is stored to a promoted tensor that one statement reads
+ * back to write the output; when that statement only translates the indices of the fragment, it is evaluated on the
+ * accumulator registers and the fragment is stored to the output directly.
+ */
+struct FragmentEpilogue {
+  const Provide *consumer{nullptr};
+  Type acc_type;
+  Expr value;
+  Expr dst;
+  Expr ldm;
+  Array<Expr> operands;
+};
+
+class CollectFragmentEpilogue : public IRVisitor {
+ public:
+  explicit CollectFragmentEpilogue(TensorCoreInfo &info) : info_(info) {}
+  using IRVisitor::Visit_;
+
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key == air::ir::attr::buffer_bind_scope) {
+      Array<NodeRef> arr = Downcast<Array<NodeRef>>(op->node);
+      CHECK_EQ(arr.size(), 2U);
+      const BufferNode *buffer = arr[0].as<BufferNode>();
+      CHECK(buffer);
+      fragment_type_[buffer->data.get()] = buffer->dtype;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const For *op) final {
+    loop_vars_.push_back(op->loop_var.get());
+    IRVisitor::Visit_(op);
+    loop_vars_.pop_back();
+  }
+
+  void Visit_(const IfThenElse *op) final {
+    ++guard_depth_;
+    IRVisitor::Visit_(op);
+    --guard_depth_;
+  }
+
+  void Visit_(const Provide *op) final {
+    ++writes_[op->func->func_name()];
+    if (guard_depth_ == 0) {
+      loops_of_[op] = std::unordered_set<const Variable *>(loop_vars_.begin(), loop_vars_.end());
+    }
+    provides_.push_back(op);
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Call *op) final {
+    if (op->is_intrinsic(air::ir::intrinsic::tvm_store_matrix_sync)) {
+      CHECK_EQ(op->args.size(), 8U);
+      auto addr = op->args[5].as<Call>();
+      auto dst = (addr != nullptr && addr->name == "&") ? addr->args[0].as<Call>() : nullptr;
+      if (dst != nullptr && dst->call_type == Call::Halide) {
+        stores_[dst->name].push_back(op);
+        for (const auto &arg : dst->args) {
+          this->Visit(arg);
+        }
+        return;
+      }
+    } else if (op->call_type == Call::Halide) {
+      ++reads_[op->name];
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  // The epilogue of every fragment store whose promoted tensor is only read back by one elementwise statement.
+  std::unordered_map<const Call *, FragmentEpilogue> Plan() {
+    std::unordered_map<const Call *, FragmentEpilogue> plans;
+    for (const auto &it : stores_) {
+      const std::string &name = it.first;
+      if (it.second.size() != 1 || writes_[name] != 0) {
+        continue;
+      }
+      const Provide *consumer = nullptr;
+      size_t reads = 0;
+      for (auto provide : provides_) {
+        size_t count = CountReads(provide->value, name);
+        if (count != 0) {
+          consumer = consumer == nullptr ? provide : nullptr;
+          reads += count;
+        }
+      }
+      if (consumer == nullptr || reads != reads_[name] || !loops_of_.count(consumer)) {
+        continue;
+      }
+      FragmentEpilogue plan;
+      if (MakePlan(it.second[0], consumer, &plan)) {
+        plans[it.second[0]] = plan;
+      }
+    }
+    return plans;
+  }
+
+ private:
+  static size_t CountReads(const Expr &value, const std::string &name) {
+    size_t count = 0;
+    PostOrderVisit(value, [&count, &name](const NodeRef &node) {
+      auto call = node.as<Call>();
+      if (call != nullptr && call->call_type == Call::Halide && call->name == name) {
+        ++count;
+      }
+    });
+    return count;
+  }
+
+  static bool IsUniform(const Expr &e, const std::unordered_set<const Variable *> &loops) {
+    bool uniform = true;
+    PostOrderVisit(e, [&uniform, &loops](const NodeRef &node) {
+      auto var = node.as<Variable>();
+      if (var != nullptr && (loops.count(var) || var->name_hint.find("threadIdx") == 0)) {
+        uniform = false;
+      }
+    });
+    return uniform;
+  }
+
+  // The leading dimension of a row major tensor, undefined when it is not a known multiple of 16 elements.
+  static Expr RowStride(const Call *call) {
+    auto op = Downcast<Operation>(call->func);
+    Array<Expr> shape = op->output_shape(call->value_index);
+    if (shape.empty()) {
+      return Expr();
+    }
+    auto imm = shape[shape.size() - 1].as<IntImm>();
+    if (imm == nullptr || imm->value % 16 != 0) {
+      return Expr();
+    }
+    return make_const(Int(32), imm->value);
+  }
+
+  bool MakePlan(const Call *store, const Provide *consumer, FragmentEpilogue *plan) {
+    auto frag = store->args[0].as<Variable>();
+    CHECK(frag);
+    if (!fragment_type_.count(frag)) {
+      return false;
+    }
+    Type acc_type = fragment_type_[frag];
+    const Call *promoted = store->args[5].as<Call>()->args[0].as<Call>();
+    const auto &loops = loops_of_[consumer];
+    size_t rank = promoted->args.size();
+    if (rank < 2 || consumer->args.size() != rank || consumer->value.type().bits() > acc_type.bits()) {
+      return false;
+    }
+
+    Array<Expr> read_args;
+    PostOrderVisit(consumer->value, [&read_args, &promoted](const NodeRef &node) {
+      auto call = node.as<Call>();
+      if (call != nullptr && call->call_type == Call::Halide && call->name == promoted->name && read_args.empty()) {
+        read_args = call->args;
+      }
+    });
+    CHECK_EQ(read_args.size(), rank);
+
+    // the output is written at a uniform translation of the promoted tensor.
+    Array<Expr> dst_args;
+    for (size_t i = 0; i < rank; ++i) {
+      Expr delta = Simplify(consumer->args[i] - read_args[i]);
+      if (!IsUniform(delta, loops)) {
+        return false;
+      }
+      dst_args.push_back(Simplify(promoted->args[i] + delta));
+    }
+    Array<Expr> shape = Downcast<Operation>(consumer->func)->output_shape(consumer->value_index);
+    auto last = shape.empty() ? nullptr : shape[shape.size() - 1].as<IntImm>();
+    if (last == nullptr || last->value % 16 != 0) {
+      return false;
+    }
+    plan->ldm = make_const(Int(32), last->value);
+    Expr out = Call::make(consumer->value.type(), consumer->func->func_name(), dst_args, Call::Halide,
+                          consumer->func, consumer->value_index);
+    plan->dst = Call::make(Handle(), "&", {out}, Call::Extern);
+
+    bool fail = false;
+    Array<Expr> operands;
+    std::unordered_map<std::string, int> operand_index;
+    plan->value = FragmentValueRewriter([&](const Call *call) -> Expr {
+                    if (call->name == promoted->name) {
+                      for (size_t i = 0; i < rank; ++i) {
+                        fail = fail || !air::ir::Equal(call->args[i], read_args[i]);
+                      }
+                      return Call::make(call->type, FRAGMENT_ELEM, {make_const(Int(32), 0)}, Call::Extern);
+                    }
+                    Expr addr;
+                    Expr ldm;
+                    if (!MakeOperand(call, promoted, read_args, loops, acc_type, &addr, &ldm)) {
+                      fail = true;
+                      return GetRef<Expr>(call);
+                    }
+                    std::ostringstream key;
+                    key << addr;
+                    if (!operand_index.count(key.str())) {
+                      operand_index[key.str()] = static_cast<int>(operands.size() / 2 + 1);
+                      operands.push_back(addr);
+                      operands.push_back(ldm);
+                    }
+                    return Call::make(call->type, FRAGMENT_ELEM, {make_const(Int(32), operand_index[key.str()])},
+                                      Call::Extern);
+                  }).Mutate(consumer->value);
+    if (fail) {
+      return false;
+    }
+    // any remaining per thread index can not be evaluated on the fragment registers.
+    if (!IsUniform(plan->value, loops)) {
+      return false;
+    }
+    plan->consumer = consumer;
+    plan->acc_type = acc_type;
+    plan->operands = operands;
+    return true;
+  }
+
+  // An operand is loaded as an accumulator fragment, so its columns follow the fragment. load_matrix_sync reads the
+  // element (i, j) of a row major fragment at i * ldm + j, an operand broadcast along the rows, such as a bias, is
+  // loaded with ldm 0: every row of the fragment reads the same elements, and 0 is a multiple of the 8 half or 4 float
+  // elements the leading dimension has to be a multiple of.
+  bool MakeOperand(const Call *call, const Call *promoted, const Array<Expr> &read_args,
+                   const std::unordered_set<const Variable *> &loops, const Type &acc_type, Expr *addr, Expr *ldm) {
+    // the akg fragments also load half operands into float accumulators.
+    bool akg_convert = info_.wmma_scope_ == "akg" && acc_type == Float(32) && call->type == Float(16);
+    if (call->type != acc_type && !akg_convert) {
+      return false;
+    }
+    size_t rank = call->args.size();
+    size_t promoted_rank = read_args.size();
+    if (rank == 0) {
+      return false;
+    }
+    Array<Expr> args = call->args;
+    Expr col_delta = Simplify(args[rank - 1] - read_args[promoted_rank - 1]);
+    if (!IsUniform(col_delta, loops)) {
+      return false;
+    }
+    args.Set(rank - 1, Simplify(promoted->args[promoted_rank - 1] + col_delta));
+    bool broadcast = rank < 2 || IsUniform(args[rank - 2], loops);
+    if (broadcast) {
+      *ldm = make_const(Int(32), 0);
+    } else {
+      Expr row_delta = Simplify(args[rank - 2] - read_args[promoted_rank - 2]);
+      *ldm = RowStride(call);
+      if (!IsUniform(row_delta, loops) || !ldm->defined()) {
+        return false;
+      }
+      args.Set(rank - 2, Simplify(promoted->args[promoted_rank - 2] + row_delta));
+    }
+    for (size_t i = 0; i + 2 < rank; ++i) {
+      if (!IsUniform(args[i], loops)) {
+        return false;
+      }
+    }
+    *addr = Call::make(Handle(), "&",
+                       {Call::make(call->type, call->name, args, Call::Halide, call->func, call->value_index)},
+                       Call::Extern);
+    return true;
+  }
+
+  TensorCoreInfo &info_;
+  std::unordered_map<const Variable *, Type> fragment_type_;
+  std::vector<const Variable *> loop_vars_;
+  int guard_depth_{0};
+  std::unordered_map<std::string, std::vector<const Call *>> stores_;
+  std::unordered_map<std::string, size_t> reads_;
+  std::unordered_map<std::string, size_t> writes_;
+  std::vector<const Provide *> provides_;
+  std::unordered_map<const Provide *, std::unordered_set<const Variable *>> loops_of_;
+};
+
+class FuseFragmentEpilogue : public IRMutator {
+ public:
+  explicit FuseFragmentEpilogue(std::unordered_map<const Call *, FragmentEpilogue> &plans) : plans_(plans) {
+    for (const auto &it : plans_) {
+      consumers_.insert(it.second.consumer);
+      promoted_.insert(it.first->args[5].as<Call>()->args[0].as<Call>()->name);
+    }
+  }
+
+  Stmt Mutate_(const Evaluate *op, const Stmt &s) final {
+    auto call = op->value.as<Call>();
+    if (call == nullptr || !plans_.count(call)) {
+      return IRMutator::Mutate_(op, s);
+    }
+    const FragmentEpilogue &plan = plans_[call];
+    Array<Expr> args = {call->args[0], call->args[4], call->args[1], call->args[2],
+                        call->args[3], plan.value,    plan.dst,      plan.ldm};
+    for (const auto &operand : plan.operands) {
+      args.push_back(operand);
+    }
+    return Evaluate::make(Call::make(plan.acc_type, FRAGMENT_EPILOGUE, args, Call::Extern));
+  }
+
+  Stmt Mutate_(const Provide *op, const Stmt &s) final {
+    if (consumers_.count(op)) {
+      return Evaluate::make(0);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const Realize *op, const Stmt &s) final {
+    if (promoted_.count(op->func->func_name())) {
+      return this->Mutate(op->body);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == air::ir::attr::realize_scope) {
+      auto func = op->node.as<OperationNode>();
+      if (func != nullptr && promoted_.count(func->name)) {
+        return this->Mutate(op->body);
+      }
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+ private:
+  std::unordered_map<const Call *, FragmentEpilogue> &plans_;
+  std::unordered_set<const Provide *> consumers_;
+  std::unordered_set<std::string> promoted_;
+};
+
+Stmt FragmentEpilogueFusion(const Stmt &stmt, TensorCoreInfo &info) {
+  CollectFragmentEpilogue collector(info);
+  collector.Visit(stmt);
+  auto plans = collector.Plan();
+  if (plans.empty()) {
+    return stmt;
+  }
+  Stmt res = FuseFragmentEpilogue(plans).Mutate(stmt);
+  return air::ir::RemoveNoOp(res);
+}
+
 Stmt EmitForTensorCoreDesignOne(Stmt stmt, TensorCoreInfo &info) {
   AdaptCastDesignOne adapt(info);
   stmt = adapt.Mutate(stmt);
@@ -664,6 +1016,9 @@ Stmt EmitForTensorCore(Stmt stmt, TensorCoreInfo &info) {
   stmt = ModifySizeOfLocal(info).Mutate(stmt);
   stmt = ModifyTheLocalOffset(info).Mutate(stmt);
   stmt = DeleteUselessAttr().Mutate(stmt);
+  if (info.fuse_epilogue_) {
+    stmt = FragmentEpilogueFusion(stmt, info);
+  }
 
   return stmt;
 }
@@ -17,6 +17,7 @@
 #include "poly/gpu_isl_emitter.h"
 #include "pass/utils.h"
 #include "gpu_emit/emit_pass.h"
+#include "akg_reduce/utils/index.cuh"
 #include <sstream>
 #include <algorithm>
 
@@ -308,6 +309,8 @@ Stmt GpuIslEmitter::EmitSync() {
   return Evaluate::make(Call::make(Int(32), STORAGE_SYNC, {StringImm::make(SYNC_SCOP_SHARED)}, Call::Intrinsic));
 }
 
+Stmt GpuIslEmitter::EmitWarpSync() { return Evaluate::make(Call::make(Int(32), WARP_SYNC, {}, Call::Extern)); }
+
 void GpuIslEmitter::SetScalarTensorBind() {
   Array<Expr> shapes;
   shapes.push_back(Expr(1));
@@ -528,6 +531,65 @@ void GpuIslEmitter::MakeReduceStmt() {
   return;
 }
 
+bool MakeReduceBlockIndex(const Array<Expr> &args, const std::unordered_map<const Variable *, Expr> &iter_bound_map,
+                          const std::vector<std::pair<VarExpr, int>> &block_dims, Expr *block_idx,
+                          int64_t *reduce_blocks) {
+  // Variables the output index depends on, directly or through the bounds of its loops, and the ones that are
+  // divided or taken modulo on the way.
+  std::unordered_set<const Variable *> used_vars;
+  std::unordered_set<const Variable *> folded_vars;
+  auto CollectVars = [](const Expr &e, std::unordered_set<const Variable *> &vars) {
+    PostOrderVisit(e, [&vars](const NodeRef &node) {
+      if (auto var = node.as<Variable>()) {
+        vars.insert(var);
+      }
+    });
+  };
+  std::vector<Expr> pending(args.begin(), args.end());
+  while (!pending.empty()) {
+    Expr e = pending.back();
+    pending.pop_back();
+    PostOrderVisit(e, [&iter_bound_map, &used_vars, &folded_vars, &pending, &CollectVars](const NodeRef &node) {
+      if (auto op = node.as<Div>()) {
+        CollectVars(op->a, folded_vars);
+      } else if (auto op = node.as<Mod>()) {
+        CollectVars(op->a, folded_vars);
+      } else if (auto op = node.as<FloorDiv>()) {
+        CollectVars(op->a, folded_vars);
+      } else if (auto op = node.as<FloorMod>()) {
+        CollectVars(op->a, folded_vars);
+      }
+      auto var = node.as<Variable>();
+      if (var == nullptr || !used_vars.insert(var).second) {
+        return;
+      }
+      auto it = iter_bound_map.find(var);
+      if (it != iter_bound_map.end()) {
+        pending.push_back(it->second);
+      }
+    });
+  }
+
+  // All the blocks that only differ along the unused block dimensions write the same output element.
+  *block_idx = Expr(0);
+  *reduce_blocks = 1;
+  for (const auto &dim : block_dims) {
+    if (dim.second <= 1) {
+      continue;
+    }
+    if (used_vars.count(dim.first.get())) {
+      if (folded_vars.count(dim.first.get())) {
+        return false;
+      }
+      continue;
+    }
+    *block_idx = *block_idx * dim.second + dim.first;
+    *reduce_blocks *= dim.second;
+  }
+  *block_idx = Simplify(*block_idx);
+  return true;
+}
+
 Stmt GpuIslEmitter::MakeAtomicStmt() {
   std::string func_name = reduce_info_.akg_atomic_api_;
 
@@ -548,7 +610,41 @@ Stmt GpuIslEmitter::MakeAtomicStmt() {
   Array<Expr> args;
   Expr a3 = Call::make(Int(32), reduce_info_.reduce_op_, args, Call::Extern);
 
-  return Evaluate::make(Call::make(Int(32), func_name, {template_arg0, template_arg1, a1, a2, a3}, Call::Extern));
+  Stmt stmt;
+  if (func_name.find(AKG_DETERMINISTIC_RETURN_NAME) != std::string::npos) {
+    Expr block_idx;
+    int64_t reduce_blocks = 1;
+    std::vector<std::pair<VarExpr, int>> block_dims;
+    for (auto name : {B2, B1, B0}) {
+      VarExpr block_var = iter_name_map_[name];
+      block_dims.emplace_back(block_var, GetThreadExtent(block_var->name_hint));
+    }
+    // the output is not cleared before launch, an atomic return would add the partial results to garbage.
+    CHECK(MakeReduceBlockIndex(p->args, iter_bound_map_, block_dims, &block_idx, &reduce_blocks))
+      << "a block dim of " << p->func->func_name()
+      << " selects the output and splits the reduction, deterministic reduce can not number its blocks.";
+    Tensor t = info_.FindTensor(p->func->func_name());
+    CHECK(t.defined());
+    int64_t output_size = 1;
+    Expr output_idx = Expr(0);
+    for (size_t i = 0; i < t->shape.size(); ++i) {
+      auto dim = t->shape[i].as<IntImm>();
+      CHECK(dim) << "deterministic reduce needs a static output shape.";
+      output_size *= dim->value;
+      output_idx = output_idx * t->shape[i] + p->args[i];
+    }
+    template_arg1 = StringImm::make(reduce_info_.akg_atomic_template_arg_ + ", " + std::to_string(output_size) + ", " +
+                                    std::to_string(reduce_blocks));
+    stmt = Evaluate::make(Call::make(
+      Int(32), func_name, {template_arg0, template_arg1, a1, a2, a3, Simplify(output_idx), block_idx}, Call::Extern));
+  } else {
+    stmt = Evaluate::make(Call::make(Int(32), func_name, {template_arg0, template_arg1, a1, a2, a3}, Call::Extern));
+  }
+  if (info_.user_config_.GetSplitK() > 1) {
+    // split k writes atomically without any reduction, the reduce lib still has to be included.
+    stmt = AttrStmt::make(Expr("INFO"), REDUCE_LIB_TYPE_FLAG, info_.user_config_.GetReduceLibType(), stmt);
+  }
+  return stmt;
 }
 
 Stmt GpuIslEmitter::EmitReduceArea(const isl::ast_node_user &node) {
@@ -732,6 +828,16 @@ Stmt GpuIslEmitter::EmitStmt(const isl::ast_node_user &node) {
     Stmt s = EmitSync();
     is_sync_before_ = true;
     return s;
+  } else if (info_.IsWarpSync(stmt_id)) {
+    // a block sync right before already orders the warp, and it is kept as the previous sync for the next one.
+    if (is_sync_before_) {
+      return Stmt();
+    }
+    if (!info_.user_config_.GetEnableSyncElimination()) {
+      is_sync_before_ = true;
+      return EmitSync();
+    }
+    return EmitWarpSync();
   } else if (info_.IsReduceInit(stmt_id)) {
     is_sync_before_ = false;
     in_reduce_area_ = false;
@@ -808,6 +914,11 @@ void GpuIslEmitter::MakeAkgReduceFuncName() {
   } else {
     reduce_type = AKG_Y_REDUCE;
   }
+  bool warp_row = info_.user_config_.GetEnableRowReduceStrategy() && direction == X_DIRECTION &&
+                  akg_reduce::IsWarpRowReducible(tx, tx * ty, reduce_info_.reduce_data_type_info_.bytes());
+  if (warp_row && reduce_lib_namespace == AKG_REDUCE_LIB_SPACE) {
+    reduce_type = AKG_X_WARP_REDUCE;
+  }
   ret += ", ";
   ret += reduce_type;
 
@@ -819,7 +930,8 @@ void GpuIslEmitter::ConstructAtomicReturnFuncName() {
   std::string reduce_return_name = "";
   if (info_.user_config_.GetReduceLibType() == REDUCE_LIB_TYPE_ORIGIN) {
     reduce_lib_namespace = AKG_REDUCE_LIB_SPACE;
-    reduce_return_name = AKG_REDUCE_RETURN_NAME;
+    reduce_return_name = info_.user_config_.GetEnableDeterministicReduce() ? AKG_DETERMINISTIC_RETURN_NAME
+                                                                         : AKG_REDUCE_RETURN_NAME;
   } else if (info_.user_config_.GetReduceLibType() == REDUCE_LIB_TYPE_PARIS) {
     reduce_lib_namespace = PARIS_REDUCE_LIB_SPACE;
     reduce_return_name = PARIS_REDUCE_RETURN_NAME;
@@ -963,6 +1075,7 @@ Stmt GpuIslEmitter::EmitFor(const isl::ast_node_for &node) {
   }
 
   cond_expr = Simplify(cond_expr - init_expr);
+  iter_bound_map_[iter_expr.get()] = init_expr + cond_expr;
 
   // add for tensor core
 
@@ -1023,7 +1136,7 @@ Stmt GpuIslEmitter::EmitIf(const isl::ast_node_if &node) {
   cur_if_list_.pop_back();
   if (reduce_info_.init_stmt_emit_) {
     reduce_info_.init_stmt_emit_ = false;
-    if (info_.user_config_.GetEnableAtomicAdd()) {
+    if (info_.user_config_.GetEnableAtomicAdd() || info_.user_config_.GetEnableDeterministicReduce()) {
       cond_expr = ConditionExprMod().Mutate(cond_expr);
     }
   }
@@ -1163,12 +1276,241 @@ bool GpuIslEmitter::CheckTileValid(Tile tile) {
   return false;
 }
 
+/*
+ * Remove the syncs of the emitted kernel that order no conflicting accesses. The accesses before a sync are taken
+ * up to the previous kept sync of at least the same level (or the start of the kernel), the accesses after it up to
+ * the next one (or the end of the kernel); the sync is redundant when no tensor written on one side is used on the
+ * other side. Local tensors are private to a thread and never conflict. Adjacent syncs are merged the same way, the
+ * weaker one sees an empty side. A loop body is analysed with the whole body on both sides, as the previous and the
+ * next iterations run around it.
+ */
+class SyncEliminator : public IRMutator {
+ public:
+  struct AccessSummary {
+    std::unordered_set<std::string> reads;
+    std::unordered_set<std::string> writes;
+    // extern calls, e.g. akg_reduce, may touch any tensor
+    bool unknown{false};
+
+    bool Empty() const { return reads.empty() && writes.empty() && !unknown; }
+
+    void Merge(const AccessSummary &other) {
+      reads.insert(other.reads.begin(), other.reads.end());
+      writes.insert(other.writes.begin(), other.writes.end());
+      unknown = unknown || other.unknown;
+    }
+
+    bool Conflicts(const AccessSummary &other) const {
+      if (Empty() || other.Empty()) {
+        return false;
+      }
+      if (unknown || other.unknown) {
+        return true;
+      }
+      for (const auto &name : writes) {
+        if (other.reads.count(name) || other.writes.count(name)) {
+          return true;
+        }
+      }
+      for (const auto &name : reads) {
+        if (other.writes.count(name)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  explicit SyncEliminator(const Stmt &kernel) {
+    PostOrderVisit(kernel, [this](const NodeRef &node) {
+      auto attr = node.as<AttrStmt>();
+      if (attr == nullptr || attr->attr_key != air::ir::attr::realize_scope) {
+        return;
+      }
+      auto scope = attr->value.as<StringImm>();
+      auto func = attr->node.as<air::FunctionBaseNode>();
+      if (scope != nullptr && func != nullptr && scope->value == MEM_TYPE_LOCAL) {
+        local_tensors_.insert(func->func_name());
+      }
+    });
+  }
+
+  Stmt Mutate_(const Block *op, const Stmt &s) final {
+    std::vector<Stmt> stmts;
+    Flatten(s, &stmts);
+    std::vector<SyncLevel> levels;
+    std::vector<AccessSummary> accesses;
+    for (const auto &stmt : stmts) {
+      levels.push_back(GetSyncLevel(stmt));
+      accesses.push_back(Summarize(stmt));
+    }
+
+    for (size_t i = 0; i < stmts.size();) {
+      if (levels[i] != SyncLevel::EMPTY &&
+          !CollectBefore(levels, accesses, i, levels[i]).Conflicts(CollectAfter(levels, accesses, i, levels[i]))) {
+        stmts.erase(stmts.begin() + i);
+        levels.erase(levels.begin() + i);
+        accesses.erase(accesses.begin() + i);
+        continue;
+      }
+      ++i;
+    }
+
+    AccessSummary outer_before = before_;
+    AccessSummary outer_after = after_;
+    for (size_t i = 0; i < stmts.size(); ++i) {
+      if (levels[i] != SyncLevel::EMPTY) {
+        continue;
+      }
+      before_ = CollectBefore(levels, accesses, i, SyncLevel::BLOCK);
+      after_ = CollectAfter(levels, accesses, i, SyncLevel::BLOCK);
+      stmts[i] = Mutate(stmts[i]);
+    }
+    before_ = outer_before;
+    after_ = outer_after;
+
+    if (stmts.empty()) {
+      return Evaluate::make(0);
+    }
+    return Block::make(stmts);
+  }
+
+  Stmt Mutate_(const Evaluate *op, const Stmt &s) final {
+    if (GetSyncLevel(s) != SyncLevel::EMPTY && !before_.Conflicts(after_)) {
+      return Evaluate::make(0);
+    }
+    return s;
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    AccessSummary outer_before = before_;
+    AccessSummary outer_after = after_;
+    AccessSummary body = Summarize(op->body);
+    before_.Merge(Summarize(Evaluate::make(op->min + op->extent)));
+    before_.Merge(body);
+    after_ = body;
+    after_.Merge(outer_after);
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    before_ = outer_before;
+    after_ = outer_after;
+    return stmt;
+  }
+
+  Stmt Mutate_(const IfThenElse *op, const Stmt &s) final {
+    AccessSummary outer_before = before_;
+    before_.Merge(Summarize(Evaluate::make(op->condition)));
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    before_ = outer_before;
+    return stmt;
+  }
+
+  Stmt Mutate_(const LetStmt *op, const Stmt &s) final {
+    AccessSummary outer_before = before_;
+    before_.Merge(Summarize(Evaluate::make(op->value)));
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    before_ = outer_before;
+    return stmt;
+  }
+
+ private:
+  static void Flatten(const Stmt &s, std::vector<Stmt> *stmts) {
+    if (auto block = s.as<Block>()) {
+      Flatten(block->first, stmts);
+      Flatten(block->rest, stmts);
+    } else {
+      stmts->push_back(s);
+    }
+  }
+
+  static SyncLevel GetSyncLevel(const Stmt &s) {
+    auto eval = s.as<Evaluate>();
+    auto call = eval == nullptr ? nullptr : eval->value.as<Call>();
+    if (call == nullptr) {
+      return SyncLevel::EMPTY;
+    }
+    if (call->is_intrinsic(STORAGE_SYNC) && call->args.size() == 1 && call->args[0].as<StringImm>() &&
+        call->args[0].as<StringImm>()->value == SYNC_SCOP_SHARED) {
+      return SyncLevel::BLOCK;
+    }
+    if (call->call_type == Call::Extern && call->name == WARP_SYNC) {
+      return SyncLevel::WARP;
+    }
+    return SyncLevel::EMPTY;
+  }
+
+  AccessSummary Summarize(const Stmt &s) const {
+    AccessSummary summary;
+    PostOrderVisit(s, [this, &summary](const NodeRef &node) {
+      if (auto provide = node.as<Provide>()) {
+        AddAccess(provide->func->func_name(), &summary.writes);
+      } else if (auto store = node.as<Store>()) {
+        AddAccess(store->buffer_var->name_hint, &summary.writes);
+      } else if (auto load = node.as<Load>()) {
+        AddAccess(load->buffer_var->name_hint, &summary.reads);
+      } else if (auto call = node.as<Call>()) {
+        if (call->call_type == Call::Halide) {
+          AddAccess(call->name, &summary.reads);
+        } else if (call->call_type == Call::Extern && call->name != WARP_SYNC && call->name != "&") {
+          summary.unknown = true;
+        }
+      }
+    });
+    return summary;
+  }
+
+  void AddAccess(const std::string &name, std::unordered_set<std::string> *names) const {
+    if (local_tensors_.count(name) == 0) {
+      names->insert(name);
+    }
+  }
+
+  // accesses between the previous sync of at least the given level and the i-th statement
+  AccessSummary CollectBefore(const std::vector<SyncLevel> &levels, const std::vector<AccessSummary> &accesses,
+                              size_t i, SyncLevel level) const {
+    AccessSummary summary;
+    for (size_t j = i; j > 0; --j) {
+      if (levels[j - 1] >= level) {
+        return summary;
+      }
+      summary.Merge(accesses[j - 1]);
+    }
+    summary.Merge(before_);
+    return summary;
+  }
+
+  // accesses between the i-th statement and the next sync of at least the given level
+  AccessSummary CollectAfter(const std::vector<SyncLevel> &levels, const std::vector<AccessSummary> &accesses,
+                             size_t i, SyncLevel level) const {
+    AccessSummary summary;
+    for (size_t j = i + 1; j < levels.size(); ++j) {
+      if (levels[j] >= level) {
+        return summary;
+      }
+      summary.Merge(accesses[j]);
+    }
+    summary.Merge(after_);
+    return summary;
+  }
+
+  std::unordered_set<std::string> local_tensors_;
+  // accesses around the current statement, outside of the block being mutated
+  AccessSummary before_;
+  AccessSummary after_;
+};
+
+Stmt EliminateSyncs(const Stmt &kernel) { return SyncEliminator(kernel).Mutate(kernel); }
+
 Stmt GpuIslEmitter::Emit(const isl::ast_node &node) {
   Stmt stmt = EmitAst(node);
 
   // emit realize for temporary tensor
   stmt = EmitRealizeForGlobalTensor(stmt);
 
+  // the wmma intrinsics of tensor core read shared memory without a visible tensor access
+  if (info_.user_config_.GetEnableSyncElimination() && !info_.user_config_.GetEnableTensorCore()) {
+    stmt = EliminateSyncs(stmt);
+  }
+
   // iter var node attr emit
   std::map<std::string, VarExpr>::iterator it;
   for (it = iter_name_map_.begin(); it != iter_name_map_.end(); it++) {
@@ -1196,6 +1538,7 @@ Stmt GpuIslEmitter::Emit(const isl::ast_node &node) {
 
   if (tensor_core_info_.is_tensor_core_ && info_.user_config_.GetEnableTensorCoreUsePoly()) {
     stmt = AddMmaAttrFlag(tensor_core_info_).Mutate(stmt);
+    tensor_core_info_.fuse_epilogue_ = info_.user_config_.GetEnableMmaEpilogueFusion();
     stmt = EmitForTensorCore(stmt, tensor_core_info_);
   } else if (info_.user_config_.GetEnableTensorCore()) {
     tensor_core_info_.cast_tensors_ = info_.analysis_result_.GetCastTensors();
@@ -1364,6 +1707,108 @@ std::string GpuIslEmitter::FindRealizeScopeToString(const isl::id &var) {
 
 Expr GpuIslEmitter::FindRealizeScope(const isl::id &var) { return Expr(FindRealizeScopeToString(var)); }
 
+/*
+ * Apply the xor swizzle chosen by SharedMemoryManager to every access of a shared tensor. The innermost index is cut
+ * into groups of swizzle_words words, i.e. one vector load, and the group index is xor-ed with the index of key_dim.
+ * The offset within the group is kept as an addend, so a vectorized loop over it still gives a ramp.
+ */
+class SharedSwizzleMutator : public IRMutator {
+ public:
+  SharedSwizzleMutator(const FunctionRef &func, int key_dim, int swizzle_words, int elem_per_word)
+      : func_(func), key_dim_(key_dim), swizzle_words_(swizzle_words), elem_per_word_(elem_per_word) {}
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    analyzer_.Bind(op->loop_var, Range::make_by_min_extent(op->min, op->extent));
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == air::ir::attr::thread_extent) {
+      const auto iv = op->node.as<IterVarNode>();
+      if (iv != nullptr) {
+        analyzer_.Bind(iv->var, Range::make_by_min_extent(0, op->value));
+      }
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const Provide *op, const Stmt &s) final {
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    op = stmt.as<Provide>();
+    if (op == nullptr || !op->func.same_as(func_)) {
+      return stmt;
+    }
+    return Provide::make(op->func, op->value_index, op->value, Swizzle(op->args));
+  }
+
+  Expr Mutate_(const Call *op, const Expr &e) final {
+    Expr expr = IRMutator::Mutate_(op, e);
+    op = expr.as<Call>();
+    if (op == nullptr || op->call_type != Call::Halide || !op->func.same_as(func_)) {
+      return expr;
+    }
+    return Call::make(op->type, op->name, Swizzle(op->args), op->call_type, op->func, op->value_index);
+  }
+
+ private:
+  Array<Expr> Swizzle(const Array<Expr> &args) {
+    CHECK_LT(key_dim_, static_cast<int>(args.size()) - 1);
+    Array<Expr> new_args = args;
+    Expr inner = args[args.size() - 1];
+    int group = swizzle_words_ * elem_per_word_;
+    int key_period = std::max(1, SHARED_MEM_BANKS / swizzle_words_);
+    Expr key = analyzer_.Simplify(truncmod(args[key_dim_], key_period));
+    Expr group_idx = analyzer_.Simplify(truncdiv(inner, group));
+    Expr offset = analyzer_.Simplify(truncmod(inner, group));
+    new_args.Set(args.size() - 1, (group_idx ^ key) * group + offset);
+    return new_args;
+  }
+
+  FunctionRef func_;
+  int key_dim_;
+  int swizzle_words_;
+  int elem_per_word_;
+  air::arith::Analyzer analyzer_;
+};
+
+/*
+ * Finds whether a pointer to the tensor is passed to a call that is not an access, e.g. the reduce library or a wmma
+ * fragment load. The callee indexes the buffer linearly, so the tensor can not be swizzled.
+ */
+class SharedPointerFinder : public IRVisitor {
+ public:
+  explicit SharedPointerFinder(const FunctionRef &func) : func_(func) {}
+
+  void Visit_(const Call *op) final {
+    if (op->call_type == Call::Halide) {
+      if (op->func.same_as(func_) && in_call_ > 0) {
+        found_ = true;
+      }
+      IRVisitor::Visit_(op);
+      return;
+    }
+    ++in_call_;
+    IRVisitor::Visit_(op);
+    --in_call_;
+  }
+
+  bool found_{false};
+
+ private:
+  FunctionRef func_;
+  int in_call_{0};
+};
+
+bool SwizzleSharedTensor(const FunctionRef &func, int key_dim, int swizzle_words, int elem_per_word, Stmt *stmt) {
+  SharedPointerFinder finder(func);
+  finder.Visit(*stmt);
+  if (finder.found_) {
+    return false;
+  }
+  *stmt = SharedSwizzleMutator(func, key_dim, swizzle_words, elem_per_word).Mutate(*stmt);
+  return true;
+}
+
 Stmt GpuIslEmitter::InsertRealize(Stmt stmt, const isl::id &var) {
   stmt = FindInnerRealize(var.get_name()).Mutate(stmt);
 
@@ -1396,6 +1841,19 @@ Stmt GpuIslEmitter::InsertRealize(Stmt stmt, const isl::id &var) {
   }
   info_.user_config_.SetBind(t, buf);
   stmt = TensorSubstitute2(stmt, t->op->func_name(), t->op, t->value_index);
+  auto swizzle_map = info_.analysis_result_.GetSharedSwizzleMap();
+  auto swizzle = swizzle_map.find(t->op->name);
+  if (swizzle != swizzle_map.end()) {
+    int key_dim = swizzle->second.first;
+    int swizzle_words = swizzle->second.second;
+    int elem_per_word = std::max(1, SHARED_MEM_BANK_BYTES / t->dtype.bytes());
+    if (SwizzleSharedTensor(t->op, key_dim, swizzle_words, elem_per_word, &stmt)) {
+      stmt = AttrStmt::make(t->op, SHARED_MEM_SWIZZLE,
+                            StringImm::make(std::to_string(key_dim) + " " + std::to_string(swizzle_words)), stmt);
+    } else {
+      LOG(WARNING) << "Shared tensor " << t->op->name << " is passed to a call, its layout is not swizzled.";
+    }
+  }
   stmt = Realize::make(t->op, t->value_index, t->dtype, bounds, const_true(1), stmt);
   realized_.insert(t);
   stmt = AttrStmt::make(t->op, air::ir::attr::realize_scope, FindRealizeScope(var), stmt);
@@ -28,6 +28,7 @@ namespace poly {
 constexpr auto AKG_ALL_REDUCE = "akg_reduce::ALL_REDUCE";
 constexpr auto AKG_X_REDUCE = "akg_reduce::REDUCE2D_X";
 constexpr auto AKG_Y_REDUCE = "akg_reduce::REDUCE2D_Y";
+constexpr auto AKG_X_WARP_REDUCE = "akg_reduce::REDUCE2D_X_WARP";
 
 // example:
 // red_init_SumOp_S_1_0
@@ -59,11 +60,13 @@ constexpr auto AKG_REDUCE_LIB_NAME = "AkgReduce";
 constexpr auto PARIS_REDUCE_LIB_SPACE = "paris_reduce";
 constexpr auto PARIS_REDUCE_LIB_NAME = "ParisReduce";
 constexpr auto AKG_REDUCE_RETURN_NAME = "AkgAtomicReturn";
+constexpr auto AKG_DETERMINISTIC_RETURN_NAME = "AkgDeterministicReturn";
 constexpr auto PARIS_REDUCE_RETURN_NAME = "ParisReturn";
 constexpr auto REDUCE_LIB_TYPE_FLAG = "reduceLibType";
 
 constexpr auto MEM_TYPE_SHARED = "shared";
 constexpr auto MEM_TYPE_LOCAL = "local";
+constexpr auto SHARED_MEM_SWIZZLE = "shared_mem_swizzle";
 
 // add for one dimension mapping
 constexpr auto ORIGIN_THREAD_DIM_X = "bind_thread_x";
@@ -86,6 +89,28 @@ constexpr auto FRAGMENT_B = "fragment_b";
 constexpr auto FRAGMENT_C = "fragment_c";
 
 std::string SimplifyName(std::string input);
+
+/*!
+ * \brief Index of the current block among the blocks that reduce into the output element args, in block_idx, and
+ *  the number of these blocks, in reduce_blocks. The block dims that the output index does not depend on, directly or
+ *  through the bounds in iter_bound_map, split the reduction. Returns false when a block dim that selects the output
+ *  element is divided or taken modulo, as it then also splits the reduction and the blocks can not be numbered.
+ */
+bool MakeReduceBlockIndex(const Array<Expr> &args, const std::unordered_map<const Variable *, Expr> &iter_bound_map,
+                          const std::vector<std::pair<VarExpr, int>> &block_dims, Expr *block_idx,
+                          int64_t *reduce_blocks);
+
+/*!
+ * \brief Remove the block and warp syncs of the emitted kernel that order no conflicting accesses.
+ */
+Stmt EliminateSyncs(const Stmt &kernel);
+
+/*!
+ * \brief Rewrite the accesses of the shared tensor func in stmt to its xor swizzled layout: the groups of swizzle_words
+ *  words of the innermost index are permuted by the index of key_dim. Returns false and keeps stmt when a pointer to
+ *  the tensor is passed to a call, which would read the linear layout.
+ */
+bool SwizzleSharedTensor(const FunctionRef &func, int key_dim, int swizzle_words, int elem_per_word, Stmt *stmt);
 constexpr auto FOR_INFO_COLLECT_DEPTH = 3;
 constexpr auto LOCAL_INDEX_POS = 4;
 constexpr auto TENSOR_CORE_MODE_ONE = "1";
@@ -163,6 +188,7 @@ class TensorCoreInfo {
   std::unordered_map<std::string, Array<Expr>> min_bounds_;
 
   std::string wmma_scope_;
+  bool fuse_epilogue_{false};
 };
 
 class GpuIslEmitter : public IslEmitter {
@@ -193,6 +219,7 @@ class GpuIslEmitter : public IslEmitter {
   isl::multi_aff TensorAccessMultAff(isl::id &tensor_id, const Array<Expr> &subscripts, const isl::id &stmt_id);
 
   Stmt EmitSync();
+  Stmt EmitWarpSync();
   Stmt EmitReduceInit(const isl::ast_node_user &node);
   Stmt EmitReduceUpdate(const isl::ast_node_user &node);
   Stmt EmitReduceArea(const isl::ast_node_user &node);
@@ -240,6 +267,8 @@ class GpuIslEmitter : public IslEmitter {
   std::set<Tensor> realized_;
 
   std::unordered_map<const Variable *, Expr> stride_modify_iter_map_;
+  // init and extent of the loops, to find the variables an index depends on through its loops
+  std::unordered_map<const Variable *, Expr> iter_bound_map_;
   std::map<std::string, VarExpr> iter_name_map_{{B0, VarExpr(BLOCK_IDX_X)},  {B1, VarExpr(BLOCK_IDX_Y)},
                                                 {B2, VarExpr(BLOCK_IDX_Z)},  {T0, VarExpr(THREAD_IDX_X)},
                                                 {T1, VarExpr(THREAD_IDX_Y)}, {T2, VarExpr(THREAD_IDX_Z)}};
@@ -0,0 +1,126 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "poly/isl_ctx_pool.h"
+
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace akg {
+namespace ir {
+namespace poly {
+// contexts kept by one thread, more are only needed by nested Poly runs and are freed on release
+constexpr size_t MAX_FREE_CTX = 4;
+
+namespace {
+double ElapsedMs(const std::chrono::high_resolution_clock::time_point &start) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start)
+           .count() *
+         1000;
+}
+}  // namespace
+
+IslCtxOptions IslCtxOptions::Get(isl_ctx *ctx) {
+  IslCtxOptions options;
+  options.schedule_max_constant_term = isl_options_get_schedule_max_constant_term(ctx);
+  options.schedule_maximize_coincidence = isl_options_get_schedule_maximize_coincidence(ctx);
+  options.schedule_nonneg_var_coefficient = isl_options_get_schedule_nonneg_var_coefficient(ctx);
+  options.schedule_serialize_sccs = isl_options_get_schedule_serialize_sccs(ctx);
+  options.schedule_unit_max_var_coefficient_sum = isl_options_get_schedule_unit_max_var_coefficient_sum(ctx);
+  options.schedule_whole_component = isl_options_get_schedule_whole_component(ctx);
+  options.tile_scale_tile_loops = isl_options_get_tile_scale_tile_loops(ctx);
+  options.tile_shift_point_loops = isl_options_get_tile_shift_point_loops(ctx);
+  options.ast_build_group_coscheduled = isl_options_get_ast_build_group_coscheduled(ctx);
+  return options;
+}
+
+void IslCtxOptions::Set(isl_ctx *ctx) const {
+  static_cast<void>(isl_options_set_schedule_max_constant_term(ctx, schedule_max_constant_term));
+  static_cast<void>(isl_options_set_schedule_maximize_coincidence(ctx, schedule_maximize_coincidence));
+  static_cast<void>(isl_options_set_schedule_nonneg_var_coefficient(ctx, schedule_nonneg_var_coefficient));
+  static_cast<void>(isl_options_set_schedule_serialize_sccs(ctx, schedule_serialize_sccs));
+  static_cast<void>(
+    isl_options_set_schedule_unit_max_var_coefficient_sum(ctx, schedule_unit_max_var_coefficient_sum));
+  static_cast<void>(isl_options_set_schedule_whole_component(ctx, schedule_whole_component));
+  static_cast<void>(isl_options_set_tile_scale_tile_loops(ctx, tile_scale_tile_loops));
+  static_cast<void>(isl_options_set_tile_shift_point_loops(ctx, tile_shift_point_loops));
+  static_cast<void>(isl_options_set_ast_build_group_coscheduled(ctx, ast_build_group_coscheduled));
+}
+
+IslCtxPool &IslCtxPool::Local() {
+  static thread_local IslCtxPool pool;
+  return pool;
+}
+
+isl::ctx IslCtxPool::Acquire() {
+  if (!free_.empty()) {
+    used_.push_back(free_.back());
+    free_.pop_back();
+    ++reused_;
+    return isl::ctx(used_.back().ctx);
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  PooledCtx pooled;
+  pooled.ctx = isl_ctx_alloc();
+  CHECK(pooled.ctx != nullptr) << "failed to allocate isl ctx.";
+  pooled.options = IslCtxOptions::Get(pooled.ctx);
+  alloc_ms_ += ElapsedMs(start);
+  ++created_;
+  used_.push_back(pooled);
+  return isl::ctx(pooled.ctx);
+}
+
+void IslCtxPool::Release(const isl::ctx &ctx) {
+  auto it = std::find_if(used_.begin(), used_.end(),
+                         [&ctx](const PooledCtx &pooled) { return pooled.ctx == ctx.get(); });
+  CHECK(it != used_.end()) << "isl ctx is not acquired from the pool.";
+  PooledCtx pooled = *it;
+  used_.erase(it);
+  if (free_.size() >= MAX_FREE_CTX) {
+    auto start = std::chrono::high_resolution_clock::now();
+    isl_ctx_free(pooled.ctx);
+    free_ms_ += ElapsedMs(start);
+    ++freed_;
+    return;
+  }
+  pooled.options.Set(pooled.ctx);
+  isl_ctx_reset_error(pooled.ctx);
+  isl_ctx_reset_operations(pooled.ctx);
+  free_.push_back(pooled);
+}
+
+std::string IslCtxPool::Report() const {
+  double avg_cost = created_ == 0 ? 0 : alloc_ms_ / created_;
+  if (freed_ > 0) {
+    avg_cost += free_ms_ / freed_;
+  }
+  std::stringstream ss;
+  ss << "isl ctx pool: " << (created_ + reused_) << " acquired, " << created_ << " allocated, " << reused_
+     << " reused, saved about " << (avg_cost * reused_) << " ms";
+  return ss.str();
+}
+
+IslCtxPool::~IslCtxPool() {
+  // contexts still used here belong to a Poly run that never released them, freeing them would abort in isl.
+  for (const auto &pooled : free_) {
+    isl_ctx_free(pooled.ctx);
+  }
+}
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
@@ -0,0 +1,83 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POLY_ISL_CTX_POOL_H_
+#define POLY_ISL_CTX_POOL_H_
+
+#include "isl.h"
+
+#include <string>
+#include <vector>
+
+namespace akg {
+namespace ir {
+namespace poly {
+/*
+ * Values of the isl options changed by the schedule passes, so that a released ctx can be reset to the state it was
+ * allocated with.
+ */
+struct IslCtxOptions {
+  int schedule_max_constant_term{0};
+  int schedule_maximize_coincidence{0};
+  int schedule_nonneg_var_coefficient{0};
+  int schedule_serialize_sccs{0};
+  int schedule_unit_max_var_coefficient_sum{0};
+  int schedule_whole_component{0};
+  int tile_scale_tile_loops{0};
+  int tile_shift_point_loops{0};
+  int ast_build_group_coscheduled{0};
+
+  static IslCtxOptions Get(isl_ctx *ctx);
+  void Set(isl_ctx *ctx) const;
+};
+
+/*
+ * Thread local pool of isl contexts. Poly acquires a ctx for each AutoPoly or GenTuningSpace call and releases it
+ * once the scop is destroyed; a released ctx gets its options and error state reset and is reused by the next call
+ * of the same thread instead of being freed.
+ */
+class IslCtxPool {
+ public:
+  static IslCtxPool &Local();
+
+  isl::ctx Acquire();
+  // all the isl objects of ctx must have been freed before.
+  void Release(const isl::ctx &ctx);
+  std::string Report() const;
+
+  ~IslCtxPool();
+
+ private:
+  IslCtxPool() = default;
+
+  struct PooledCtx {
+    isl_ctx *ctx;
+    IslCtxOptions options;
+  };
+
+  std::vector<PooledCtx> free_;
+  std::vector<PooledCtx> used_;
+  size_t created_{0};
+  size_t reused_{0};
+  // time spent in allocating and freeing contexts, in ms
+  double alloc_ms_{0};
+  double free_ms_{0};
+  size_t freed_{0};
+};
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
+#endif  // POLY_ISL_CTX_POOL_H_
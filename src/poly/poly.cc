@@ -15,6 +15,7 @@
  */
 
 #include "poly/scop.h"
+#include "poly/isl_ctx_pool.h"
 namespace akg {
 namespace ir {
 /*!
@@ -22,13 +23,13 @@ namespace ir {
  */
 class Poly {
  public:
-  Poly() : isl_ctx_(isl::ctx(isl_ctx_alloc())) {}
+  Poly() : isl_ctx_(poly::IslCtxPool::Local().Acquire()) {}
 
   ~Poly() noexcept {
     scop_->info_.user_config_.FreeReplaceConfig();
     scop_.reset();
-    // scop must be deconstructed before isl_ctx is deconstructed
-    isl_ctx_free(isl_ctx_.get());
+    // scop must be deconstructed before isl_ctx is reset and returned to the pool
+    poly::IslCtxPool::Local().Release(isl_ctx_);
   }
 
   void Run(const Stmt &stmt, const Map<Tensor, Buffer> &extern_buffer, std::string target,
@@ -119,5 +120,7 @@ NodeRef GenTuningSpace(const Stmt &stmt, std::string target, const Map<Tensor, B
   poly.Run(stmt, extern_buffer, target, attrs, is_specgemm, true, false, sch);
   return poly.GetSpaces();
 }
+
+std::string IslCtxPoolReport() { return poly::IslCtxPool::Local().Report(); }
 }  // namespace ir
 }  // namespace akg
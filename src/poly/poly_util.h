@@ -342,6 +342,8 @@ constexpr auto THREAD_IDX_Y = "threadIdx.y";
 constexpr auto THREAD_IDX_Z = "threadIdx.z";
 
 constexpr auto SYNC_FLAG = "_sync_";
+constexpr auto WARP_SYNC_FLAG = "_warpSync_";
+constexpr auto WARP_SYNC = "__syncwarp";
 constexpr auto STORAGE_SYNC = "tvm_storage_sync";
 constexpr auto REDUCE = "reduce";
 constexpr auto SYNC_SCOP_WARP = "warp";
@@ -400,8 +402,12 @@ constexpr auto MATRIX_A = "matrix_a";
 constexpr auto MATRIX_B = "matrix_b";
 constexpr auto MATRIX_C = "matrix_c";
 constexpr auto FRAGMENT = "fragment_";
+constexpr auto FRAGMENT_EPILOGUE = "akg_fragment_epilogue";
+constexpr auto FRAGMENT_ELEM = "akg_fragment_elem";
 constexpr auto LOCAL_SUFFIX = "_local";
 constexpr auto SHARE_SUFFIX = "_shared";
+constexpr auto SHARED_MEM_BANKS = 32;
+constexpr auto SHARED_MEM_BANK_BYTES = 4;
 
 const std::unordered_set<std::string> AkgSupportedReduceOp = {AKG_REDUCE_SUM, AKG_REDUCE_MIN, AKG_REDUCE_MAX,
                                                               AKG_REDUCE_AND, AKG_REDUCE_OR};
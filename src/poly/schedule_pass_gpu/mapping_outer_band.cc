@@ -16,7 +16,10 @@
 
 #include "mapping_outer_band.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <numeric>
+#include <set>
 
 #include "poly/schedule_tree_util.h"
 #include "poly/sync_manager.h"
@@ -97,6 +100,180 @@ size_t MappingOuterBand::CountConsecutiveCoincident(const isl::schedule_node_ban
   return count;
 }
 
+// stride of a member whose adjacent threads do not access a fixed distance apart
+constexpr int64_t UNCOALESCED_STRIDE = 1 << 16;
+constexpr int SECTOR_BYTES = 32;
+
+int64_t CountWarpSectors(const std::vector<int64_t> &strides, const std::vector<int64_t> &lanes, int dtype_bytes) {
+  CHECK_EQ(strides.size(), lanes.size());
+  int64_t threads = 1;
+  for (auto lane : lanes) {
+    threads *= std::max<int64_t>(lane, 1);
+  }
+  std::set<int64_t> sectors;
+  for (int64_t tid = 0; tid < std::min<int64_t>(threads, WARP_SIZE); ++tid) {
+    int64_t rest = tid;
+    int64_t address = 0;
+    for (size_t d = 0; d < lanes.size(); ++d) {
+      int64_t lane = std::max<int64_t>(lanes[d], 1);
+      address += (rest % lane) * std::abs(strides[d]) * dtype_bytes;
+      rest /= lane;
+    }
+    sectors.insert(address / SECTOR_BYTES);
+  }
+  return static_cast<int64_t>(sectors.size());
+}
+
+/*
+ * Distance in elements between the addresses accessed by two instances whose local schedule only differs by one
+ * in a member of the band, for each member of the band starting at band_depth.
+ */
+std::vector<int64_t> MappingOuterBand::GetMemberStrides(const isl::map &schedule_access, size_t band_depth,
+                                                        size_t n_member) {
+  std::vector<int64_t> shape;
+  std::string tensor_name = schedule_access.get_tuple_id(isl_dim_out).get_name();
+  for (auto bind : scop_info_.user_config_.GetBind()) {
+    if (bind.first->op->name != tensor_name) {
+      continue;
+    }
+    for (auto dim : bind.first->shape) {
+      const int64_t *extent = as_const_int(dim);
+      shape.push_back(extent != nullptr ? *extent : UNCOALESCED_STRIDE);
+    }
+  }
+
+  std::vector<int64_t> strides;
+  auto schedule_space = schedule_access.get_space().domain();
+  for (size_t member = 0; member < n_member; ++member) {
+    auto schedule_next = CreateMapIncreaseDim(schedule_space, band_depth + member);
+    auto deltas = schedule_next.apply_domain(schedule_access).apply_range(schedule_access).deltas();
+    if (deltas.is_empty()) {
+      strides.push_back(0);
+      continue;
+    }
+    if (!deltas.is_singleton()) {
+      strides.push_back(UNCOALESCED_STRIDE);
+      continue;
+    }
+    auto point = deltas.sample_point();
+    auto tensor_dim = static_cast<int>(deltas.dim(isl_dim_set));
+    bool known_shape = shape.size() == static_cast<size_t>(tensor_dim);
+    int64_t stride = 0;
+    int64_t inner_size = 1;
+    for (int i = tensor_dim - 1; i >= 0; --i) {
+      auto delta = isl::manage(isl_point_get_coordinate_val(point.get(), isl_dim_set, i)).get_num_si();
+      if (delta != 0 && i != tensor_dim - 1 && !known_shape) {
+        stride = UNCOALESCED_STRIDE;
+        break;
+      }
+      stride += delta * inner_size;
+      inner_size = known_shape ? std::min(inner_size * shape[i], UNCOALESCED_STRIDE) : inner_size;
+    }
+    strides.push_back(std::min(std::abs(stride), UNCOALESCED_STRIDE));
+  }
+  return strides;
+}
+
+/*
+ * The band members of a permutable and coincident band can be mapped to threadIdx.x/y/z in any order.
+ * Every order is scored by the global memory sectors accessed by a block, and the members are permuted so that
+ * the default inner-to-x mapping applies the cheapest order. The default order is kept on ties.
+ */
+isl::schedule_node_band MappingOuterBand::ReorderThreadBand(const isl::schedule_node_band &band_node,
+                                                            MappingCfg *thread_cfg) {
+  size_t n_member = band_node.n_member();
+  if (n_member < 2 || n_member > thread_cfg->bound || !band_node.get_permutable() ||
+      CountConsecutiveCoincident(band_node) < n_member) {
+    return band_node;
+  }
+
+  auto accesses = scop_info_.analysis_result_.GetReads().domain_factor_domain();
+  accesses = accesses.unite(scop_info_.analysis_result_.GetWrites().domain_factor_domain());
+  accesses = accesses.intersect_domain(CollectDomain(band_node));
+  if (accesses.is_empty()) {
+    return band_node;
+  }
+
+  auto partial_schedule = band_node.get_partial_schedule();
+  std::vector<int64_t> extents;
+  for (size_t i = 0; i < n_member; ++i) {
+    extents.push_back(partial_schedule.get_at(i).max_val().get_num_si() + 1);
+  }
+
+  std::vector<std::vector<int64_t>> access_strides;
+  std::vector<int> access_bytes;
+  auto schedule = LocalSchedule(band_node);
+  size_t band_depth = band_node.schedule_depth();
+  for (auto access : accesses.get_map_list()) {
+    auto stmt_schedule = schedule.intersect_domain(isl::union_set(access.domain()));
+    auto schedule_access = isl::union_map(access).apply_domain(stmt_schedule);
+    int dtype_bytes = scop_info_.user_config_.GetDataType(access.get_tuple_id(isl_dim_out).get_name());
+    for (auto item : schedule_access.get_map_list()) {
+      access_strides.emplace_back(GetMemberStrides(item, band_depth, n_member));
+      access_bytes.emplace_back(dtype_bytes);
+    }
+  }
+
+  auto CountTransactions = [&](const std::vector<int> &order) -> int64_t {
+    std::vector<int64_t> lanes;
+    int64_t threads = 1;
+    for (size_t d = 0; d < order.size(); ++d) {
+      lanes.push_back(std::min<int64_t>(extents[order[d]], thread_cfg->GetAt(d).second));
+      threads *= lanes.back();
+    }
+    int64_t warps = (threads + WARP_SIZE - 1) / WARP_SIZE;
+    int64_t transactions = 0;
+    for (size_t i = 0; i < access_strides.size(); ++i) {
+      std::vector<int64_t> strides;
+      for (auto member : order) {
+        strides.push_back(access_strides[i][member]);
+      }
+      transactions += CountWarpSectors(strides, lanes, access_bytes[i]) * warps;
+    }
+    return transactions;
+  };
+
+  // the default mapping sends the innermost member to threadIdx.x
+  ThreadOrderDecision decision;
+  std::vector<int> default_order(n_member);
+  for (size_t d = 0; d < n_member; ++d) {
+    default_order[d] = static_cast<int>(n_member - 1 - d);
+  }
+  decision.orders.push_back(default_order);
+  decision.transactions.push_back(CountTransactions(default_order));
+  std::vector<int> order(n_member);
+  std::iota(order.begin(), order.end(), 0);
+  do {
+    if (order == default_order) {
+      continue;
+    }
+    decision.orders.push_back(order);
+    decision.transactions.push_back(CountTransactions(order));
+    if (decision.transactions.back() < decision.transactions[decision.best]) {
+      decision.best = decision.orders.size() - 1;
+    }
+  } while (std::next_permutation(order.begin(), order.end()));
+  scop_info_.analysis_result_.RecordThreadOrderDecision(decision);
+  if (decision.best == 0) {
+    return band_node;
+  }
+
+  // member n_member - 1 - d of the new band is the one mapped to the d-th thread dim
+  auto best_order = decision.orders[decision.best];
+  isl::union_pw_aff_list new_upal;
+  for (size_t i = 0; i < n_member; ++i) {
+    auto upa = partial_schedule.get_at(best_order[n_member - 1 - i]);
+    new_upal = (i == 0) ? isl::union_pw_aff_list(upa) : new_upal.add(upa);
+  }
+  auto new_mupa = isl::multi_union_pw_aff(partial_schedule.get_space(), new_upal);
+  auto new_node = band_node.del().insert_partial_schedule(new_mupa).as<isl::schedule_node_band>();
+  new_node = new_node.set_permutable(1);
+  for (size_t i = 0; i < n_member; ++i) {
+    new_node = new_node.member_set_coincident(static_cast<int>(i), 1);
+  }
+  return new_node;
+}
+
 isl::schedule_node MappingOuterBand::FillRemainingThreads(isl::schedule_node &node, size_t begin) {
   auto thread_cfg = scop_info_.user_config_.GetThreadConfig();
   CHECK(thread_cfg != nullptr) << "threadconfig is null";
@@ -292,10 +469,13 @@ isl::schedule_node MappingOuterBand::DoThreadSynchronization(const isl::schedule
   std::sort(all_syncs.begin(), all_syncs.end(),
             [](Synchronization s1, Synchronization s2) { return s1.pos >= s2.pos; });
 
-  // Step 4. Insert sync node (extension and filter) in the sequence node
+  // Step 4. Insert sync node (extension and filter) in the sequence node. Warp syncs are only emitted along with
+  //         the sync elimination, otherwise every sync is a block sync.
+  bool warp_sync = scop_info_.user_config_.GetEnableSyncElimination();
   for (const auto &sync : all_syncs) {
     auto target = sync_node.child(sync.pos).child(0);
-    sync_node = sync_manager.InsertExtensionNode(target, sync.level, true).parent().parent();
+    auto level = (sync.level == SyncLevel::WARP && !warp_sync) ? SyncLevel::BLOCK : sync.level;
+    sync_node = sync_manager.InsertExtensionNode(target, level, true).parent().parent();
   }
 
   auto next = head->next.release();
@@ -518,6 +698,11 @@ size_t MappingOuterBand::MapThreadHelper(isl::schedule_node &thread_root) {
   Mapping mapping;
   bool is_y_reduce =
     scop_info_.analysis_result_.GetReduceDirection() == Y_DIRECTION || scop_info_.user_config_.GetEnableTensorCore();
+  if (!is_reduce_stmt && !is_bmm_statement && !is_y_reduce &&
+      scop_info_.user_config_.GetEnableCoalescedThreadOrder()) {
+    band_node = ReorderThreadBand(band_node, thread_cfg);
+    thread_root = band_node;
+  }
   auto after_map_pair = MapInnerDimToThreads(band_node, false, thread_cfg, mapping, is_y_reduce);
   thread_root = after_map_pair.first;
   if (is_bmm_statement && !GetMarkerName(thread_root, THREAD_MARKER).empty()) {
@@ -542,13 +727,18 @@ size_t MappingOuterBand::MapThreadHelper(isl::schedule_node &thread_root) {
   }
   thread_root = thread_root.ancestor(end_node_depth);
 
-  // Step 4. Do unroll if needed.
-  if (scop_info_.user_config_.GetMaxUnrollLoop() != 1) {
+  // Step 4. Do unroll if needed. Without a user-defined unroll, the loop over the elements of a coarsened thread is
+  // unrolled so that its index computation is shared by the elements.
+  int max_unroll_loop = scop_info_.user_config_.GetMaxUnrollLoop();
+  if (max_unroll_loop == 1) {
+    max_unroll_loop = scop_info_.user_config_.GetThreadCoarsenFactor();
+  }
+  if (max_unroll_loop != 1) {
     isl::schedule_node after_fix_node = thread_root.child(0);
     if (!IsEqualNode(after_map_pair.second, after_map_pair.first)) {
       after_fix_node = after_fix_node.parent();
     }
-    thread_root = UnrollByMarkOptions(after_fix_node, scop_info_.user_config_.GetMaxUnrollLoop());
+    thread_root = UnrollByMarkOptions(after_fix_node, max_unroll_loop);
   }
 
   return thread_cfg->bound;
@@ -733,8 +923,10 @@ isl::schedule MappingOuterBand::DoBlockMapping(const isl::schedule &sch) {
   // Step 1. Determine max num dimension of blocks that can be mapped.
   auto block_cfg = scop_info_.user_config_.GetBlockConfig();
   CHECK(block_cfg != nullptr) << "block config is null";
-  auto n_block_map =
-    scop_info_.user_config_.GetEnableAkgReduceLib() ? band_node.n_member() : CountConsecutiveCoincident(band_node);
+  // With split k, the reduction axis of the matmul is also distributed over blocks.
+  bool split_k = scop_info_.user_config_.GetSplitK() > 1;
+  auto n_block_map = (scop_info_.user_config_.GetEnableAkgReduceLib() || split_k) ? band_node.n_member()
+                                                                                  : CountConsecutiveCoincident(band_node);
   n_block_map = std::min(block_cfg->MaxDim(), n_block_map);
   n_block_map = std::min(block_cfg->bound, n_block_map);
   if (n_block_map < 1) {
@@ -752,7 +944,10 @@ isl::schedule MappingOuterBand::DoBlockMapping(const isl::schedule &sch) {
     block_cfg->SwapConfig(0, new_idx);
   }
 
-  if (scop_info_.user_config_.GetEnableAtomicAdd() && NeedAtomicAdd(band_node, n_block_map)) {
+  if (split_k) {
+    MarkSplitKTensor();
+  } else if ((scop_info_.user_config_.GetEnableAtomicAdd() || scop_info_.user_config_.GetEnableDeterministicReduce()) &&
+             NeedAtomicAdd(band_node, n_block_map)) {
     MarkAtomicAddTensor(band_node);
   }
 
@@ -832,6 +1027,14 @@ void MappingOuterBand::MarkAtomicAddTensor(const isl::schedule_node_band &band)
   });
 }
 
+void MappingOuterBand::MarkSplitKTensor() {
+  for (const auto &it : scop_info_.analysis_result_.GetMatrixMatmulMap()) {
+    if (it.second == MATRIX_C) {
+      scop_info_.analysis_result_.RecordAtomicTensors(AtomicInfo{it.first, AKG_REDUCE_SUM});
+    }
+  }
+}
+
 isl::schedule MappingOuterBand::Run(isl::schedule sch) {
   auto node = sch.root().child(0);
   node = InsertContextNode(node, scop_info_);
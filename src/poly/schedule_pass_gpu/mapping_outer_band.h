@@ -24,6 +24,12 @@ namespace akg {
 namespace ir {
 namespace poly {
 
+/*
+ * Sectors of 32 bytes touched by the first warp of a block, when thread dim d (x, y, z) has lanes[d] threads
+ * and moves the accessed address by strides[d] elements of dtype_bytes each.
+ */
+int64_t CountWarpSectors(const std::vector<int64_t> &strides, const std::vector<int64_t> &lanes, int dtype_bytes);
+
 /*
  * Mapping the outer band to blocks and threads to enable parallelism in Gpu.
  */
@@ -42,6 +48,7 @@ class MappingOuterBand : public SchedulePass {
   std::pair<std::string, std::string> GetC1C0BlockConfig(size_t n_block_map, int member_size);
   bool NeedAtomicAdd(const isl::schedule_node_band &band, size_t n_block_map);
   void MarkAtomicAddTensor(const isl::schedule_node_band &band);
+  void MarkSplitKTensor();
   isl::schedule_node MapBlockHelper(const isl::schedule_node &node, MappingCfg *block_cfg, size_t n_block_map,
                                     bool check_extent);
 
@@ -55,6 +62,10 @@ class MappingOuterBand : public SchedulePass {
 
   size_t CountConsecutiveCoincident(const isl::schedule_node_band &band_node);
 
+  // coalescing aware order of the band members mapped to threads
+  isl::schedule_node_band ReorderThreadBand(const isl::schedule_node_band &band_node, MappingCfg *thread_cfg);
+  std::vector<int64_t> GetMemberStrides(const isl::map &schedule_access, size_t band_depth, size_t n_member);
+
   isl::schedule_node DoThreadSynchronization(const isl::schedule_node &node);
 
   // preparation for synchronization
@@ -17,6 +17,7 @@
 #include "register_memory_manager.h"
 
 #include <numeric>
+#include <unordered_set>
 
 #include "poly/scop.h"
 #include "poly/dma_inject.h"
@@ -340,7 +341,7 @@ void RegisterMemoryManager::CreateTensorCluster(const isl::schedule_node &node,
   }
 }
 
-void RegisterMemoryManager::IsOutofMemory(std::vector<BufferDefInfo> promoted_infos) {
+size_t RegisterMemoryManager::GetRegisterCap() {
   int64_t alloc_threads = 1;
   auto thread_cfg = scop_info_.user_config_.GetThreadConfig();
   if (thread_cfg != nullptr) {
@@ -348,20 +349,110 @@ void RegisterMemoryManager::IsOutofMemory(std::vector<BufferDefInfo> promoted_in
       alloc_threads *= thread_cfg->GetAt(i).second;
     }
   }
-  size_t total_alloc_size = 0;
+  int64_t min_blocks = std::max(1, scop_info_.user_config_.GetMinBlocksPerSm());
+  int64_t cap =
+    static_cast<int64_t>(MAX_REGISTER_PER_THREAD_BLOCK * REGISTER_ALLOC_RATIO) / (alloc_threads * min_blocks);
+  return static_cast<size_t>(std::min<int64_t>(cap, MAX_REGISTER_PER_THREAD));
+}
+
+/* Estimate the registers of the temporaries created by the emitter. Each statement keeps its
+ * operands that are not promoted and its result in registers, and the loops over the footprint
+ * of a promoted tensor are unrolled, so several iterations of them are live at the same time. */
+size_t RegisterMemoryManager::EstimateTemporaryRegister(const std::vector<BufferDefInfo> &promoted_infos) {
+  // the promoted tensor may be named after its shared copy, the statements read the original tensor
+  auto OriginTensorName = [this](const isl::id &tensor_id) -> std::string {
+    std::string name = tensor_id.get_name();
+    size_t pos = name.rfind(SHARE_SUFFIX);
+    if (pos != std::string::npos && pos + std::string(SHARE_SUFFIX).size() == name.size()) {
+      name = name.substr(0, pos);
+    }
+    return scop_info_.GetOriginTensorId(name).get_name();
+  };
+  std::unordered_set<std::string> promoted_tensors;
+  size_t unroll_extent = 1;
+  for (const auto &promoted_info : promoted_infos) {
+    promoted_tensors.insert(OriginTensorName(promoted_info.tensor_id));
+    if (UnrolledLoop(*promoted_info.footprints_cluster)) {
+      auto box_sizes = promoted_info.footprints_cluster->GetFixedBoxSizes();
+      unroll_extent = std::max(unroll_extent, box_sizes.back());
+    }
+  }
+  size_t stmt_temporaries = 0;
+  for (const auto &item : scop_info_.StmtReadMap()) {
+    size_t operands = 1;
+    for (const auto &read : item.second) {
+      if (promoted_tensors.count(read.get_name()) == 0) {
+        ++operands;
+      }
+    }
+    stmt_temporaries = std::max(stmt_temporaries, operands);
+  }
+  return RESERVED_REGISTER_PER_THREAD +
+         stmt_temporaries * std::min<size_t>(unroll_extent, static_cast<size_t>(MAX_UNROLL_INTERLEAVE));
+}
+
+/* Check the register pressure of the promoted tensors. Without enable_register_cap, they are checked
+ * against the whole register file of the block. Otherwise they are checked against the register cap of
+ * the occupancy goal, and when spills are predicted, the largest tensors are left in global or shared
+ * memory until the rest fits; the matmul fragments are promoted together or not at all. */
+void RegisterMemoryManager::IsOutofMemory(std::vector<BufferDefInfo> &promoted_infos) {
   memory_exceeding_ = false;
-  for (auto promoted_info : promoted_infos) {
+  auto GetTensorRegister = [this](const BufferDefInfo &promoted_info) -> size_t {
     auto box_sizes = promoted_info.footprints_cluster->GetFixedBoxSizes();
-    if (!box_sizes.empty()) {
-      auto tensor_size = std::accumulate(box_sizes.begin(), box_sizes.end(), 1, std::multiplies<size_t>());
-      auto data_bytes = scop_info_.user_config_.GetDataType(promoted_info.tensor_id.get_name());
-      total_alloc_size += tensor_size * std::max<int>(1, data_bytes / BYTES_PER_REGISTER);
+    if (box_sizes.empty()) {
+      return 0;
+    }
+    auto tensor_size = std::accumulate(box_sizes.begin(), box_sizes.end(), 1, std::multiplies<size_t>());
+    auto data_bytes = scop_info_.user_config_.GetDataType(promoted_info.tensor_id.get_name());
+    return tensor_size * std::max<int>(1, data_bytes / BYTES_PER_REGISTER);
+  };
+
+  if (!scop_info_.user_config_.GetEnableRegisterCap()) {
+    // whole register file of the block, no temporaries: the promotion is kept or dropped as a whole
+    int64_t alloc_threads = 1;
+    auto thread_cfg = scop_info_.user_config_.GetThreadConfig();
+    if (thread_cfg != nullptr) {
+      for (size_t i = 0; i < thread_cfg->bound; ++i) {
+        alloc_threads *= thread_cfg->GetAt(i).second;
+      }
+    }
+    size_t total_alloc_size = 0;
+    for (const auto &promoted_info : promoted_infos) {
+      total_alloc_size += GetTensorRegister(promoted_info);
       if (total_alloc_size * alloc_threads > MAX_REGISTER_PER_THREAD_BLOCK * REGISTER_ALLOC_RATIO) {
         memory_exceeding_ = true;
         break;
       }
     }
+    return;
+  }
+
+  size_t register_cap = GetRegisterCap();
+  auto IsSpilled = [this, &promoted_infos, &GetTensorRegister, register_cap]() -> bool {
+    size_t total_alloc_size = 0;
+    for (const auto &promoted_info : promoted_infos) {
+      total_alloc_size += GetTensorRegister(promoted_info);
+    }
+    return total_alloc_size + EstimateTemporaryRegister(promoted_infos) > register_cap;
+  };
+
+  if (promoted_infos.empty() || !IsSpilled()) {
+    return;
+  }
+  if (scop_info_.user_config_.GetEnableMatmul()) {
+    memory_exceeding_ = true;
+    return;
+  }
+  std::stable_sort(promoted_infos.begin(), promoted_infos.end(),
+                   [&GetTensorRegister](const BufferDefInfo &a, const BufferDefInfo &b) {
+                     return GetTensorRegister(a) < GetTensorRegister(b);
+                   });
+  while (!promoted_infos.empty() && IsSpilled()) {
+    LOG(DEBUG) << "Register spill predicted, keep " << promoted_infos.back().tensor_id.get_name()
+               << " out of registers, the register cap per thread is " << register_cap;
+    promoted_infos.pop_back();
   }
+  memory_exceeding_ = promoted_infos.empty();
 }
 
 void RegisterMemoryManager::GatherBufferFootprintDefInfo(const isl::schedule_node &node, BufferDefInfo &tensor_info) {
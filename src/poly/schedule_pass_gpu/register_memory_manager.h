@@ -26,6 +26,11 @@ namespace poly {
 constexpr auto MAX_REGISTER_PER_THREAD_BLOCK = 65536;
 constexpr auto BYTES_PER_REGISTER = 4;
 constexpr auto REGISTER_ALLOC_RATIO = 1.0;  // percentage of local memory that allocated to tensors
+constexpr auto MAX_REGISTER_PER_THREAD = 255;
+// registers kept by the emitter for thread indices, loop vars, addresses and predicates
+constexpr auto RESERVED_REGISTER_PER_THREAD = 16;
+// independent iterations of an unrolled loop whose temporaries are live at the same time
+constexpr auto MAX_UNROLL_INTERLEAVE = 4;
 constexpr auto M_N_K_COUNT = 3;
 constexpr auto M_POSITION = 0;
 constexpr auto N_POSITION = 1;
@@ -64,7 +69,11 @@ class RegisterMemoryManager : public SchedulePass {
 
   isl::schedule HoistRegisterMemory(isl::schedule_node root, size_t depth);
 
-  void IsOutofMemory(std::vector<BufferDefInfo> promoted_infos);
+  void IsOutofMemory(std::vector<BufferDefInfo> &promoted_infos);
+
+  size_t GetRegisterCap();
+
+  size_t EstimateTemporaryRegister(const std::vector<BufferDefInfo> &promoted_infos);
 
   size_t UpdateDepth(const isl::schedule_node &root);
 
@@ -19,6 +19,7 @@
 #include "poly/scop.h"
 #include "poly/dma_inject.h"
 #include "poly/poly_util.h"
+#include <algorithm>
 #include <vector>
 #include <numeric>
 
@@ -84,7 +85,9 @@ isl::schedule_node SharedMemoryManager::HoistSharedMemoryOnMark(const isl::sched
   auto ab_promote_node = ab_mark_node.parent();
   hoist_tensor_c_ = false;
   auto ab_res_node = ManageToShareBelow(this->schedule_, ab_promote_node, remain_memory);
-  if (find(configed_tensors_.begin(), configed_tensors_.end(), tensor_c_) != configed_tensors_.end()) {
+  // the partial results of split k are accumulated in shared memory before their atomic add to the output.
+  if (find(configed_tensors_.begin(), configed_tensors_.end(), tensor_c_) != configed_tensors_.end() ||
+      scop_info_.user_config_.GetSplitK() > 1) {
     auto c_mark_node = CollectMarkNode(ab_res_node.get_schedule().get_root(), PROMOTE_GLOBAL_TO_SHARED_C);
     auto c_promote_node = c_mark_node.parent();
     hoist_tensor_c_ = true;
@@ -343,7 +346,9 @@ std::set<std::string> SharedMemoryManager::AnalysisReduceTensors() {
 
   /*************************************************
    * In order to enable cuda atomic operator, add
-   * these tensors for shared memory promotion list
+   * these tensors for shared memory promotion list.
+   * The deterministic return combines the same
+   * partial results from shared memory.
    *************************************************/
   auto atomic_tensors = scop_info_.analysis_result_.GetAtomicTensors();
   if (!atomic_tensors.empty()) {
@@ -435,6 +440,9 @@ void SharedMemoryManager::CreateClusterList(const isl::schedule_node &node, cons
     if (id_sets.count(tensor_b_) == 0) {
       id_sets.emplace(tensor_b_);
     }
+    if (scop_info_.user_config_.GetSplitK() > 1 && id_sets.count(tensor_c_) == 0) {
+      id_sets.emplace(tensor_c_);
+    }
   }
 
   for (auto item : id_sets) {
@@ -490,18 +498,27 @@ void SharedMemoryManager::GatherBufferFootprintDefInfo(const isl::schedule_node
     tensor_info.AddSize(node, sizes);
     return;
   }
-  sizes = fp_cluster->GetFixedBoxSizes();
-  if (scop_info_.user_config_.GetEnableMatmul() && sizes.back() % 2 == 0) {
-    sizes.back() += 16;
-  }
-
-  if (bank_conflict_) {
-    sizes = OptimizeBankConflict(sizes);
-  }
-
   isl::id tensor_id = tensor_info.tensor_id;
   isl::id cluster_id = tensor_info.dst_tensor_id;
 
+  auto layout = shared_layouts_.find(tensor_id.get_name());
+  if (layout != shared_layouts_.end()) {
+    sizes = layout->second.sizes;
+    if (layout->second.swizzle_words > 0) {
+      scop_info_.analysis_result_.RecordSharedSwizzle(cluster_id.get_name(), layout->second.key_dim,
+                                                      layout->second.swizzle_words);
+    }
+  } else {
+    sizes = fp_cluster->GetFixedBoxSizes();
+    if (scop_info_.user_config_.GetEnableMatmul() && sizes.back() % 2 == 0) {
+      sizes.back() += 16;
+    }
+
+    if (bank_conflict_) {
+      sizes = OptimizeBankConflict(sizes);
+    }
+  }
+
   // build a Halide Node for cluster_id
   Array<Expr> shapes;
   for (auto i : sizes) {
@@ -523,10 +540,104 @@ void SharedMemoryManager::GatherBufferFootprintDefInfo(const isl::schedule_node
   tensor_info.AddSize(node, sizes);
 }
 
+std::vector<size_t> SelectPromotions(const std::vector<PromotionCandidate> &candidates, size_t capacity) {
+  // weigh the candidates in units of the gcd of their requirements to keep the table small
+  size_t unit = 0;
+  for (const auto &candidate : candidates) {
+    size_t a = unit;
+    size_t b = candidate.memory_requirement;
+    while (b != 0) {
+      size_t r = a % b;
+      a = b;
+      b = r;
+    }
+    unit = a;
+  }
+  unit = std::max<size_t>(unit, 1);
+  size_t slots = capacity / unit;
+  size_t n = candidates.size();
+  std::vector<std::vector<int64_t>> saved(n + 1, std::vector<int64_t>(slots + 1, 0));
+  for (size_t i = 0; i < n; ++i) {
+    size_t weight = candidates[i].memory_requirement / unit;
+    for (size_t s = 0; s <= slots; ++s) {
+      saved[i + 1][s] = saved[i][s];
+      if (weight <= s && saved[i][s - weight] + candidates[i].saved_bytes > saved[i + 1][s]) {
+        saved[i + 1][s] = saved[i][s - weight] + candidates[i].saved_bytes;
+      }
+    }
+  }
+
+  std::vector<size_t> selected;
+  size_t s = slots;
+  for (size_t i = n; i > 0; --i) {
+    if (saved[i][s] != saved[i - 1][s]) {
+      selected.push_back(i - 1);
+      s -= candidates[i - 1].memory_requirement / unit;
+    }
+  }
+  std::reverse(selected.begin(), selected.end());
+  return selected;
+}
+
+std::vector<size_t> PlanPromotions(const std::vector<PromotionCandidate> &clusters, const std::vector<bool> &required,
+                                   size_t *remaining_memory) {
+  std::vector<size_t> promoted;
+  std::vector<size_t> optional;
+  std::vector<PromotionCandidate> candidates;
+  for (size_t i = 0; i < clusters.size(); ++i) {
+    if (!required[i]) {
+      optional.push_back(i);
+      candidates.push_back(clusters[i]);
+    } else if (clusters[i].memory_requirement < *remaining_memory) {
+      promoted.push_back(i);
+      *remaining_memory -= clusters[i].memory_requirement;
+    }
+  }
+  // the budget check is strict, a cluster never takes the last byte
+  if (*remaining_memory > 0) {
+    for (auto pos : SelectPromotions(candidates, *remaining_memory - 1)) {
+      promoted.push_back(optional[pos]);
+      *remaining_memory -= candidates[pos].memory_requirement;
+    }
+  }
+  std::sort(promoted.begin(), promoted.end());
+  return promoted;
+}
+
+int64_t SavedBlockAccesses(const isl::union_map &outer_schedule, const isl::union_map &access, size_t footprint_size) {
+  int64_t accesses = 0;
+  for (auto stmt_access : access.get_map_list()) {
+    auto block_instances = outer_schedule.intersect_domain(isl::union_set(stmt_access.domain())).reverse();
+    for (auto instances : block_instances.get_map_list()) {
+      auto box = instances.get_range_simple_fixed_box_hull();
+      if (!box.is_valid()) {
+        return static_cast<int64_t>(footprint_size);
+      }
+      int64_t instance_size = 1;
+      for (const auto &val : box.get_size().get_val_list()) {
+        instance_size *= val.get_num_si();
+      }
+      accesses += instance_size;
+    }
+  }
+  return std::max<int64_t>(accesses - static_cast<int64_t>(footprint_size), 0);
+}
+
+/*
+ * The clusters the reduce, atomic and matmul code relies on are promoted first, in tensor order. The remaining
+ * clusters are ranked by the global traffic a block saves, and the subset that saves the most bytes within the
+ * left shared memory is promoted.
+ */
 isl::schedule_node SharedMemoryManager::HoistClusters(const isl::schedule_node &root_node,
                                                       const isl::schedule_node &node, size_t &remaining_memory) {
   auto partial_sched_mupa = ShortScheduleMupa(root_node, node);
-  auto res_node = node;
+  // the footprints are computed for one point of the local schedule, the accesses are counted for the same point
+  auto outer_schedule = LocalSchedule(node);
+  auto active_domains = CollectDomain(node);
+  std::vector<size_t> indices;
+  std::vector<PromotionCandidate> clusters;
+  std::vector<bool> required;
+  std::vector<bool> injective;
   for (size_t index = 0; index < scop_info_.analysis_result_.buffer_def_infos_.size(); index++) {
     BufferDefInfo &buffer_info = scop_info_.analysis_result_.buffer_def_infos_[index];
     auto fp_cluster = buffer_info.GetFootPrintClusterGPU(node);
@@ -552,36 +663,52 @@ isl::schedule_node SharedMemoryManager::HoistClusters(const isl::schedule_node &
       LOG(FATAL) << "Can not manage a scalar tensor";
     }
 
-    box_sizes = OptimizeBankConflict(box_sizes);
+    if (bank_conflict_ && !scop_info_.user_config_.GetEnableMatmul()) {
+      auto layout = OptimizeSharedLayout(root_node, *fp_cluster, id);
+      box_sizes = layout.sizes;
+      shared_layouts_[id.get_name()] = layout;
+    } else {
+      box_sizes = OptimizeBankConflict(box_sizes);
+    }
 
     auto approximation_size = std::accumulate(box_sizes.begin(), box_sizes.end(), 1, std::multiplies<size_t>());
     size_t byte = Bytes(id);
     size_t memory_requirement = approximation_size * byte;
-    bool use_reuse_filter = true;
-    if (InAtomicTensors(buffer_info.tensor_id.name()) || InReduceTensors(buffer_info.tensor_id.name())) {
-      use_reuse_filter = false;
+    bool is_required = InAtomicTensors(buffer_info.tensor_id.name()) ||
+                       InReduceTensors(buffer_info.tensor_id.name()) || scop_info_.user_config_.GetEnableMatmul();
+    bool is_injective = !is_required && !ReuseTensorCluster(*fp_cluster, partial_sched_mupa);
+    // an injective cluster is only promoted to coalesce its global accesses, which saves about its own size
+    int64_t saved_bytes = static_cast<int64_t>(memory_requirement);
+    if (!is_required && !is_injective) {
+      auto access = fp_cluster->OrigianlAccessRelations().intersect_domain(active_domains);
+      saved_bytes = SavedBlockAccesses(outer_schedule, access, approximation_size) * static_cast<int64_t>(byte);
     }
-    bool is_injective = !ReuseTensorCluster(*fp_cluster, partial_sched_mupa);
-    if (scop_info_.user_config_.GetEnableMatmul()) {
-      is_injective = false;
-    }
-    if (memory_requirement < remaining_memory) {
-      if (use_reuse_filter && is_injective && !CoalescingAccessWay(root_node, res_node, *fp_cluster)) {
-        continue;
-      }
-      GatherBufferFootprintDefInfo(res_node, buffer_info);
-      res_node = HoistToBlockThreadMemory(res_node, GpuMemType::SHARED, id, *(fp_cluster), true);
-      remaining_memory -= memory_requirement;
+    indices.push_back(index);
+    clusters.push_back(PromotionCandidate{memory_requirement, saved_bytes});
+    required.push_back(is_required);
+    injective.push_back(is_injective);
+  }
 
-      // collect active_buffer_footprints_ info for codegen
-      auto out_schedule = LocalSchedule(res_node);
-      auto active_domains = CollectDomain(res_node);
-      auto dst_id = GpuDstId(GpuMemType::SHARED, id);
-      scop_info_.analysis_result_.active_buffer_footprints_.emplace_back(std::make_pair(
-        active_domains,
-        BufferedFootPrintInfo{std::shared_ptr<TensorFootprintCluster>(std::move(fp_cluster)), out_schedule, dst_id}));
-      buffer_info.find_buffer = true;
+  auto res_node = node;
+  for (auto pos : PlanPromotions(clusters, required, &remaining_memory)) {
+    BufferDefInfo &buffer_info = scop_info_.analysis_result_.buffer_def_infos_[indices[pos]];
+    auto fp_cluster = buffer_info.GetFootPrintClusterGPU(node);
+    if (injective[pos] && !CoalescingAccessWay(root_node, res_node, *fp_cluster)) {
+      remaining_memory += clusters[pos].memory_requirement;
+      continue;
     }
+    auto id = buffer_info.tensor_id;
+    GatherBufferFootprintDefInfo(res_node, buffer_info);
+    res_node = HoistToBlockThreadMemory(res_node, GpuMemType::SHARED, id, *(fp_cluster), true);
+
+    // collect active_buffer_footprints_ info for codegen
+    auto out_schedule = LocalSchedule(res_node);
+    auto res_domains = CollectDomain(res_node);
+    auto dst_id = GpuDstId(GpuMemType::SHARED, id);
+    scop_info_.analysis_result_.active_buffer_footprints_.emplace_back(std::make_pair(
+      res_domains,
+      BufferedFootPrintInfo{std::shared_ptr<TensorFootprintCluster>(std::move(fp_cluster)), out_schedule, dst_id}));
+    buffer_info.find_buffer = true;
   }
   return res_node;
 }
@@ -748,6 +875,101 @@ std::vector<size_t> SharedMemoryManager::OptimizeBankConflict(std::vector<size_t
   return res;
 }
 
+/*
+ * Find the tensor dimension that adjacent threads in x step along when accessing the cluster. When several
+ * accesses step along different dimensions, the outermost one is returned since it causes the most bank
+ * conflicts. Returns -1 if no access steps along a single dimension.
+ */
+int SharedMemoryManager::ThreadStrideDim(const isl::schedule_node &root, const TensorFootprintCluster &cluster) {
+  isl::union_map original = cluster.OrigianlAccessRelations();
+  int tensor_dim = static_cast<int>(cluster.foot_print_.GetBoxDim());
+  int stride_dim = -1;
+  std::vector<isl::schedule_node> thread_marker = CollectFnNode(IsThreadMappedMark, root);
+  for (auto item : thread_marker) {
+    if (!item.has_children() || !item.child(0).isa<isl::schedule_node_filter>()) {
+      continue;
+    }
+    isl::schedule_node thread_filter = item.child(0);
+    if (!thread_filter.has_children()) {
+      continue;
+    }
+    isl::schedule_node thread_band = thread_filter.child(0);
+    if (!thread_band.has_children()) {
+      continue;
+    }
+    isl::schedule_node inner_band = thread_band.child(0);
+    size_t num_mapped_thread = inner_band.schedule_depth() - thread_band.schedule_depth();
+    if (num_mapped_thread == 0) {
+      continue;
+    }
+    size_t inner_depth = inner_band.schedule_depth();
+    auto active_domains = CollectDomain(thread_band);
+    auto local_access = original.intersect_domain(active_domains);
+    auto schedule = ShortSchedule(inner_band);
+    auto schedule_access = local_access.apply_domain(schedule);
+    for (auto access : schedule_access.get_map_list()) {
+      auto schedule_space = access.get_space().domain();
+      auto tensor_space = access.get_space().range();
+      auto schedule_next = CreateMapIncreaseDim(schedule_space, inner_depth - 1);
+      auto access_by_adjacent_inner = schedule_next.apply_domain(access).apply_range(access);
+      if (access_by_adjacent_inner.is_empty()) {
+        continue;
+      }
+      for (int dim = tensor_dim - 1; dim >= 0; --dim) {
+        if (access_by_adjacent_inner.is_subset(CreateMapIncreaseDim(tensor_space, dim))) {
+          stride_dim = stride_dim == -1 ? dim : std::min(stride_dim, dim);
+          break;
+        }
+      }
+    }
+  }
+  return stride_dim;
+}
+
+/*
+ * Choose the layout of a shared tensor from the banks that a warp touches. If adjacent threads step along an
+ * outer dimension whose stride is a multiple of the bank count, the words of the innermost dimension are
+ * permuted by xor with the index of that dimension, which spreads the warp over all banks at no memory cost.
+ * The xor keeps groups of vectorized words contiguous. Only when the innermost dimension cannot be permuted
+ * within itself, it is padded by one bank word.
+ */
+SharedLayout SharedMemoryManager::OptimizeSharedLayout(const isl::schedule_node &root,
+                                                       const TensorFootprintCluster &cluster,
+                                                       const isl::id &tensor_id) {
+  SharedLayout layout;
+  layout.sizes = cluster.GetFixedBoxSizes();
+  int dims = static_cast<int>(layout.sizes.size());
+  int stride_dim = ThreadStrideDim(root, cluster);
+  if (dims < 2 || stride_dim < 0 || stride_dim == dims - 1) {
+    return layout;
+  }
+
+  size_t bytes = Bytes(tensor_id);
+  size_t stride = std::accumulate(layout.sizes.begin() + stride_dim + 1, layout.sizes.end(), static_cast<size_t>(1),
+                                  std::multiplies<size_t>());
+  if ((stride * bytes) % SHARED_MEM_BANK_BYTES != 0) {
+    return layout;
+  }
+  size_t stride_words = stride * bytes / SHARED_MEM_BANK_BYTES;
+  // the bank count is a power of two, so an odd stride in words already visits every bank.
+  if (stride_words % 2 == 1) {
+    return layout;
+  }
+
+  size_t inner_bytes = layout.sizes.back() * bytes;
+  if (bytes <= static_cast<size_t>(SHARED_MEM_BANK_BYTES) &&
+      inner_bytes % (SHARED_MEM_BANKS * SHARED_MEM_BANK_BYTES) == 0) {
+    int vector_words = scop_info_.user_config_.GetVectorLoadType() / (SHARED_MEM_BANK_BYTES * 8);
+    layout.key_dim = stride_dim;
+    layout.swizzle_words = std::max(1, vector_words);
+    return layout;
+  }
+  if (stride_dim == dims - 2) {
+    layout.sizes.back() += std::max<size_t>(1, SHARED_MEM_BANK_BYTES / bytes);
+  }
+  return layout;
+}
+
 }  // namespace poly
 }  // namespace ir
 }  // namespace akg
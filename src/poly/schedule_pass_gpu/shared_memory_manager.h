@@ -25,6 +25,45 @@ namespace poly {
 
 using TensorClusters = std::pair<isl::id, std::vector<std::shared_ptr<TensorFootprintCluster>>>;
 
+/*
+ * Layout of a promoted shared tensor: the padded sizes, and the xor swizzle of the innermost dimension if
+ * swizzle_words > 0, keyed by the index of key_dim.
+ */
+struct SharedLayout {
+  std::vector<size_t> sizes;
+  int key_dim{-1};
+  int swizzle_words{0};
+};
+
+/*
+ * A footprint cluster that may be promoted to shared memory, with the bytes it occupies and the global memory
+ * traffic of a block it saves.
+ */
+struct PromotionCandidate {
+  size_t memory_requirement;
+  int64_t saved_bytes;
+};
+
+/*
+ * Solve the 0/1 knapsack of the candidates: the positions of the subset that saves the most bytes
+ * while their memory requirements sum to at most capacity, in increasing order.
+ */
+std::vector<size_t> SelectPromotions(const std::vector<PromotionCandidate> &candidates, size_t capacity);
+
+/*
+ * The clusters to promote, in increasing order: the required ones first-fit in their order, then the subset of the
+ * others that saves the most bytes within the left memory. remaining_memory is reduced by the chosen clusters.
+ */
+std::vector<size_t> PlanPromotions(const std::vector<PromotionCandidate> &clusters, const std::vector<bool> &required,
+                                   size_t *remaining_memory);
+
+/*
+ * Global accesses one block saves by promoting a footprint of footprint_size elements. The accesses of a block are
+ * the instances of one point of outer_schedule, counted by their fixed box, and the promoted copy reads each element
+ * of the footprint once. The footprint is assumed to be read twice when the instances of a block are unbounded.
+ */
+int64_t SavedBlockAccesses(const isl::union_map &outer_schedule, const isl::union_map &access, size_t footprint_size);
+
 /*
  * Manager shared memory in GPU.
  */
@@ -66,13 +105,15 @@ class SharedMemoryManager : public SchedulePass {
                                               TensorFootprintCluster &cluster, bool force_last_extension_odd);
 
   bool ReuseTensorCluster(const TensorFootprintCluster &cluster, const isl::multi_union_pw_aff &outer_pw_aff);
-
   bool CoalescingAccessWay(const isl::schedule_node &root, const isl::schedule_node &node,
                            const TensorFootprintCluster &cluster);
 
   void UpdateDepth(const isl::schedule_node &root);
 
   std::vector<size_t> OptimizeBankConflict(std::vector<size_t> sizes);
+  SharedLayout OptimizeSharedLayout(const isl::schedule_node &root, const TensorFootprintCluster &cluster,
+                                    const isl::id &tensor_id);
+  int ThreadStrideDim(const isl::schedule_node &root, const TensorFootprintCluster &cluster);
   bool UnderThreadMarker(size_t depth);
 
   std::string InAtomicTensors(isl::schedule_node &node);
@@ -102,6 +143,7 @@ class SharedMemoryManager : public SchedulePass {
   std::string tensor_c_;
   std::string tensor_a_;
   std::string tensor_b_;
+  std::unordered_map<std::string, SharedLayout> shared_layouts_;
 };
 
 }  // namespace poly
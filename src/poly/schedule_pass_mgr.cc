@@ -15,6 +15,9 @@
  */
 
 #include "poly/schedule_pass_mgr.h"
+#include "poly/schedule_snapshot.h"
+
+#include <dirent.h>
 
 namespace akg {
 namespace ir {
@@ -34,6 +37,38 @@ isl::schedule SchedulePassMgr::Run(const isl::schedule &sch) {
   return Run(sch, schedule_passes_);
 }
 
+std::unordered_set<std::string> SchedulePassMgr::CollectScheduleOverrides() const {
+  std::unordered_set<std::string> overrides;
+  std::string dir = scop_info_.AddDumpDir("");
+  DIR *dp = opendir(dir.empty() ? "." : dir.c_str());
+  if (dp == nullptr) {
+    return overrides;
+  }
+  for (struct dirent *entry = readdir(dp); entry != nullptr; entry = readdir(dp)) {
+    overrides.insert(entry->d_name);
+  }
+  static_cast<void>(closedir(dp));
+  return overrides;
+}
+
+bool SchedulePassMgr::LoadScheduleOverride(const std::unordered_set<std::string> &overrides,
+                                           const std::string &pass_name, isl::schedule &schedule) {
+  if (overrides.count(pass_name + SNAPSHOT_SUFFIX)) {
+    ScheduleSnapshot snapshot;
+    if (LoadScheduleSnapshotFromFile(scop_info_.AddDumpDir(pass_name + SNAPSHOT_SUFFIX), schedule.ctx(), snapshot) &&
+        snapshot.schedule) {
+      schedule = snapshot.schedule;
+      // the pass reads the access relations of the checkpoint, not the ones of the replaced schedule.
+      RestoreAnalysisResult(snapshot, scop_info_.analysis_result_);
+      return true;
+    }
+  }
+  if (overrides.count(pass_name + ".txt")) {
+    return LoadScheduleTreeFromFile(scop_info_.AddDumpDir(pass_name + ".txt"), schedule);
+  }
+  return false;
+}
+
 isl::schedule SchedulePassMgr::Run(const isl::schedule &sch, const std::vector<std::shared_ptr<SchedulePass>> &passes) {
   CHECK(sch);
 
@@ -43,9 +78,11 @@ isl::schedule SchedulePassMgr::Run(const isl::schedule &sch, const std::vector<s
   auto final_sch = sch;
   auto replace_sch = sch;
   need_restart_ = false;
+  // list the dump dir once instead of probing an override file for every pass
+  auto overrides = CollectScheduleOverrides();
 
   for (auto &pass : passes) {
-    if (LoadScheduleTreeFromFile(scop_info_.AddDumpDir(pass->GetPassName() + ".txt"), replace_sch)) {
+    if (LoadScheduleOverride(overrides, pass->GetPassName(), replace_sch)) {
       if (!replace_sch.plain_is_equal(final_sch)) {
         final_sch = replace_sch;
         LOG(WARNING) << (pass->GetPassName() + " input schedule had been replaced  !!!");
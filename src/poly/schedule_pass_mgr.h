@@ -20,6 +20,8 @@
 #include "poly/schedule_pass.h"
 #include "poly/pass_mgr_strategy.h"
 
+#include <unordered_set>
+
 namespace akg {
 namespace ir {
 namespace poly {
@@ -37,6 +39,12 @@ class SchedulePassMgr {
   bool need_restart_{false};
   ScopInfo &scop_info_;
  private:
+  // names of the files in the dump dir, where <pass name>.txt or <pass name>.snap replace the input of a pass
+  std::unordered_set<std::string> CollectScheduleOverrides() const;
+  // a .snap also replaces the access relations recorded in the analysis result
+  bool LoadScheduleOverride(const std::unordered_set<std::string> &overrides, const std::string &pass_name,
+                            isl::schedule &schedule);
+
   std::vector<std::shared_ptr<SchedulePass>> schedule_passes_;
 };
 }  // namespace poly
@@ -0,0 +1,298 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "poly/schedule_snapshot.h"
+
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace akg {
+namespace ir {
+namespace poly {
+namespace {
+constexpr auto SNAPSHOT_MAGIC = "AKGSNAP";
+constexpr char SNAPSHOT_VERSION = 1;
+// marks an index of the identifier table in the encoded isl text, never printed by isl
+constexpr char NAME_REF = '\x01';
+// shorter identifiers are cheaper to keep in the text than to refer to
+constexpr size_t MIN_NAME_REF_LEN = 3;
+
+enum class SnapshotSection : char {
+  SCHEDULE = 0,
+  READS,
+  WRITES,
+  COPYIN,
+  FAKE_COPYIN,
+  TRANSFER_STMT,
+  INTER_BAND_DEPENDENCY,
+};
+
+void WriteVarint(size_t value, std::string &out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(const std::string &in, size_t &pos, size_t &value) {
+  value = 0;
+  for (size_t shift = 0; pos < in.size() && shift < sizeof(size_t) * 8; shift += 7) {
+    auto byte = static_cast<unsigned char>(in[pos++]);
+    value |= static_cast<size_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsNameStart(char c) { return isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+
+bool IsNameChar(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '\''; }
+
+class NameTable {
+ public:
+  std::string Encode(const std::string &text) {
+    CHECK(text.find(NAME_REF) == std::string::npos) << "unexpected character in isl text";
+    std::string out;
+    size_t i = 0;
+    while (i < text.size()) {
+      if (!IsNameStart(text[i])) {
+        out.push_back(text[i++]);
+        continue;
+      }
+      size_t end = i + 1;
+      while (end < text.size() && IsNameChar(text[end])) {
+        ++end;
+      }
+      std::string name = text.substr(i, end - i);
+      if (name.size() < MIN_NAME_REF_LEN) {
+        out += name;
+      } else {
+        auto it = index_.find(name);
+        if (it == index_.end()) {
+          it = index_.emplace(name, names_.size()).first;
+          names_.push_back(name);
+        }
+        out.push_back(NAME_REF);
+        WriteVarint(it->second, out);
+      }
+      i = end;
+    }
+    return out;
+  }
+
+  bool Decode(const std::string &data, std::string &text) const {
+    text.clear();
+    size_t pos = 0;
+    while (pos < data.size()) {
+      if (data[pos] != NAME_REF) {
+        text.push_back(data[pos++]);
+        continue;
+      }
+      ++pos;
+      size_t idx = 0;
+      if (!ReadVarint(data, pos, idx) || idx >= names_.size()) {
+        return false;
+      }
+      text += names_[idx];
+    }
+    return true;
+  }
+
+  void Write(std::string &out) const {
+    WriteVarint(names_.size(), out);
+    for (const auto &name : names_) {
+      WriteVarint(name.size(), out);
+      out += name;
+    }
+  }
+
+  bool Read(const std::string &in, size_t &pos) {
+    size_t count = 0;
+    if (!ReadVarint(in, pos, count)) {
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      size_t len = 0;
+      if (!ReadVarint(in, pos, len) || pos + len > in.size()) {
+        return false;
+      }
+      names_.push_back(in.substr(pos, len));
+      pos += len;
+    }
+    return true;
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, size_t> index_;
+};
+
+std::string ScheduleToFlowStr(const isl::schedule &sch) {
+  isl_printer *printer = isl_printer_to_str(sch.ctx().get());
+  CHECK(printer);
+  printer = isl_printer_set_yaml_style(printer, ISL_YAML_STYLE_FLOW);
+  printer = isl_printer_print_schedule(printer, sch.get());
+  char *s = isl_printer_get_str(printer);
+  static_cast<void>(isl_printer_free(printer));
+  CHECK(s);
+  std::string str(s);
+  std::free(s);
+  return str;
+}
+}  // namespace
+
+ScheduleSnapshot MakeScheduleSnapshot(const isl::schedule &sch, const AnalysisResult &result) {
+  ScheduleSnapshot snapshot;
+  snapshot.schedule = sch;
+  snapshot.reads = result.GetReads();
+  snapshot.writes = result.GetWrites();
+  snapshot.copyin = result.GetCopyin();
+  snapshot.fake_copyin = result.GetFakeCopyin();
+  snapshot.transfer_stmt = result.GetTransferStmt();
+  snapshot.inter_band_dependency = result.GetInnerBandDependency();
+  return snapshot;
+}
+
+void RestoreAnalysisResult(const ScheduleSnapshot &snapshot, AnalysisResult &result) {
+  if (snapshot.reads) result.RecordReads(snapshot.reads);
+  if (snapshot.writes) result.RecordWrites(snapshot.writes);
+  if (snapshot.copyin) result.RecordCopyin(snapshot.copyin);
+  if (snapshot.fake_copyin) result.RecordFakeCopyin(snapshot.fake_copyin);
+  if (snapshot.transfer_stmt) result.RecordTransferStmt(snapshot.transfer_stmt);
+  if (snapshot.inter_band_dependency) result.RecordInnerBandDependency(snapshot.inter_band_dependency);
+}
+
+std::string SerializeScheduleSnapshot(const ScheduleSnapshot &snapshot) {
+  NameTable names;
+  std::vector<std::pair<SnapshotSection, std::string>> sections;
+  auto add_section = [&names, &sections](SnapshotSection kind, const std::string &text) {
+    sections.emplace_back(kind, names.Encode(text));
+  };
+  if (snapshot.schedule) add_section(SnapshotSection::SCHEDULE, ScheduleToFlowStr(snapshot.schedule));
+  if (snapshot.reads) add_section(SnapshotSection::READS, snapshot.reads.to_str());
+  if (snapshot.writes) add_section(SnapshotSection::WRITES, snapshot.writes.to_str());
+  if (snapshot.copyin) add_section(SnapshotSection::COPYIN, snapshot.copyin.to_str());
+  if (snapshot.fake_copyin) add_section(SnapshotSection::FAKE_COPYIN, snapshot.fake_copyin.to_str());
+  if (snapshot.transfer_stmt) add_section(SnapshotSection::TRANSFER_STMT, snapshot.transfer_stmt.to_str());
+  if (snapshot.inter_band_dependency) {
+    add_section(SnapshotSection::INTER_BAND_DEPENDENCY, snapshot.inter_band_dependency.to_str());
+  }
+
+  std::string out(SNAPSHOT_MAGIC);
+  out.push_back(SNAPSHOT_VERSION);
+  names.Write(out);
+  WriteVarint(sections.size(), out);
+  for (const auto &section : sections) {
+    out.push_back(static_cast<char>(section.first));
+    WriteVarint(section.second.size(), out);
+    out += section.second;
+  }
+  return out;
+}
+
+bool DeserializeScheduleSnapshot(const isl::ctx &ctx, const std::string &data, ScheduleSnapshot &snapshot) {
+  std::string magic(SNAPSHOT_MAGIC);
+  if (data.compare(0, magic.size(), magic) != 0 || data.size() <= magic.size() ||
+      data[magic.size()] != SNAPSHOT_VERSION) {
+    LOG(WARNING) << "not a schedule snapshot of version " << static_cast<int>(SNAPSHOT_VERSION);
+    return false;
+  }
+  size_t pos = magic.size() + 1;
+  NameTable names;
+  size_t count = 0;
+  if (!names.Read(data, pos) || !ReadVarint(data, pos, count)) {
+    return false;
+  }
+  ScheduleSnapshot result;
+  for (size_t i = 0; i < count; ++i) {
+    size_t len = 0;
+    if (pos >= data.size()) {
+      return false;
+    }
+    auto kind = static_cast<SnapshotSection>(data[pos++]);
+    std::string text;
+    if (!ReadVarint(data, pos, len) || pos + len > data.size() || !names.Decode(data.substr(pos, len), text)) {
+      return false;
+    }
+    pos += len;
+    if (kind == SnapshotSection::SCHEDULE) {
+      result.schedule = isl::manage(isl_schedule_read_from_str(ctx.get(), text.c_str()));
+      if (!result.schedule) return false;
+      continue;
+    }
+    if (kind == SnapshotSection::TRANSFER_STMT) {
+      result.transfer_stmt = isl::manage(isl_union_set_read_from_str(ctx.get(), text.c_str()));
+      if (!result.transfer_stmt) return false;
+      continue;
+    }
+    isl::union_map map = isl::manage(isl_union_map_read_from_str(ctx.get(), text.c_str()));
+    if (!map) return false;
+    switch (kind) {
+      case SnapshotSection::READS:
+        result.reads = map;
+        break;
+      case SnapshotSection::WRITES:
+        result.writes = map;
+        break;
+      case SnapshotSection::COPYIN:
+        result.copyin = map;
+        break;
+      case SnapshotSection::FAKE_COPYIN:
+        result.fake_copyin = map;
+        break;
+      case SnapshotSection::INTER_BAND_DEPENDENCY:
+        result.inter_band_dependency = map;
+        break;
+      default:
+        LOG(WARNING) << "unknown schedule snapshot section " << static_cast<int>(kind);
+        return false;
+    }
+  }
+  snapshot = result;
+  return true;
+}
+
+bool DumpScheduleSnapshotToFile(const std::string &filename, const ScheduleSnapshot &snapshot) {
+  std::ofstream of(filename, std::ios::out | std::ios::binary);
+  if (!of.is_open()) {
+    LOG(WARNING) << "Failed to open schedule snapshot file " << filename;
+    return false;
+  }
+  std::string data = SerializeScheduleSnapshot(snapshot);
+  of.write(data.data(), static_cast<std::streamsize>(data.size()));
+  return of.good();
+}
+
+bool LoadScheduleSnapshotFromFile(const std::string &filename, const isl::ctx &ctx, ScheduleSnapshot &snapshot) {
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (!DeserializeScheduleSnapshot(ctx, data, snapshot)) {
+    LOG(WARNING) << "Failed to load schedule snapshot " << filename;
+    return false;
+  }
+  return true;
+}
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
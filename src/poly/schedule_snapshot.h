@@ -0,0 +1,60 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POLY_SCHEDULE_SNAPSHOT_H_
+#define POLY_SCHEDULE_SNAPSHOT_H_
+
+#include "poly/isl.h"
+#include "poly/scop_info.h"
+
+#include <string>
+
+namespace akg {
+namespace ir {
+namespace poly {
+constexpr auto SNAPSHOT_SUFFIX = ".snap";
+
+/*
+ * A schedule tree with the access relations of AnalysisResult, as checkpointed between schedule passes.
+ * Relations that are not computed yet stay null.
+ */
+struct ScheduleSnapshot {
+  isl::schedule schedule;
+  isl::union_map reads;
+  isl::union_map writes;
+  isl::union_map copyin;
+  isl::union_map fake_copyin;
+  isl::union_set transfer_stmt;
+  isl::union_map inter_band_dependency;
+};
+
+ScheduleSnapshot MakeScheduleSnapshot(const isl::schedule &sch, const AnalysisResult &result);
+void RestoreAnalysisResult(const ScheduleSnapshot &snapshot, AnalysisResult &result);
+
+/*
+ * Binary format: a magic number and version, a table of the isl identifiers used by the snapshot, then one section
+ * per defined object. Every object is kept as its unformatted isl text where each identifier is replaced by its
+ * index in the table, so the long tensor names are stored once and nothing needs pretty printing.
+ */
+std::string SerializeScheduleSnapshot(const ScheduleSnapshot &snapshot);
+bool DeserializeScheduleSnapshot(const isl::ctx &ctx, const std::string &data, ScheduleSnapshot &snapshot);
+
+bool DumpScheduleSnapshotToFile(const std::string &filename, const ScheduleSnapshot &snapshot);
+bool LoadScheduleSnapshotFromFile(const std::string &filename, const isl::ctx &ctx, ScheduleSnapshot &snapshot);
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
+#endif  // POLY_SCHEDULE_SNAPSHOT_H_
@@ -188,6 +188,7 @@ class UserConfig {
     ParseCustomTilingAttr(attrs, "custom_tiling", &custom_tiling_);
     ParseBoolAttr(attrs, "pragma_analyze_reuse_buffer", &pragma_analyze_reuse_buffer_);
     ParseBoolAttr(attrs, "pragma_speedup_tiling", &pragma_speedup_tiling_);
+    ParseBoolAttr(attrs, "enable_tiling_cost_model", &enable_tiling_cost_model_);
     ParseBoolAttr(attrs, "pragma_allow_tail_tiling", &pragma_allow_tail_tiling_);
     ParseBoolAttr(attrs, "pragma_analyze_multicore", &pragma_analyze_multicore_);
     ParseBoolAttr(attrs, "prune_tuning_space", &prune_tuning_space_);
@@ -227,25 +228,42 @@ class UserConfig {
 
     ParseIntAttr(attrs, "dump_tuning_level", &dump_tuning_level_);
     ParseBoolAttr(attrs, "dump_pass_ir", &dump_pass_ir_);
+    ParseBoolAttr(attrs, "dump_schedule_snapshot", &dump_schedule_snapshot_);
     ParseStringAttr(attrs, "dump_poly_dir", &dump_poly_dir_);
 
     if (GetTarget() == TARGET_CUDA) {
       ParseBoolAttr(attrs, "enable_tile_c0", &enable_tile_c0_);
       ParseBoolAttr(attrs, "enable_atomic_add", &enable_atomic_add_);
+      ParseBoolAttr(attrs, "enable_deterministic_reduce", &enable_deterministic_reduce_);
+      ParseBoolAttr(attrs, "enable_row_reduce_strategy", &enable_row_reduce_strategy_);
       ParseBoolAttr(attrs, "pragma_enable_tensor_core", &enable_tensor_core_);
       ParseBoolAttr(attrs, "pragma_enable_matmul", &enable_matmul_);
       ParseBoolAttr(attrs, "enable_tensor_core_use_poly", &enable_tensor_core_use_poly_);
+      ParseBoolAttr(attrs, "enable_mma_epilogue_fusion", &enable_mma_epilogue_fusion_);
       ParseBoolAttr(attrs, "enable_akg_reduce_lib", &enable_akg_reduce_lib_);
       ParseBoolAttr(attrs, "use_register_memory", &use_register_memory_);
       ParseBoolAttr(attrs, "use_shared_memory", &use_shared_memory_);
       ParseBoolAttr(attrs, "enable_bank_conflict_opt", &enable_bank_conflict_);
       ParseBoolAttr(attrs, "enable_one_dim_thread", &enable_one_dim_thread_);
+      ParseBoolAttr(attrs, "enable_coalesced_thread_order", &enable_coalesced_thread_order_);
+      ParseBoolAttr(attrs, "enable_sync_elimination", &enable_sync_elimination_);
+      ParseBoolAttr(attrs, "enable_thread_coarsening", &enable_thread_coarsening_);
       ParseIntAttr(attrs, "register_memory_depth", &register_depth_);
+      ParseBoolAttr(attrs, "enable_register_cap", &enable_register_cap_);
+      ParseIntAttr(attrs, "min_blocks_per_sm", &min_blocks_per_sm_);
+      ParseIntAttr(attrs, "split_k", &split_k_);
+      ParseIntAttr(attrs, "sm_count", &sm_count_);
       ParseIntAttr(attrs, "shared_memory_depth", &shared_depth_);
       ParseStringAttr(attrs, "shared_memory_tensors", &shared_tensors_);
       ParseStringAttr(attrs, "reduce_lib_type", &reduce_lib_type_);
       ParseStringAttr(attrs, "local_memory_tensors", &local_tensors_);
       ParseVectorLoadTypeAttr(attrs, "vector_load_type", &vector_load_type_);
+      if (enable_deterministic_reduce_ && (reduce_lib_type_ != "origin" || enable_tile_c0_)) {
+        // decided before tiling, so that the reduction is only split across blocks when atomic add is enabled.
+        LOG(WARNING) << "deterministic reduce is only supported by akg reduce lib without c0 tile, "
+                     << "it falls back to enable_atomic_add.";
+        enable_deterministic_reduce_ = false;
+      }
     }
 
     if (force_remove_self_dependence_) {
@@ -292,6 +310,8 @@ class UserConfig {
   void SetDefaultDim(std::string b_dim) { b_dim_ = b_dim; }
   void SetPragmaSpeedUpTiling(bool pragma_speedup_tiling) { pragma_speedup_tiling_ = pragma_speedup_tiling; }
   bool GetPragmaSpeedUpTiling() const { return pragma_speedup_tiling_; }
+  bool GetEnableTilingCostModel() const { return enable_tiling_cost_model_; }
+  void SetEnableTilingCostModel(bool enable_tiling_cost_model) { enable_tiling_cost_model_ = enable_tiling_cost_model; }
   bool GetPragmaAnalyzeReuseBuffer() const { return pragma_analyze_reuse_buffer_; }
   bool GetPragmaAllowTailTiling() const { return pragma_allow_tail_tiling_; }
   bool GetPragmaAnalyzeMulticore() const { return pragma_analyze_multicore_; }
@@ -345,6 +365,7 @@ class UserConfig {
   // getter for dump config
   int GetDumpTuningLevel() const { return dump_tuning_level_; }
   bool GetDumpPassIr() const { return dump_pass_ir_; }
+  bool GetDumpScheduleSnapshot() const { return dump_schedule_snapshot_; }
   std::string GetDumpPolyDir() { return dump_poly_dir_; }
 
   // setter for conv config
@@ -386,6 +407,8 @@ class UserConfig {
 
   bool GetEnableTileC0() { return enable_tile_c0_; }
   bool GetEnableAtomicAdd() { return enable_atomic_add_; }
+  bool GetEnableDeterministicReduce() { return enable_deterministic_reduce_; }
+  bool GetEnableRowReduceStrategy() { return enable_row_reduce_strategy_; }
 
   bool GetEnableAkgReduceLib() { return enable_akg_reduce_lib_; }
   void SetEnableAkgReduceLib(bool enable_akg_reduce_lib) { enable_akg_reduce_lib_ = enable_akg_reduce_lib; }
@@ -402,14 +425,36 @@ class UserConfig {
     enable_tensor_core_use_poly_ = enable_tensor_core_use_poly;
   }
 
+  bool GetEnableMmaEpilogueFusion() { return enable_mma_epilogue_fusion_; }
+
   bool GetEnableOneDimThread() { return enable_one_dim_thread_; }
   void SetEnableOneDimThread(bool enable_one_dim_thread) { enable_one_dim_thread_ = enable_one_dim_thread; }
 
+  bool GetEnableCoalescedThreadOrder() { return enable_coalesced_thread_order_; }
+  void SetEnableCoalescedThreadOrder(bool enable_coalesced_thread_order) {
+    enable_coalesced_thread_order_ = enable_coalesced_thread_order;
+  }
+
+  bool GetEnableSyncElimination() { return enable_sync_elimination_; }
+  void SetEnableSyncElimination(bool enable_sync_elimination) { enable_sync_elimination_ = enable_sync_elimination; }
+
+  bool GetEnableThreadCoarsening() { return enable_thread_coarsening_; }
+  void SetEnableThreadCoarsening(bool enable_thread_coarsening) {
+    enable_thread_coarsening_ = enable_thread_coarsening;
+  }
+  int GetThreadCoarsenFactor() { return thread_coarsen_factor_; }
+  void SetThreadCoarsenFactor(int thread_coarsen_factor) { thread_coarsen_factor_ = thread_coarsen_factor; }
+
   bool UseRegisterMemory() { return use_register_memory_; }
   bool UseSharedMemory() { return use_shared_memory_; }
   void SetUseSharedMemory(bool use_shared_memory) { use_shared_memory_ = use_shared_memory; }
   void SetUseRegisterMemory(bool use_register_memory) { use_register_memory_ = use_register_memory; }
   int GetRegisterDepth() { return register_depth_; }
+  bool GetEnableRegisterCap() { return enable_register_cap_; }
+  int GetMinBlocksPerSm() { return min_blocks_per_sm_; }
+  int GetSplitK() { return split_k_; }
+  void SetSplitK(int split_k) { split_k_ = split_k; }
+  int GetSmCount() { return sm_count_; }
   int GetSharedDepth() { return shared_depth_; }
   std::string GetSharedTensors() { return shared_tensors_; }
   std::string GetReduceLibType() { return reduce_lib_type_; }
@@ -511,7 +556,6 @@ class UserConfig {
   }
 
  private:
-  isl::ctx ctx_{isl_ctx_alloc()};
   std::string target_;
   std::vector<Stmt> outer_let_stmts_;
   std::unordered_set<isl::id, isl::IslIdIslHash> realize_from_input_;
@@ -533,10 +577,17 @@ class UserConfig {
 
   bool enable_tile_c0_{false};
   bool enable_atomic_add_{false};
+  // combine multi-block partial reductions in a fixed order instead of with global atomics
+  bool enable_deterministic_reduce_{false};
+  // reduce short rows in warp segments and let the resident blocks loop over many rows, off until the generated
+  // kernels are covered by tests
+  bool enable_row_reduce_strategy_{false};
   // tensor_core config
   bool enable_matmul_{false};
   bool enable_tensor_core_{false};
   bool enable_tensor_core_use_poly_{false};
+  // apply the elementwise consumers of the matmul on the accumulator fragments before they are stored
+  bool enable_mma_epilogue_fusion_{true};
   // lib config
   bool enable_akg_reduce_lib_{true};
   // memory config
@@ -545,6 +596,16 @@ class UserConfig {
   // shared memory position in schedule tree
   int register_depth_{-1};
   int shared_depth_{-1};
+  // check the register promotion against a per thread cap with the emitter temporaries, and leave the largest
+  // tensors out when it spills; off until the cap and the promotion decision are covered by tests
+  bool enable_register_cap_{false};
+  // occupancy goal that bounds the registers of each thread, used by enable_register_cap
+  int min_blocks_per_sm_{1};
+  // blocks sharing the reduction axis of a matmul: 0 decides from the shape, 1 disables the split
+  int split_k_{0};
+  // streaming multiprocessors of the target gpu, a per target attr filled from the device by the gpu builder; the
+  // default is a V100. It sizes the split k of matmuls and the resident blocks of reductions and coarsened threads.
+  int sm_count_{80};
   // shared memory tensor list
   std::string shared_tensors_;
   // reduce lib type, for now, there are two selection
@@ -556,6 +617,17 @@ class UserConfig {
   // vectorization
   int vector_load_type_{0};
   bool enable_one_dim_thread_{false};
+  // pick the band member mapped to threadIdx.x by the global memory transactions of the accesses, off until the
+  // thread config is derived again for the reordered members
+  bool enable_coalesced_thread_order_{false};
+  // emit the syncs whose dependences stay inside a warp as __syncwarp, and remove the syncs of the emitted kernel that
+  // separate no conflicting accesses
+  bool enable_sync_elimination_{false};
+  // let the tiling strategy give each thread of an injective kernel several elements, chosen from the tensor size
+  // instead of the fixed elem_per_thread, off until the chosen factors are tested end to end
+  bool enable_thread_coarsening_{false};
+  // elements of each thread decided by the tiling strategy, the thread loop is unrolled by it
+  int thread_coarsen_factor_{1};
 
   // tiling config
   std::string b_dim_;
@@ -568,6 +640,9 @@ class UserConfig {
   std::vector<NodeRef> custom_tiling_;
   bool pragma_analyze_reuse_buffer_{true};
   bool pragma_speedup_tiling_{false};
+  // pick the npu tile factor with the lowest estimated MTE and vector time among the ones that fit, off until the
+  // solver side of the rerank is covered by tests
+  bool enable_tiling_cost_model_{false};
   bool pragma_allow_tail_tiling_{true};
   bool pragma_analyze_multicore_{true};
   bool prune_tuning_space_{true};
@@ -614,6 +689,8 @@ class UserConfig {
   // dump config
   int dump_tuning_level_{0};
   bool dump_pass_ir_{false};
+  // dump binary schedule snapshots instead of pretty printed schedule trees and scop data
+  bool dump_schedule_snapshot_{false};
   std::string dump_poly_dir_;
 
   Schedule origin_sch_;
@@ -640,6 +717,14 @@ struct AtomicInfo {
   std::string tensor_type;
 };
 
+// orders[i][d] is the band member mapped to the d-th thread dim (x, y, z) by the i-th candidate,
+// transactions[i] its estimated global memory sectors per block.
+struct ThreadOrderDecision {
+  std::vector<std::vector<int>> orders;
+  std::vector<int64_t> transactions;
+  size_t best{0};
+};
+
 struct StatementUnionMappingInfo {
   std::vector<isl::id> stmt_vec;
   bool inject_mapping;
@@ -695,6 +780,7 @@ class AnalysisResult {
   void RecordUpdateTensor(const Tensor &tensor) { update_tensors_.push_back(tensor); }
   void RecordAttrStmt(const AttrStmt *attr_stmt) { attr_stmts_.push_back(attr_stmt); }
   void RecordAtomicTensors(const AtomicInfo &atomic_info) { atomic_tensors_.push_back(atomic_info); }
+  void RecordThreadOrderDecision(const ThreadOrderDecision &decision) { thread_order_decisions_.push_back(decision); }
   void RecordReduceOutTensors(const std::string &tensor_name) { reduce_out_tensors_.insert(tensor_name); }
   void RecordContextParams(const isl::set &context_params) { context_params_ = context_params; }
   void RecoreMatrixMatmulMap(const std::string matrix_name, const std::string matrix_position) {
@@ -705,6 +791,10 @@ class AnalysisResult {
     shared_tensor_bits_map_.emplace(tensor_name, tensor_bits);
   }
   std::unordered_map<std::string, int> GetSharedTensorBitsMap() const { return shared_tensor_bits_map_; }
+  void RecordSharedSwizzle(const std::string &tensor_name, const int key_dim, const int swizzle_words) {
+    shared_swizzle_map_[tensor_name] = std::make_pair(key_dim, swizzle_words);
+  }
+  std::unordered_map<std::string, std::pair<int, int>> GetSharedSwizzleMap() const { return shared_swizzle_map_; }
   void RecoreMatrixMatmulMajor(const std::string matrix_name, const std::string matrix_major) {
     matrix_matmul_major_.emplace(matrix_name, matrix_major);
   }
@@ -713,6 +803,7 @@ class AnalysisResult {
   std::unordered_set<std::string> GetCastTensors() const { return cast_tensors_; }
   isl::set GetContextParams() { return context_params_; }
   std::vector<AtomicInfo> GetAtomicTensors() { return atomic_tensors_; }
+  std::vector<ThreadOrderDecision> GetThreadOrderDecisions() const { return thread_order_decisions_; }
   std::unordered_set<std::string> GetReduceOutTensors() { return reduce_out_tensors_; }
   isl::union_map GetReads() const { return reads_; }
   std::unordered_set<std::string> GetReduceAttrs() const { return reduce_attrs_; }
@@ -855,11 +946,14 @@ class AnalysisResult {
   isl::set context_params_;
 
   std::vector<AtomicInfo> atomic_tensors_;
+  std::vector<ThreadOrderDecision> thread_order_decisions_;
   std::unordered_set<std::string> reduce_out_tensors_;
   std::unordered_set<std::string> cast_tensors_;
   bool enabled_auto_tiling_{false};
   std::unordered_map<std::string, std::string> matrix_matmul_map_;
   std::unordered_map<std::string, int> shared_tensor_bits_map_;
+  // shared tensor -> (dimension whose index is the xor key, granularity in 32-bit words) of the swizzled layout
+  std::unordered_map<std::string, std::pair<int, int>> shared_swizzle_map_;
   TensorScheduleRepo tensor_schedule_repo_;
   std::unordered_map<std::string, std::string> matrix_matmul_major_;
 };
@@ -1025,6 +1119,7 @@ class ScopInfo {
   static bool IsGMWrite(const isl::id &id) { return id.get_name() == std::string("GMwrite"); }
   static bool IsGMRead(const isl::id &id) { return id.get_name() == std::string("GMread"); }
   static bool IsSync(const isl::id &id) { return IsStartsWith(id.name(), SYNC_FLAG); }
+  static bool IsWarpSync(const isl::id &id) { return IsStartsWith(id.name(), WARP_SYNC_FLAG); }
   static bool IsRealize(const isl::id &id) { return IsStartsWith(id.get_name(), "REALIZE"); }
   static bool IsReduceInit(const isl::id &id) { return IsStartsWith(id.get_name(), "red_init"); }
   static bool IsReduceUpdate(const isl::id &id) { return IsStartsWith(id.get_name(), "red_update"); }
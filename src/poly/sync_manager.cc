@@ -24,9 +24,8 @@ namespace poly {
 
 isl::id SyncManager::MakeUniqueId(SyncLevel level) {
   if (level == SyncLevel::WARP) {
-    // For now, tvm codegen does not support warp sync.
-    // So, used shared sync instead of warp sync.
-    return GetSyncId();
+    // dependences that stay inside a warp only need __syncwarp, which is emitted as an extern call.
+    return GetWarpSyncId();
   } else {
     return GetSyncId();
   }
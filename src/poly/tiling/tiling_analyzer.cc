@@ -369,22 +369,62 @@ std::pair<int64_t, int64_t> TileCandidate::MemInfer(TilingMemScope scope, int ba
   return std::make_pair(mem_infer_[scope], align_mem_infer_[scope]);
 }
 
+/*
+ * Returns the aligned footprint of the scope after auto double buffer. When the band is cut into more than one tile,
+ * each buffer fetched from global memory gets a second copy, so that the next tile is moved in while the current one
+ * is computed.
+ */
+int64_t TileCandidate::DoubleBufferMemInfer(TilingMemScope scope, int band_idx) {
+  int64_t footprint = MemInfer(scope, band_idx).second;
+  bool multi_tile = false;
+  for (auto a : tile_axis_) {
+    int64_t extent = a->GetConstExtent();
+    int64_t tile = GetConstTileVal(a).first;
+    if (a->index == band_idx && extent > 0 && tile > 0 && tile < extent) {
+      multi_tile = true;
+      break;
+    }
+  }
+  if (!multi_tile) {
+    return footprint;
+  }
+  std::unordered_set<const BufferEntry *> fetched;
+  for (const auto &e : analyzer_->linear_seq_) {
+    if (e.def == nullptr || e.def->scope != scope || fetched.count(e.def) != 0) {
+      continue;
+    }
+    bool from_gm = std::any_of(e.ref.begin(), e.ref.end(),
+                               [](const BufferEntry *ref) { return ref->scope == MEM_SCOPE_GM; });
+    auto cached = buf_size_cache_.find(e.def);
+    if (!from_gm || cached == buf_size_cache_.end() || cached->second.band != band_idx ||
+        !cached->second.this_band_buf) {
+      continue;
+    }
+    fetched.insert(e.def);
+    footprint += cached->second.act_buf_size;
+  }
+  return footprint;
+}
+
 void TileCandidate::UpdateConstTile(const TileAxis *a, const int64_t l1_val, const int64_t l0_val) {
   TileVal &val = this->tile_val_[a];
   val.tile_c1 = l1_val;
   val.tile_c0 = l0_val == -1 ? l1_val : l0_val;
+  InvalidateBufSize(a);
   is_update_ = false;
 }
 
 void TileCandidate::UpdateC1Tile(const TileAxis *a, const Expr &l1_val) {
   TileVal &val = this->tile_val_[a];
   val.tile_c1 = l1_val;
+  InvalidateBufSize(a);
   is_update_ = false;
 }
 
 void TileCandidate::UpdateC0Tile(const TileAxis *a, const Expr &l0_val) {
   TileVal &val = this->tile_val_[a];
   val.tile_c0 = l0_val;
+  InvalidateBufSize(a);
   is_update_ = false;
 }
 
@@ -392,9 +432,33 @@ void TileCandidate::UpdateTile(const TileAxis *a, const Expr &l1_val, const Expr
   TileVal &val = this->tile_val_[a];
   val.tile_c1 = l1_val;
   if (l0_val.defined()) val.tile_c0 = l0_val;
+  InvalidateBufSize(a);
   is_update_ = false;
 }
 
+void TileCandidate::InvalidateBufSize(const TileAxis *a) {
+  if (buf_size_cache_.empty()) {
+    return;
+  }
+  if (axis_buf_map_.empty()) {
+    for (const auto &it : analyzer_->buffer_usage_timetable_) {
+      if (it.first->tile_axis == nullptr) {
+        continue;
+      }
+      for (const auto axis : *(it.first->tile_axis)) {
+        axis_buf_map_[axis].emplace_back(it.first);
+      }
+    }
+  }
+  auto it = axis_buf_map_.find(a);
+  if (it == axis_buf_map_.end()) {
+    return;
+  }
+  for (const auto buf : it->second) {
+    buf_size_cache_.erase(buf);
+  }
+}
+
 std::pair<Expr, Expr> TileCandidate::GetTileVal(const TileAxis *a) {
   if (this->tile_val_.find(a) != this->tile_val_.end()) {
     TileVal &val = this->tile_val_[a];
@@ -491,21 +555,27 @@ void TileCandidate::UpdateMemoryAfterBuffer(const BufferEntry *buf, MemInferInfo
     }
     return false;
   };
-  bool is_elem = FindPartialMatch(buf->name, elem_align_buf_);
-  bool is_bcast = FindPartialMatch(buf->name, broadcast_align_buf_);
-  int64_t f_mul = 1;
-  std::unique_ptr<BufSizeInfo> buf_size_info(new (std::nothrow)
-                                               BufSizeInfo{buf_size, act_buf_size, f_mul, is_elem, is_bcast});
-  CHECK(buf_size_info) << "memory alloc fail";
-  if (scope != MEM_SCOPE_GM) {
-    this_band_buf = GetActualBufSize(buf, buf_size_info.get());
-  }
-  GetElemwiseActualBufSize(buf, buf_size_info.get());
-
-  if (this_band_buf) {
-    mem_infer_info->live_buf[buf] = buf_size_info->buf_size;
-    mem_infer_info->live_size[scope] += buf_size_info->buf_size;
-    mem_infer_info->actual_live_size[scope] += buf_size_info->act_buf_size;
+  auto cached = buf_size_cache_.find(buf);
+  if (cached == buf_size_cache_.end() || cached->second.band != tiling_band_) {
+    bool is_elem = FindPartialMatch(buf->name, elem_align_buf_);
+    bool is_bcast = FindPartialMatch(buf->name, broadcast_align_buf_);
+    int64_t f_mul = 1;
+    std::unique_ptr<BufSizeInfo> buf_size_info(new (std::nothrow)
+                                                 BufSizeInfo{buf_size, act_buf_size, f_mul, is_elem, is_bcast});
+    CHECK(buf_size_info) << "memory alloc fail";
+    if (scope != MEM_SCOPE_GM) {
+      this_band_buf = GetActualBufSize(buf, buf_size_info.get());
+    }
+    GetElemwiseActualBufSize(buf, buf_size_info.get());
+    buf_size_cache_[buf] = CachedBufSize{tiling_band_, this_band_buf, buf_size_info->buf_size,
+                                         buf_size_info->act_buf_size};
+    cached = buf_size_cache_.find(buf);
+  }
+
+  if (cached->second.this_band_buf) {
+    mem_infer_info->live_buf[buf] = cached->second.buf_size;
+    mem_infer_info->live_size[scope] += cached->second.buf_size;
+    mem_infer_info->actual_live_size[scope] += cached->second.act_buf_size;
   }
   if (mem_infer_info->live_size[scope] > mem_infer_info->max_live_size[scope]) {
     mem_infer_info->max_live_size[scope] = mem_infer_info->live_size[scope];
@@ -614,19 +684,39 @@ void TileCandidate::DoMemInfer() {
   std::unique_ptr<MemInferInfo> mem_infer_info(new (std::nothrow) MemInferInfo());
   CHECK(mem_infer_info) << "memory alloc fail";
 
-  for (auto cur_time = 0; cur_time <= static_cast<int>(analyzer_->buffer_usage_timetable_.size() - 1); ++cur_time) {
+  // The live ranges do not change with the tiles, so they are sorted once and swept in O(T + B) instead of
+  // visiting every buffer at every time.
+  if (alloc_seq_.empty() && !analyzer_->buffer_usage_timetable_.empty()) {
     for (auto it : analyzer_->buffer_usage_timetable_) {
       auto alloc_time = it.second.first;
       auto last_use_time = it.second.second;
-      if (last_use_time < cur_time) {
-        mem_infer_info->live_size[it.first->scope] -= mem_infer_info->live_buf[it.first];
-        mem_infer_info->live_buf.erase(it.first);
+      alloc_seq_.emplace_back(alloc_time, it.first);
+      free_seq_.emplace_back(std::max(alloc_time, last_use_time), it.first);
+    }
+    auto TimeLess = [](const std::pair<int, const BufferEntry *> &a, const std::pair<int, const BufferEntry *> &b) {
+      return a.first < b.first;
+    };
+    std::stable_sort(alloc_seq_.begin(), alloc_seq_.end(), TimeLess);
+    std::stable_sort(free_seq_.begin(), free_seq_.end(), TimeLess);
+  }
+
+  size_t next_alloc = 0;
+  size_t next_free = 0;
+  auto end_time = static_cast<int>(analyzer_->buffer_usage_timetable_.size());
+  for (auto cur_time = 0; cur_time < end_time; ++cur_time) {
+    // Buffers are released before the ones allocated at the same time take up memory.
+    for (; next_free < free_seq_.size() && free_seq_[next_free].first < cur_time; ++next_free) {
+      auto buf = free_seq_[next_free].second;
+      auto live = mem_infer_info->live_buf.find(buf);
+      if (live != mem_infer_info->live_buf.end()) {
+        mem_infer_info->live_size[buf->scope] -= live->second;
+        mem_infer_info->live_buf.erase(live);
       }
-      // Do not update memory for buffer that already exist or not used currently.
-      if (mem_infer_info->live_buf.count(it.first) != 0 || alloc_time != cur_time) {
-        continue;
+    }
+    for (; next_alloc < alloc_seq_.size() && alloc_seq_[next_alloc].first <= cur_time; ++next_alloc) {
+      if (alloc_seq_[next_alloc].first == cur_time) {
+        UpdateMemoryAfterBuffer(alloc_seq_[next_alloc].second, mem_infer_info.get());
       }
-      UpdateMemoryAfterBuffer(it.first, mem_infer_info.get());
     }
   }
 
@@ -357,6 +357,13 @@ class TileCandidate {
     bool is_elem;
     bool is_bcast;
   };
+  // buffer size under current tile values, kept until a tile of the buffer's axes changes
+  struct CachedBufSize {
+    int band;
+    bool this_band_buf;
+    int64_t buf_size;
+    int64_t act_buf_size;
+  };
   std::unique_ptr<DynamicMemInfo> dynamic_mem_info_{nullptr};
   std::unordered_map<const TileAxis *, TileVal> tile_val_;
 
@@ -366,8 +373,14 @@ class TileCandidate {
   void UpdateFixTileAxis(TileLevel level);
 
   std::vector<TileAxis *> GetTileAxis() { return this->tile_axis_; }
-  void ResetTileAxis() { this->tile_axis_.clear(); }
-  void ResetTileVal() { this->tile_val_.clear(); }
+  void ResetTileAxis() {
+    this->tile_axis_.clear();
+    this->buf_size_cache_.clear();
+  }
+  void ResetTileVal() {
+    this->tile_val_.clear();
+    this->buf_size_cache_.clear();
+  }
   void UpdateConstTile(const TileAxis *a, int64_t c1_val, const int64_t c0_val = -1);
   void UpdateC1Tile(const TileAxis *a, const Expr &c1_val);
   void UpdateC0Tile(const TileAxis *a, const Expr &c0_val);
@@ -377,10 +390,12 @@ class TileCandidate {
 
   bool SpaceVerify(const TileAxis *axis, TileLevel level, int band);
   std::pair<int64_t, int64_t> MemInfer(TilingMemScope type, int band);
+  int64_t DoubleBufferMemInfer(TilingMemScope type, int band);
 
   void InsertAxisBack(TileAxis *a) {
     this->tile_axis_.emplace_back(a);
     this->tile_val_.emplace(a, TileVal{a->c1_constraints.tile_extent_, a->c0_constraints.tile_extent_});
+    InvalidateBufSize(a);
     is_update_ = false;
   }
   int TileAxisSize() const { return static_cast<int>(this->tile_axis_.size()); }
@@ -405,6 +420,7 @@ class TileCandidate {
 
  private:
   void DoMemInfer();
+  void InvalidateBufSize(const TileAxis *a);
 
   std::vector<TileAxis *> tile_axis_;
   TilingAnalyzer *analyzer_;
@@ -414,6 +430,11 @@ class TileCandidate {
   std::unordered_set<std::string> broadcast_align_buf_;
   int64_t mem_infer_[MEM_SCOPE_BULK]{0};
   int64_t align_mem_infer_[MEM_SCOPE_BULK]{0};
+  std::unordered_map<const BufferEntry *, CachedBufSize> buf_size_cache_;
+  std::unordered_map<const TileAxis *, std::vector<const BufferEntry *>> axis_buf_map_;
+  // buffers ordered by the time they are allocated and released
+  std::vector<std::pair<int, const BufferEntry *>> alloc_seq_;
+  std::vector<std::pair<int, const BufferEntry *>> free_seq_;
 };
 }  // namespace poly
 }  // namespace ir
@@ -0,0 +1,74 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "poly/tiling/tiling_cost_model.h"
+
+#include <algorithm>
+
+namespace akg {
+namespace ir {
+namespace poly {
+namespace {
+constexpr int64_t MTE_BLOCK_BYTES = 32;
+constexpr double MTE_BYTES_PER_CYCLE = 32.0;
+constexpr double MTE_BURST_LATENCY = 24.0;
+constexpr double MTE1_BYTES_PER_CYCLE = 128.0;
+constexpr int64_t VECTOR_REPEAT_BYTES = 256;
+constexpr int64_t VECTOR_MAX_REPEAT = 255;
+constexpr double VECTOR_ISSUE_CYCLES = 16.0;
+constexpr double CUBE_MACS_PER_CYCLE = 16.0 * 16.0 * 16.0;
+// loop control, flag setting and waiting of the pipes between two tiles
+constexpr double TILE_OVERHEAD_CYCLES = 64.0;
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+}  // namespace
+
+double NpuCostModel::MteCycles(int64_t bytes, int64_t burst_bytes) const {
+  if (bytes <= 0) {
+    return 0;
+  }
+  burst_bytes = std::min(std::max<int64_t>(burst_bytes, 1), bytes);
+  auto bursts = CeilDiv(bytes, burst_bytes);
+  auto burst_blocks = CeilDiv(burst_bytes, MTE_BLOCK_BYTES);
+  return bursts * (MTE_BURST_LATENCY + burst_blocks * MTE_BLOCK_BYTES / MTE_BYTES_PER_CYCLE);
+}
+
+double NpuCostModel::VectorCycles(int64_t bytes, int64_t row_bytes) const {
+  if (bytes <= 0) {
+    return 0;
+  }
+  row_bytes = std::min(std::max<int64_t>(row_bytes, 1), bytes);
+  auto rows = CeilDiv(bytes, row_bytes);
+  auto repeats = CeilDiv(row_bytes, VECTOR_REPEAT_BYTES);
+  auto instructions = CeilDiv(repeats, VECTOR_MAX_REPEAT);
+  return rows * (instructions * VECTOR_ISSUE_CYCLES + repeats);
+}
+
+double NpuCostModel::CubeCycles(int64_t macs) const { return macs <= 0 ? 0 : macs / CUBE_MACS_PER_CYCLE; }
+
+double NpuCostModel::Estimate(const NpuTileFeature &feature) const {
+  double mte = MteCycles(feature.mte_in_bytes, feature.burst_bytes) +
+               MteCycles(feature.mte_out_bytes, feature.burst_bytes) + feature.mte_l1_bytes / MTE1_BYTES_PER_CYCLE;
+  double compute = VectorCycles(feature.vector_bytes, feature.vector_row_bytes) + CubeCycles(feature.cube_macs);
+  auto tiles_per_core = CeilDiv(std::max<int64_t>(feature.tile_count, 1), std::max<int64_t>(feature.core_num, 1));
+  if (feature.double_buffer && tiles_per_core > 1) {
+    // only the moves of the first tile and the computation of the last one are not hidden
+    return tiles_per_core * (std::max(mte, compute) + TILE_OVERHEAD_CYCLES) + std::min(mte, compute);
+  }
+  return tiles_per_core * (mte + compute + TILE_OVERHEAD_CYCLES);
+}
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
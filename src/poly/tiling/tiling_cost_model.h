@@ -0,0 +1,61 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POLY_TILING_COST_MODEL_H_
+#define POLY_TILING_COST_MODEL_H_
+
+#include <cstdint>
+
+namespace akg {
+namespace ir {
+namespace poly {
+/*
+ * Work of one tile of a npu tiling candidate. Bytes and operations are counted for a single tile, the tiles are
+ * distributed over the cores.
+ */
+struct NpuTileFeature {
+  int64_t tile_count;
+  int64_t core_num;
+  // global memory to UB/L1 (MTE2) and UB/L0C to global memory (MTE3)
+  int64_t mte_in_bytes;
+  int64_t mte_out_bytes;
+  // shortest contiguous run of the global memory moves
+  int64_t burst_bytes;
+  // L1 to L0A/L0B (MTE1)
+  int64_t mte_l1_bytes;
+  // bytes read by the vector instructions, each instruction handles a contiguous row
+  int64_t vector_bytes;
+  int64_t vector_row_bytes;
+  int64_t cube_macs;
+  // the local buffers fit twice, so that the moves of a tile overlap the computation of the previous one
+  bool double_buffer;
+};
+
+/*
+ * Analytic cycle estimate of a tiling candidate on the npu: the MTE time of the global memory moves, paid per
+ * burst and rounded to 32 byte blocks, plus the vector time, paid per instruction and per 256 byte repeat, plus
+ * the cube time. The numbers only rank the candidates of one kernel, they are not a latency prediction.
+ */
+class NpuCostModel {
+ public:
+  double Estimate(const NpuTileFeature &feature) const;
+  double MteCycles(int64_t bytes, int64_t burst_bytes) const;
+  double VectorCycles(int64_t bytes, int64_t row_bytes) const;
+  double CubeCycles(int64_t macs) const;
+};
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
+#endif  // POLY_TILING_COST_MODEL_H_
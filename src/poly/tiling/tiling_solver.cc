@@ -77,10 +77,12 @@ void TilingSolver::CollectMemoryLimit() {
   if (analyzer_.scop_info_.user_config_.GetTarget() == TARGET_CCE) {
     // Init memory allocation percentage.
     percentage_ = ALLOCATION_PERCENTAGE;
+    exact_double_buffer_ = true;
     for (auto attr : analyzer_.RootAxis()->attrs) {
       if (attr.attr_key != AT_MEM_RATIO) continue;
       CHECK_NE(attr.attr_value, "");
       percentage_ = std::strtod(attr.attr_value.c_str(), nullptr);
+      exact_double_buffer_ = false;
       break;
     }
 
@@ -90,6 +92,7 @@ void TilingSolver::CollectMemoryLimit() {
       std::stringstream ss;
       ss << "Get Error Info! -> " << global_attrs.GetStringAttr(kErrorInfo, "");
       percentage_ = percentage_ * GetNewAllocRatioWhenFlattenFail(error_info);
+      exact_double_buffer_ = false;
       ss << "Adjust memory allocation to " << percentage_ << " of memory size and retry tiling.";
       global_attrs.Set(kErrorInfo, StringImm::make(""));
       analyzer_.logger_.AppendLog(MICRO_TUNING, ss);
@@ -99,8 +102,10 @@ void TilingSolver::CollectMemoryLimit() {
     NpuInfo &d_info = NpuInfo::GetInstance();
     auto error_scope = global_attrs.GetStringAttr(kErrorScope, "");
     for (auto i = 0; i < MEM_SCOPE_BULK; ++i) {
+      this->phy_mem_limit_[i] = d_info.GetMemoryLimitInScope(i);
       this->mem_limit_[i] = d_info.GetMemoryLimitInScope(i) * percentage_;
       if (i == TilingMemScope::MEM_SCOPE_BUFFER && error_scope == DOT_LOCAL_BUF) {
+        exact_double_buffer_ = false;
         this->mem_limit_[i] =
           std::max(static_cast<int>(this->mem_limit_[i] * GetNewAllocRatioWhenRewriteFail(this->mem_limit_[i])), 1);
         global_attrs.Set(kErrorScope, StringImm::make(""));
@@ -109,11 +114,48 @@ void TilingSolver::CollectMemoryLimit() {
   } else {
     GpuInfo &gpu_info = GpuInfo::GetInstance();
     for (auto i = 0; i < MEM_SCOPE_BULK; ++i) {
+      this->phy_mem_limit_[i] = gpu_info.GetMemoryLimitInScope(i);
       this->mem_limit_[i] = gpu_info.GetMemoryLimitInScope(i);
     }
   }
 }
 
+/*
+ * Without a memory ratio from attrs or from a previous failure, the local buffer and cache1 are not limited by the
+ * percentage reserved for double buffer. Instead, the footprint with a second copy of every buffer fetched from
+ * global memory is checked against the whole memory.
+ */
+bool TilingSolver::IsExactDoubleBuffer(TilingMemScope scope) const {
+  return exact_double_buffer_ && (scope == MEM_SCOPE_BUFFER || scope == MEM_SCOPE_CACHE1) &&
+         phy_mem_limit_[scope] > 0;
+}
+
+/*
+ * This function checks the footprint of current tile candidate after promotion and storage rewrite, i.e. the
+ * maximal live size of aligned buffers, against the whole on-chip memory. A candidate that fails here will fail in
+ * storage flatten or storage rewrite even if double buffer is disabled, so it is rejected before lowering instead of
+ * recovering from the error by recompiling.
+ */
+bool TilingSolver::VerifyPhysicalMemory(TileLevel level, int band) {
+  if (analyzer_.scop_info_.user_config_.GetTarget() != TARGET_CCE) {
+    return true;
+  }
+  // C0 tiles are not decided yet when tiling C1, so C0 scopes are only verified at C0 level.
+  auto begin = level == CACHE1 ? MEM_SCOPE_BUFFER : MEM_SCOPE_CACHE0_A;
+  auto end = level == CACHE1 ? MEM_SCOPE_CACHE1 : MEM_SCOPE_CACHE0_C;
+  for (auto i = static_cast<int>(begin); i <= static_cast<int>(end); ++i) {
+    auto scope = static_cast<TilingMemScope>(i);
+    int64_t aligned_size = cand_.MemInfer(scope, band).second;
+    if (phy_mem_limit_[i] > 0 && aligned_size > phy_mem_limit_[i]) {
+      std::stringstream ss;
+      ss << "Footprint " << aligned_size << " of scope " << i << " exceeds memory size " << phy_mem_limit_[i];
+      analyzer_.logger_.AppendLog(DO_TILING, ss);
+      return false;
+    }
+  }
+  return true;
+}
+
 void TilingSolver::CollectTileAxisTopDown() {
   auto CollectTileAxis = [this](TileAxis *a) {
     if (a == analyzer_.RootAxis() || a->index != this->tiling_band_) {
@@ -934,7 +976,7 @@ bool TraverseSolver::IsTilable(TileInfo *info) {
   ss << "Begin ::: mem ok = " << mem_ok << " dev " << deviation;
   analyzer_.logger_.AppendLog(DO_TILING, ss);
   info->deviation = deviation;
-  if (!mem_ok && !cons.cand_factor.empty() && !is_retry_) {
+  if (!mem_ok && !cons.cand_factor.empty() && !is_retry_ && VerifyPhysicalMemory(info->level, info->band)) {
     // Force to start tiling when candiadates are not selected for the first time of compilation
     mem_ok = true;
   }
@@ -944,15 +986,22 @@ bool TraverseSolver::IsTilable(TileInfo *info) {
 bool TraverseSolver::MemoryVerify(TileLevel level, int band, int64_t *deviation) {
   std::vector<int64_t> original_size;
   std::vector<int64_t> expanded_size;
+  std::vector<int64_t> limit_size;
   int dev = 0;
   for (int i = 0; i < MEM_SCOPE_BULK; ++i) {
     auto scope = static_cast<TilingMemScope>(i);
     std::pair<int64_t, int64_t> mem_pair = cand_.MemInfer(scope, band);
     int64_t origin = mem_pair.first;
     int64_t expand = mem_pair.second;
+    int64_t limit = mem_limit_[scope];
+    if (IsExactDoubleBuffer(scope)) {
+      origin = cand_.DoubleBufferMemInfer(scope, band);
+      expand = origin;
+      limit = phy_mem_limit_[scope];
+    }
     int dev_a = EXCEED_MEM_CODE;
-    if (origin <= mem_limit_[scope]) {
-      dev_a = mem_limit_[scope] - origin;
+    if (origin <= limit) {
+      dev_a = limit - origin;
     }
     if (level == CACHE0 && i > MEM_SCOPE_BUFFER) {
       if (dev_a != EXCEED_MEM_CODE) dev += dev_a;
@@ -961,16 +1010,17 @@ bool TraverseSolver::MemoryVerify(TileLevel level, int band, int64_t *deviation)
     }
     original_size.emplace_back(origin);
     expanded_size.emplace_back(expand);
+    limit_size.emplace_back(limit);
   }
   if (deviation) {
     *deviation = dev;
   }
 
-  bool BUF_valid = (expanded_size[MEM_SCOPE_BUFFER] <= mem_limit_[MEM_SCOPE_BUFFER]);
-  bool C1_valid = (expanded_size[MEM_SCOPE_CACHE1] <= mem_limit_[MEM_SCOPE_CACHE1]);
-  bool C0_valid = (expanded_size[MEM_SCOPE_CACHE0_A] <= mem_limit_[MEM_SCOPE_CACHE0_A]) &&
-                  (expanded_size[MEM_SCOPE_CACHE0_B] <= mem_limit_[MEM_SCOPE_CACHE0_B]) &&
-                  (expanded_size[MEM_SCOPE_CACHE0_C] <= mem_limit_[MEM_SCOPE_CACHE0_C]);
+  bool BUF_valid = (expanded_size[MEM_SCOPE_BUFFER] <= limit_size[MEM_SCOPE_BUFFER]);
+  bool C1_valid = (expanded_size[MEM_SCOPE_CACHE1] <= limit_size[MEM_SCOPE_CACHE1]);
+  bool C0_valid = (expanded_size[MEM_SCOPE_CACHE0_A] <= limit_size[MEM_SCOPE_CACHE0_A]) &&
+                  (expanded_size[MEM_SCOPE_CACHE0_B] <= limit_size[MEM_SCOPE_CACHE0_B]) &&
+                  (expanded_size[MEM_SCOPE_CACHE0_C] <= limit_size[MEM_SCOPE_CACHE0_C]);
   bool cut_reduce = analyzer_.scop_info_.mmu_info_.IsConvBackpropFilter();
 
   std::vector<TileAxis *> batch_axes = analyzer_.GetAxesOfAttr(AttrInfo{AT_CONV, "N"});
@@ -986,7 +1036,7 @@ bool TraverseSolver::MemoryVerify(TileLevel level, int band, int64_t *deviation)
       ((cut_reduce || level == CACHE0) && !C0_valid)) {
     return false;
   }
-  return true;
+  return VerifyPhysicalMemory(level, band);
 }
 
 bool TraverseSolver::DoTiling(const TileInfo *info) {
@@ -1052,6 +1102,8 @@ bool TraverseSolver::DoTiling(const TileInfo *info) {
     }
     analyzer_.logger_.AppendLog(DO_TILING, ss);
   };
+  // The footprint is not monotonic in the tile factor: alignment may expand a smaller tile and a single tile needs no
+  // double buffer. Factors are scanned in ascending order up to the first one that exceeds memory.
   if (!is_retry_ && !cons.cand_factor.empty()) {
     for (int i = static_cast<int>(cons.cand_factor.size()) - 1; i >= 0; --i) {
       int64_t t = cons.cand_factor[i].as<IntImm>()->value;
@@ -1069,8 +1121,17 @@ bool TraverseSolver::DoTiling(const TileInfo *info) {
       UpdateChosenValue(tail, deviation, t);
     }
     if (best_val == -1 && best_no_iso_val == -1) {
-      best_val = cons.cand_factor.back().as<IntImm>()->value;
-      best_no_iso_val = cons.cand_factor.back().as<IntImm>()->value;
+      // Fall back to the largest candidate that still fits in memory without double buffer.
+      int64_t fallback = cons.cand_factor.back().as<IntImm>()->value;
+      for (const auto &cand : cons.cand_factor) {
+        UpdateTile(cand.as<IntImm>()->value);
+        if (VerifyPhysicalMemory(info->level, info->band)) {
+          fallback = cand.as<IntImm>()->value;
+          break;
+        }
+      }
+      best_val = fallback;
+      best_no_iso_val = fallback;
     }
   } else {
     for (int64_t t = init; t <= dst; ++t) {
@@ -1097,6 +1158,9 @@ bool TraverseSolver::DoTiling(const TileInfo *info) {
     }
   }
   int64_t final_factor = (axis->forbid_iso || best_no_iso_val * balance_factor > best_val) ? best_no_iso_val : best_val;
+  if (UseCostModel(info, final_factor)) {
+    final_factor = SelectFactorByCost(info, final_factor);
+  }
   final_factor = PostprocessFinalFactor(final_factor, axis);
   if (info->level == CACHE1) {
     cand_.UpdateConstTile(axis, final_factor);
@@ -1124,6 +1188,232 @@ int64_t TraverseSolver::PostprocessFinalFactor(int64_t final_factor, TileAxis *a
   return processed;
 }
 
+bool TraverseSolver::UseCostModel(const TileInfo *info, int64_t factor) {
+  auto &user_config = analyzer_.scop_info_.user_config_;
+  if (user_config.GetTarget() != TARGET_CCE || !user_config.GetEnableTilingCostModel() || user_config.GetIsDynamic()) {
+    return false;
+  }
+  return !is_retry_ && analyzer_.op_type_ != CONV_OP && factor > 0 && info->axis->GetConstExtent() > 0;
+}
+
+/*
+ * The factor found by the memory rule is the largest one that fits, which is not always the fastest: it may leave
+ * cores idle, cut the rows of the DMA below a block or lose the double buffer. The factors below it that fit are
+ * estimated by NpuCostModel with the tiles of the other axes unchanged, and a factor only replaces the one of the
+ * memory rule when it is clearly faster.
+ */
+int64_t TraverseSolver::SelectFactorByCost(const TileInfo *info, int64_t factor) {
+  TileAxis *axis = info->axis;
+  TileAxis::Constraint cons = axis->GetConstConstraint(info->level);
+  int64_t dst = info->level == CACHE1 ? cons.tile_extent_.as<IntImm>()->value : cand_.GetConstTileVal(axis).first;
+  int64_t mod = cons.tile_mod_.as<IntImm>()->value;
+  bool check_mod = axis->forbid_iso ? (dst % mod == 0) : (dst >= mod);
+  auto UpdateTile = [this, &info, &axis](int64_t tile_size) {
+    if (info->level == CACHE1) {
+      cand_.UpdateConstTile(axis, tile_size);
+    } else {
+      cand_.UpdateConstTile(axis, cand_.GetConstTileVal(axis).first, tile_size);
+    }
+  };
+
+  std::vector<int64_t> candidates;
+  auto AddCandidate = [this, &candidates, &axis, dst, mod, check_mod, factor](int64_t t) {
+    if (candidates.size() >= static_cast<size_t>(MAX_COST_CANDIDATES) || t <= 0 || t > factor ||
+        std::find(candidates.begin(), candidates.end(), t) != candidates.end()) {
+      return;
+    }
+    auto tail = dst % t;
+    if ((axis->forbid_iso && tail != 0) || (check_mod && t % mod != 0)) {
+      return;
+    }
+    if (tail != 0 && analyzer_.scop_info_.user_config_.GetPragmaAllowTailTiling() &&
+        tail < GetMaxAlignBytes(axis->data_size)) {
+      return;
+    }
+    candidates.emplace_back(t);
+  };
+  AddCandidate(factor);
+  if (!cons.cand_factor.empty()) {
+    for (const auto &cand : cons.cand_factor) {
+      AddCandidate(cand.as<IntImm>()->value);
+    }
+  } else {
+    int64_t init = std::max<int64_t>(info->min_tile, MIN_TILE);
+    // the divisors of dst come in pairs around its square root, the largest ones are tried first
+    std::vector<int64_t> divisors;
+    for (int64_t d = 1; d * d <= dst; ++d) {
+      if (dst % d != 0) continue;
+      divisors.emplace_back(d);
+      if (d * d != dst) divisors.emplace_back(dst / d);
+    }
+    std::sort(divisors.rbegin(), divisors.rend());
+    for (auto t : divisors) {
+      if (t >= init) AddCandidate(t);
+    }
+    for (int64_t t = factor / 2; t >= init; t /= 2) {
+      AddCandidate(t);
+    }
+  }
+
+  NpuCostModel cost_model;
+  int64_t best_factor = factor;
+  double best_cost = -1;
+  double factor_cost = -1;
+  std::stringstream ss;
+  for (auto t : candidates) {
+    UpdateTile(t);
+    if (!cand_.SpaceVerify(axis, info->level, info->band) || !MemoryVerify(info->level, info->band)) {
+      continue;
+    }
+    double cost = cost_model.Estimate(CollectTileFeature(info->level, info->band));
+    ss << "factor " << t << " estimated cost " << cost;
+    analyzer_.logger_.AppendLog(DO_TILING, ss);
+    if (t == factor) {
+      factor_cost = cost;
+    }
+    if (best_cost < 0 || cost < best_cost) {
+      best_cost = cost;
+      best_factor = t;
+    }
+  }
+  // the factor of the memory rule may be a fallback that only fits without double buffer, it is kept as is
+  if (factor_cost < 0 || best_cost > factor_cost * (1 - COST_MODEL_MIN_GAIN)) {
+    best_factor = factor;
+  }
+  UpdateTile(best_factor);
+  if (best_factor != factor) {
+    ss << "cost model replaces factor " << factor << " with " << best_factor;
+    analyzer_.logger_.AppendLog(DO_TILING, ss);
+  }
+  return best_factor;
+}
+
+/*
+ * Returns the bytes of the buffer within one tile of the band and its innermost contiguous bytes, which end at the
+ * first axis from the inside that is cut by the tile.
+ */
+std::pair<int64_t, int64_t> TraverseSolver::GetTileBytes(const TilingAnalyzer::BufferEntry *buf, int band) {
+  int64_t bytes = std::max<int64_t>(buf->size, 1);
+  int64_t run = bytes;
+  if (buf->tile_axis == nullptr) {
+    return std::make_pair(bytes, run);
+  }
+  bool is_l0 = buf->scope == MEM_SCOPE_CACHE0_A || buf->scope == MEM_SCOPE_CACHE0_B || buf->scope == MEM_SCOPE_CACHE0_C;
+  auto tile_axis = cand_.GetTileAxis();
+  bool contiguous = true;
+  for (auto it = buf->tile_axis->rbegin(); it != buf->tile_axis->rend(); ++it) {
+    TileAxis *a = *it;
+    if (a == analyzer_.RootAxis() || a->index != band) {
+      continue;
+    }
+    int64_t extent = a->GetConstExtent();
+    if (extent <= 0) {
+      continue;
+    }
+    int64_t tile = extent;
+    if (std::count(tile_axis.begin(), tile_axis.end(), a) != 0) {
+      auto tile_val = cand_.GetConstTileVal(a);
+      tile = is_l0 ? tile_val.second : tile_val.first;
+    }
+    if (tile <= 0 || tile > extent) {
+      tile = extent;
+    }
+    bytes *= tile;
+    if (contiguous) {
+      run *= tile;
+      contiguous = (tile == extent);
+    }
+  }
+  return std::make_pair(bytes, run);
+}
+
+NpuTileFeature TraverseSolver::CollectTileFeature(TileLevel level, int band) {
+  NpuTileFeature feature{1, TileCandidate::GetCoreNumConf(), 0, 0, 0, 0, 0, 0, 0, true};
+  int64_t l0_tiles = 1;
+  for (auto axis : cand_.GetTileAxis()) {
+    int64_t extent = axis->GetConstExtent();
+    if (axis->index != band || extent <= 0) {
+      continue;
+    }
+    auto tile_val = cand_.GetConstTileVal(axis);
+    int64_t c1 = tile_val.first;
+    int64_t c0 = tile_val.second;
+    c1 = (c1 <= 0 || c1 > extent) ? extent : c1;
+    c0 = (c0 <= 0 || c0 > c1) ? c1 : c0;
+    feature.tile_count *= (extent + c1 - 1) / c1;
+    l0_tiles *= (c1 + c0 - 1) / c0;
+  }
+
+  auto UpdateBurst = [&feature](int64_t run) {
+    feature.burst_bytes = feature.burst_bytes == 0 ? run : std::min(feature.burst_bytes, run);
+  };
+  for (const auto &e : analyzer_.linear_seq_) {
+    if (e.def == nullptr) {
+      continue;
+    }
+    auto def_bytes = GetTileBytes(e.def, band);
+    const TilingAnalyzer::BufferEntry *gm_ref = nullptr;
+    const TilingAnalyzer::BufferEntry *c1_ref = nullptr;
+    std::pair<int64_t, int64_t> ref_bytes(0, 0);
+    for (auto ref : e.ref) {
+      if (ref->scope == MEM_SCOPE_GM) gm_ref = ref;
+      if (ref->scope == MEM_SCOPE_CACHE1) c1_ref = ref;
+      auto bytes = GetTileBytes(ref, band);
+      if (bytes.first > ref_bytes.first) ref_bytes = bytes;
+    }
+    if (e.def->scope == MEM_SCOPE_GM) {
+      feature.mte_out_bytes += def_bytes.first;
+      UpdateBurst(def_bytes.second);
+    } else if (gm_ref != nullptr) {
+      feature.mte_in_bytes += def_bytes.first;
+      UpdateBurst(GetTileBytes(gm_ref, band).second);
+    } else if (e.def->scope == MEM_SCOPE_CACHE0_A || e.def->scope == MEM_SCOPE_CACHE0_B) {
+      feature.mte_l1_bytes += (c1_ref != nullptr ? def_bytes.first : 0) * l0_tiles;
+    } else if (e.def->scope == MEM_SCOPE_CACHE0_C) {
+      // the reduction axes of mmad are the axes of the operands that the result does not have
+      int64_t macs = def_bytes.first / std::max<int64_t>(e.def->size, 1);
+      std::unordered_set<TileAxis *> def_axis;
+      if (e.def->tile_axis != nullptr) def_axis.insert(e.def->tile_axis->begin(), e.def->tile_axis->end());
+      std::unordered_set<TileAxis *> reduce_axis;
+      for (auto ref : e.ref) {
+        if (ref->tile_axis == nullptr) continue;
+        for (auto a : *(ref->tile_axis)) {
+          if (a->index == band && a->GetConstExtent() > 0 && !def_axis.count(a)) reduce_axis.insert(a);
+        }
+      }
+      for (auto a : reduce_axis) {
+        auto tile = cand_.GetConstTileVal(a).second;
+        macs *= (tile <= 0 || tile > a->GetConstExtent()) ? a->GetConstExtent() : tile;
+      }
+      feature.cube_macs += macs * l0_tiles;
+    } else if (e.def->scope == MEM_SCOPE_BUFFER) {
+      auto bytes = def_bytes.first >= ref_bytes.first ? def_bytes : ref_bytes;
+      feature.vector_bytes += bytes.first;
+      feature.vector_row_bytes =
+        feature.vector_row_bytes == 0 ? bytes.second : std::min(feature.vector_row_bytes, bytes.second);
+    }
+  }
+
+  // double buffer is kept while the doubled footprint fits, or the footprint stays within the allocation percentage
+  for (auto scope : {MEM_SCOPE_BUFFER, MEM_SCOPE_CACHE1}) {
+    if (IsExactDoubleBuffer(scope)) {
+      if (cand_.DoubleBufferMemInfer(scope, band) > phy_mem_limit_[scope]) {
+        feature.double_buffer = false;
+      }
+    } else if (mem_limit_[scope] > 0 && cand_.MemInfer(scope, band).second > mem_limit_[scope]) {
+      feature.double_buffer = false;
+    }
+  }
+  if (level == CACHE0) {
+    for (auto scope : {MEM_SCOPE_CACHE0_A, MEM_SCOPE_CACHE0_B, MEM_SCOPE_CACHE0_C}) {
+      if (mem_limit_[scope] > 0 && cand_.MemInfer(scope, band).second > mem_limit_[scope]) {
+        feature.double_buffer = false;
+      }
+    }
+  }
+  return feature;
+}
+
 void TraverseSolver::AppendConvPragma() {
   Expr no = CastIntToExpr(1);
   Expr M = CastIntToExpr(1);
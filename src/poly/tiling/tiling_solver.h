@@ -18,11 +18,15 @@
 
 #include "poly/tiling/tiling_analyzer.h"
 #include "poly/tiling/tiling_algorithm.h"
+#include "poly/tiling/tiling_cost_model.h"
 #include "poly/tiling/tiling_strategy_manager.h"
 
 namespace akg {
 namespace ir {
 namespace poly {
+// the cost model only reranks a few of the factors that fit below the one of the memory rule
+constexpr auto MAX_COST_CANDIDATES = 16;
+constexpr auto COST_MODEL_MIN_GAIN = 0.05;
 
 class TilingSolver {
  public:
@@ -32,14 +36,18 @@ class TilingSolver {
   void CollectTileAxisTopDown();
   double GetNewAllocRatioWhenFlattenFail(const std::string &error_info);
   double GetNewAllocRatioWhenRewriteFail(int64_t memory_bits);
+  bool VerifyPhysicalMemory(TileLevel level, int band);
+  bool IsExactDoubleBuffer(TilingMemScope scope) const;
   TileCandidate *Solve();
   TilingAnalyzer &analyzer_;
   TileCandidate cand_;
   int64_t mem_limit_[MEM_SCOPE_BULK]{0};
+  int64_t phy_mem_limit_[MEM_SCOPE_BULK]{0};  // whole on-chip memory, the bound when double buffer is disabled
   int tiling_band_{0};
   double percentage_ = 0.5;
   double exceed_ratio_ = 1;  // allow memory allocation to exceed memory_size * percentage, may disable double buffer
   bool is_retry_ = false;
+  bool exact_double_buffer_ = false;  // check the doubled fetches against the whole memory instead of percentage_
 };
 
 class InequalitySolver : TilingSolver {
@@ -117,6 +125,10 @@ class TraverseSolver : TilingSolver {
   bool MemoryVerify(TileLevel level, int band, int64_t *deviation = nullptr);
   bool DoTiling(const TileInfo *info);
   int64_t PostprocessFinalFactor(int64_t final_factor, TileAxis *axis);
+  bool UseCostModel(const TileInfo *info, int64_t factor);
+  int64_t SelectFactorByCost(const TileInfo *info, int64_t factor);
+  NpuTileFeature CollectTileFeature(TileLevel level, int band);
+  std::pair<int64_t, int64_t> GetTileBytes(const TilingAnalyzer::BufferEntry *buf, int band);
   void AppendConvPragma();
   void AppendConvBackpropPragma();
   void RestrainConvBackInputTileK(TileAxis *k_axis) const;
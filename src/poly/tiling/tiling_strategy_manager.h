@@ -173,6 +173,10 @@ class ReduceStrategy : public TilingStrategy {
   // Used by setting scop_info.enable_akg_reduce_lib.
   void AkgReduceLibStrategyOnGpu();
 
+  // Select warp-per-row or persistent row reductions for reduce2D along x.
+  void PersistentRowStrategyOnGpu(int64_t total_reduce_size, int64_t total_injective_size, int64_t &reduce_threads,
+                                  int64_t &injective_threads);
+
   bool UseRegisterMem();
   bool IsHalfReduce();
 
@@ -182,10 +186,16 @@ class ReduceStrategy : public TilingStrategy {
   // For post reduce case, we should identify and disable atomic add for reduce axes.
   void DealWithPostReduceTensors();
 
+  // For deterministic reduce, only combine few outputs across blocks.
+  void DealWithDeterministicReduce();
+
   std::vector<TileAxis *> reduce_axes_;
   std::vector<TileAxis *> injective_axes_;
   bool all_reduce_{false};
   bool has_transpose_{false};
+  int64_t max_threads_per_sm_{2048};
+  int64_t long_row_size_{32768};
+  int64_t deterministic_output_limit_{4096};
 };
 
 class VectorizedStrategy : public TilingStrategy {
@@ -286,6 +296,18 @@ class GemmStrategy : public TilingStrategy {
   void AddGpuConstraint();
 
   std::string interested_attr_key = AT_GEMM;
+
+  // m and n tile of a block and k tile of one iteration on tensor core
+  static constexpr int64_t BLOCK_TILE = 64;
+  // a split below this number of k tiles does not amortize the atomic write of the partial results
+  static constexpr int64_t MIN_K_TILES_PER_SPLIT = 4;
+
+  // Blocks sharing the k axis of a [batch, m, k] x [batch, k, n] matmul on a gpu with sm_count streaming
+  // multiprocessors. A requested split_k above 1 is only rounded to a divisor of the k tiles.
+  static int64_t SplitKFactor(int64_t batch, int64_t m, int64_t n, int64_t k, int64_t sm_count, int64_t split_k);
+
+ private:
+  int64_t DetermineSplitK(const std::unordered_map<TileAxis *, std::vector<AttrInfo>> &interested_info);
 };
 
 class GpuStrategy : public TilingStrategy {
@@ -313,6 +335,9 @@ class GpuStrategy : public TilingStrategy {
 
   void InjectiveSpeedup();
 
+  // Elements looped over by each thread so that a few waves of full blocks cover the tensor of total_size.
+  int64_t ThreadCoarsenFactor(int64_t total_size);
+
   void BroadcastSpeedup();
   std::unordered_set<int> broadcast_idx_;
 
@@ -355,6 +380,9 @@ class GpuStrategy : public TilingStrategy {
   int block_count_{0};  // number of mapped blocks
   int64_t elem_per_thread_[3]{SpItemPerThread::AUTO};
   int64_t min_elem_for_io_bound_ = 2;
+  int64_t max_threads_per_sm_{2048};
+  int64_t coarsen_waves_{2};
+  int64_t max_coarsen_factor_{8};
   size_t depth_{0};
   bool need_reverse_{false};
   int64_t fused_size_{1};
@@ -30,14 +30,19 @@ void GpuDmaAnalysisStrategy::AddGpuConstraint() {
 
 void CastStrategy::AddGpuConstraint() { MarkDataSize(); }
 
+constexpr int64_t GemmStrategy::BLOCK_TILE;
+constexpr int64_t GemmStrategy::MIN_K_TILES_PER_SPLIT;
+
 void GemmStrategy::AddGpuConstraint() {
   if (!analyzer_->scop_info_.user_config_.GetEnableTensorCore()) {
     return;
   }
   auto interested_info = GetInterestedInfo(interested_attr_key);
+  int64_t split_k = DetermineSplitK(interested_info);
+  analyzer_->scop_info_.user_config_.SetSplitK(static_cast<int>(split_k));
   for (auto it : interested_info) {
     TileAxis *axis = it.first;
-    axis->TileRestrainToSingleValue(CastIntToExpr(64), TileLevel::CACHE1);
+    axis->TileRestrainToSingleValue(CastIntToExpr(BLOCK_TILE), TileLevel::CACHE1);
     axis->TileRestrainToSingleValue(CastIntToExpr(16), TileLevel::CACHE0);
     for (const auto &attr : it.second) {
       if (attr.attr_value == "mi") {
@@ -46,11 +51,76 @@ void GemmStrategy::AddGpuConstraint() {
       } else if (attr.attr_value == "ni") {
         axis->thread_constraints.map_min_ = 4;
         axis->thread_constraints.map_extent_ = 4;
+      } else if (attr.attr_value == "ki" && split_k > 1) {
+        // the k tiles are distributed over split_k blocks, which add their partial results to the output.
+        axis->block_constraints.map_min_ = split_k;
+        axis->block_constraints.map_extent_ = split_k;
       }
     }
   }
 }
 
+int64_t GemmStrategy::DetermineSplitK(const std::unordered_map<TileAxis *, std::vector<AttrInfo>> &interested_info) {
+  auto &user_config = analyzer_->scop_info_.user_config_;
+  if (user_config.GetSplitK() == 1) {
+    return 1;
+  }
+  // Partial results are combined with atomic add, so the output must be cleared by the caller and must not be
+  // followed by a fused epilogue that would be applied to every partial result.
+  if (!user_config.GetEnableAtomicAdd() || analyzer_->scop_info_.analysis_result_.GetStatementMap().size() > 2U) {
+    return 1;
+  }
+
+  int64_t m = 1;
+  int64_t n = 1;
+  int64_t k = 1;
+  int64_t batch = 1;
+  size_t k_axes = 0;
+  for (auto it : interested_info) {
+    auto extent = it.first->range_extent.as<IntImm>();
+    if (extent == nullptr) {
+      return 1;
+    }
+    for (const auto &attr : it.second) {
+      if (attr.attr_value == "mi" || attr.attr_value == "mo") {
+        m *= extent->value;
+      } else if (attr.attr_value == "ni" || attr.attr_value == "no") {
+        n *= extent->value;
+      } else if (attr.attr_value == "ki" || attr.attr_value == "ko") {
+        k *= extent->value;
+        ++k_axes;
+      } else if (attr.attr_value == "bi" || attr.attr_value == "bo") {
+        batch *= extent->value;
+      }
+    }
+  }
+  if (k_axes != 1) {
+    return 1;
+  }
+
+  int64_t split_k = SplitKFactor(batch, m, n, k, user_config.GetSmCount(), user_config.GetSplitK());
+
+  std::stringstream ss;
+  ss << "Gemm m = " << m << ", n = " << n << ", k = " << k << ", batch = " << batch << ", split k = " << split_k;
+  analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
+  return split_k;
+}
+
+int64_t GemmStrategy::SplitKFactor(int64_t batch, int64_t m, int64_t n, int64_t k, int64_t sm_count,
+                                   int64_t split_k) {
+  int64_t k_tiles = (k + BLOCK_TILE - 1) / BLOCK_TILE;
+  if (split_k <= 1) {
+    // Only split when the m and n tiles leave streaming multiprocessors idle and every split keeps enough k tiles.
+    int64_t blocks = batch * ((m + BLOCK_TILE - 1) / BLOCK_TILE) * ((n + BLOCK_TILE - 1) / BLOCK_TILE);
+    sm_count = std::max<int64_t>(1, sm_count);
+    if (blocks >= sm_count || k_tiles < 2 * MIN_K_TILES_PER_SPLIT) {
+      return 1;
+    }
+    split_k = std::min((sm_count + blocks - 1) / blocks, k_tiles / MIN_K_TILES_PER_SPLIT);
+  }
+  return TilingAnalyzer::FindDivisibleTilingFactor(std::min(split_k, k_tiles), k_tiles);
+}
+
 void ReduceStrategy::AddGpuConstraint() {
   reduce_axes_ = analyzer_->GetAxesOfAttr(AT_REDUCE_AXIS);
   size_t depth = 0;
@@ -100,9 +170,10 @@ void ReduceStrategy::SimpleStrategyOnGpu() {
 }
 
 void ReduceStrategy::AkgReduceLibStrategyOnGpu() {
-  // disable atomic-add for bitwise-reduction
-  bool disable_atomic = !analyzer_->scop_info_.user_config_.GetEnableAtomicAdd();
-  if (!disable_atomic) {
+  // disable atomic-add for bitwise-reduction, the deterministic return supports all reduce ops without atomics.
+  bool deterministic = analyzer_->scop_info_.user_config_.GetEnableDeterministicReduce();
+  bool disable_atomic = !analyzer_->scop_info_.user_config_.GetEnableAtomicAdd() && !deterministic;
+  if (!disable_atomic && !deterministic) {
     for (auto it : analyzer_->scop_info_.analysis_result_.GetReduceStatementMap()) {
       if (analyzer_->scop_info_.analysis_result_.GetReduceOpType(it.first) == AKG_REDUCE_AND ||
           analyzer_->scop_info_.analysis_result_.GetReduceOpType(it.first) == AKG_REDUCE_OR) {
@@ -120,6 +191,10 @@ void ReduceStrategy::AkgReduceLibStrategyOnGpu() {
   // disable atomic-add for post reduce tensors
   DealWithPostReduceTensors();
 
+  if (deterministic) {
+    DealWithDeterministicReduce();
+  }
+
   if (has_transpose_) {
     for (auto axis : reduce_axes_) {
       axis->TileRestrainEntire(TileLevel::CACHE1);
@@ -242,6 +317,16 @@ void ReduceStrategy::AkgReduceLibStrategyOnGpu() {
     }
   }
 
+  if (analyzer_->scop_info_.user_config_.GetEnableRowReduceStrategy() && !square_thread && !all_reduce_ &&
+      !has_transpose_) {
+    PersistentRowStrategyOnGpu(total_reduce_size, total_injective_size, reduce_threads, injective_threads);
+    bool reduce_in_block = std::all_of(reduce_axes_.begin(), reduce_axes_.end(),
+                                       [](TileAxis *axis) { return axis->block_constraints.map_extent_ == MIN_TILE; });
+    if (reduce_in_block) {
+      possible_reduce_blocks = 1;
+    }
+  }
+
   int possible_blocks =
     ceil(static_cast<float>(possible_injective_blocks * possible_reduce_blocks) / injective_threads / reduce_threads);
   int proposal = use_local ? 8 : 32;
@@ -290,6 +375,64 @@ void ReduceStrategy::AkgReduceLibStrategyOnGpu() {
   }
 }
 
+void ReduceStrategy::DealWithDeterministicReduce() {
+  // The deterministic return keeps the partial results of every output in a workspace,
+  // so only few outputs fed by many blocks are combined across blocks.
+  int64_t total_injective_size = 1;
+  for (auto axis : injective_axes_) {
+    CHECK(axis->range_extent.as<IntImm>());
+    total_injective_size *= axis->range_extent.as<IntImm>()->value;
+  }
+  if (total_injective_size <= deterministic_output_limit_) {
+    return;
+  }
+  for (auto axis : reduce_axes_) {
+    axis->block_constraints.map_extent_ = MIN_TILE;
+  }
+  std::stringstream ss;
+  ss << "Deterministic reduce with " << total_injective_size << " outputs, reduce every output in one block";
+  analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
+}
+
+void ReduceStrategy::PersistentRowStrategyOnGpu(int64_t total_reduce_size, int64_t total_injective_size,
+                                                int64_t &reduce_threads, int64_t &injective_threads) {
+  std::stringstream ss;
+  if (total_reduce_size <= warp_sizes_) {
+    // Short rows: one warp segment per row, reduced by shfl functions without shared memory.
+    reduce_threads = std::min(reduce_threads, total_reduce_size);
+    while (reduce_threads & (reduce_threads - 1)) {
+      --reduce_threads;
+    }
+    injective_threads = std::max(injective_threads, warp_sizes_ / reduce_threads);
+    ss << "Use warp-per-row reduction, reduce_threads " << reduce_threads;
+    analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
+  }
+
+  auto rows_per_block = std::max<int64_t>(injective_threads, 1);
+  auto row_blocks = (total_injective_size + rows_per_block - 1) / rows_per_block;
+  auto block_threads = std::max<int64_t>(reduce_threads * injective_threads, 1);
+  auto resident_blocks = std::max<int64_t>(analyzer_->scop_info_.user_config_.GetSmCount(), 1) *
+                         std::max<int64_t>(max_threads_per_sm_ / block_threads, 1);
+  if (row_blocks >= 2 * resident_blocks && injective_axes_.size() == 1U) {
+    // Many rows: keep every row in one block and let the resident blocks loop over the rows,
+    // so that neither atomic return nor block scheduling is paid for each row.
+    for (auto axis : reduce_axes_) {
+      axis->block_constraints.map_extent_ = MIN_TILE;
+    }
+    injective_axes_[0]->block_constraints.map_extent_ = resident_blocks;
+    ss << "Use persistent row reduction, " << resident_blocks << " blocks loop over " << row_blocks << " row tiles";
+    analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
+  } else if (total_reduce_size >= long_row_size_ && total_injective_size >= resident_blocks) {
+    // Long rows that already fill the device: one block loops over a whole row instead of atomically
+    // combining the partial results of several blocks.
+    for (auto axis : reduce_axes_) {
+      axis->block_constraints.map_extent_ = MIN_TILE;
+    }
+    ss << "Use block-per-row reduction for rows of " << total_reduce_size;
+    analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
+  }
+}
+
 bool ReduceStrategy::UseRegisterMem() {
   for (auto &it : analyzer_->buf_info_) {
     auto buf = it.second.get();
@@ -734,6 +877,7 @@ int64_t GpuStrategy::TileAfterThreadMapping(TileAxis *axis, size_t inner_dim, in
 
   if (template_ == Template::CUSTOM_CONFIG) {
     if (!analyzer_->scop_info_.user_config_.GetEnableAtomicAdd() &&
+        !analyzer_->scop_info_.user_config_.GetEnableDeterministicReduce() &&
         (axis->HasAttr(AT_REDUCE_AXIS) || axis->mc_sup == 0)) {
       tile = shape;
       ss << "tile = shape to disable atomic add, ";
@@ -914,8 +1058,20 @@ void GpuStrategy::InjectiveSpeedup() {
                             ? 128
                             : coaleasced_size < max_num_threads_ ? 512 : max_num_threads_;
   auto total_blocks = std::accumulate(block_cfg_.begin(), block_cfg_.end(), 1, std::multiplies<int>());
-  auto proposal_elem_per_thread =
-    coaleasced_size < warp_sizes_ ? 1 : total_blocks < proposal_blocks * 8 ? min_elem_for_io_bound_ : 8;
+  // Without user-defined elements per thread, the thread for-loop is derived from the tensor size so that large
+  // tensors do not launch a thread for each element.
+  bool coarsening = analyzer_->scop_info_.user_config_.GetEnableThreadCoarsening() &&
+                    analyzer_->scop_info_.user_config_.GetElemPerThread().empty();
+  int64_t total_size = 1;
+  for (auto axis : injective_axes) {
+    total_size *= axis->range_extent.as<IntImm>()->value;
+  }
+  int64_t proposal_elem_per_thread = total_blocks < proposal_blocks * 8 ? min_elem_for_io_bound_ : 8;
+  if (coaleasced_size < warp_sizes_) {
+    proposal_elem_per_thread = 1;
+  } else if (coarsening) {
+    proposal_elem_per_thread = ThreadCoarsenFactor(total_size);
+  }
   auto shrinked_threads = total_threads / proposal_threads;
   auto shrinked_blocks = total_blocks / proposal_blocks;
 
@@ -946,6 +1102,7 @@ void GpuStrategy::InjectiveSpeedup() {
     }
   }
 
+  int64_t coarsen_factor = 1;
   if (block_to_elem || thread_to_elem) {
     for (auto axis : injective_axes) {
       auto shrink_limit = block_to_elem ? shrinked_blocks : shrinked_threads;
@@ -972,13 +1129,32 @@ void GpuStrategy::InjectiveSpeedup() {
       }
       ss << "axis " << axis->dim_axis << " before shrink " << before_shrink << " shrink size " << coef;
       axis->TileRestrainToSingleValue(tile_size * coef, TileLevel::CACHE1);
+      coarsen_factor *= coef;
     }
   }
+  if (coarsening) {
+    ss << "thread coarsen factor = " << coarsen_factor;
+    analyzer_->scop_info_.user_config_.SetThreadCoarsenFactor(static_cast<int>(coarsen_factor));
+  }
   analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
 
   WriteConfigBack();
 }
 
+int64_t GpuStrategy::ThreadCoarsenFactor(int64_t total_size) {
+  auto resident_threads =
+    std::max<int64_t>(analyzer_->scop_info_.user_config_.GetSmCount(), 1) * max_threads_per_sm_ * coarsen_waves_;
+  int64_t factor = 1;
+  while (factor * 2 <= max_coarsen_factor_ && total_size / (factor * 2) >= resident_threads &&
+         total_size % (factor * 2) == 0) {
+    factor *= 2;
+  }
+  std::stringstream ss;
+  ss << "total size " << total_size << ", resident threads " << resident_threads << ", coarsen factor " << factor;
+  analyzer_->logger_.AppendLog(GPU_MAPPING, ss);
+  return factor;
+}
+
 void GpuStrategy::BroadcastSpeedup() {
   analyzer_->logger_.AppendLine(GPU_MAPPING, "BroadcastSpeedup");
   size_t depth = 0;
@@ -1101,11 +1277,17 @@ void GpuStrategy::GpuVectorBroadcastStrategy() {
       coalesced_size = coalesced_size == 0 ? 1 : coalesced_size;
     }
 
-    int elem_per_thread = 8;
+    bool coarsening = analyzer_->scop_info_.user_config_.GetEnableThreadCoarsening() &&
+                      analyzer_->scop_info_.user_config_.GetElemPerThread().empty();
+    int elem_per_thread = coarsening ? static_cast<int>(ThreadCoarsenFactor(fused_size_)) : 8;
     int min_block = coalesced_size < warp_sizes_ ? 1024 : 512;
     if (coalesced_size >= warp_sizes_) {
       axis->thread_constraints.item_process_ =
         std::min(elem_per_thread, std::max<int>((fused_size_ / possible_threads / min_block + 1) / 2 * 2, 1));
+      if (coarsening) {
+        analyzer_->scop_info_.user_config_.SetThreadCoarsenFactor(
+          static_cast<int>(axis->thread_constraints.item_process_));
+      }
       ss << "thread for-loop speedup = " << axis->thread_constraints.item_process_;
     } else if (total_injective_size > min_block) {
       while (possible_threads % warp_sizes_ != 0 && possible_threads < max_num_threads_) {
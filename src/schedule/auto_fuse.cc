@@ -18,6 +18,8 @@
 #include <tvm/schedule_pass.h>
 #include <tvm.h>
 #include <dmlc/common.h>
+#include <algorithm>
+#include <numeric>
 
 #include "pass/utils.h"
 
@@ -61,9 +63,6 @@ class FuseOpAxis {
     for (auto op : sch_->outputs) {
       TraverseCheck(op);
     }
-    if (!enable_fuse) {
-      return;
-    }
     for (auto op : sch_->outputs) {
       TraverseFuse(op);
     }
@@ -93,7 +92,8 @@ class FuseOpAxis {
 
  private:
   Schedule sch_;
-  bool enable_fuse{true};
+  // ops whose reduce axes belong to several reduce groups, they keep their reduce axes unfused
+  std::unordered_set<Operation> multi_group_reduce_ops_;
   std::unordered_set<Operation> check_visited;
   std::unordered_set<Operation> fuse_visited;
   std::unordered_map<IterVar, std::unordered_set<size_t>> axis_reduce_group_ids_;
@@ -104,14 +104,17 @@ class FuseOpAxis {
       return;
     }
     auto tensor = op.output(0);
-    // reduce axis of op should be same
+    // record the op whose reduce axes can not be fused into one axis
     auto compute_op = sch_[tensor]->op.as<air::ComputeOpNode>();
     CHECK_NOTNULL(compute_op);
     if (compute_op->reduce_axis.size() > 1) {
       if (SplitAxisToGroups(compute_op->reduce_axis).size() > 1) {
-        LOG(WARNING) << "The scenes where the reduce_axis cannot be fused into one axis currently not supported."
-                     << std::endl;
-        enable_fuse = false;
+        // such as a total sum next to a column sum of the same data: the reduce axes can not be fused into one axis,
+        // but the data parallel axes of this op and the other ops can still be fused.
+        if (DEBUG_AUTO_FUSE) {
+          LOG(INFO) << "reduce axes of " << op->func_name() << " are kept as they are" << std::endl;
+        }
+        multi_group_reduce_ops_.insert(op);
       }
     }
   }
@@ -124,7 +127,7 @@ class FuseOpAxis {
     // fuse reduce axis of op
     auto compute_op = sch_[tensor]->op.as<air::ComputeOpNode>();
     CHECK_NOTNULL(compute_op);
-    if (compute_op->reduce_axis.size() > 1) {
+    if (compute_op->reduce_axis.size() > 1 && !multi_group_reduce_ops_.count(op)) {
       IterVar fused_reduce_axis;
       sch_[tensor].fuse(compute_op->reduce_axis, &fused_reduce_axis);
       // reduce by the fused_reduce_axis
@@ -138,6 +141,15 @@ class FuseOpAxis {
     CHECK_NOTNULL(compute_op);
     if (compute_op->axis.size() > 1) {
       auto axis_groups = SplitAxisToGroups(compute_op->axis);
+      Array<IterVar> order;
+      for (const auto &axis_group : axis_groups) {
+        for (const auto &ax : axis_group) {
+          order.push_back(ax);
+        }
+      }
+      if (!std::equal(order.begin(), order.end(), compute_op->axis.begin())) {
+        sch_[tensor].reorder(order);
+      }
       for (const auto &axis_group : axis_groups) {
         IterVar fused_axis;
         sch_[tensor].fuse(axis_group, &fused_axis);
@@ -145,28 +157,35 @@ class FuseOpAxis {
     }
   }
 
+  // Axes with the same reduce groups are put into one group, even if other axes lie between them, such as i and k of
+  // out[i, j, k] = in[i, j, k] - reduce_j[i, k]. The groups are ordered by their innermost axis so that the innermost
+  // axis stays innermost after the reorder, and the fused axes line up with the ones of reduce_j.
   std::vector<Array<IterVar>> SplitAxisToGroups(const Array<IterVar> &axis) {
-    std::vector<std::unordered_set<size_t>> reduce_group_ids(axis.size());
+    std::vector<std::unordered_set<size_t>> group_keys;
+    std::vector<size_t> group_last_index;
+    std::vector<Array<IterVar>> groups;
     for (size_t i = 0; i < axis.size(); ++i) {
+      std::unordered_set<size_t> reduce_group_ids;
       if (axis_reduce_group_ids_.count(axis[i])) {
-        reduce_group_ids[i] = axis_reduce_group_ids_.at(axis[i]);
-      }
-    }
-    std::vector<size_t> split_index;
-    split_index.push_back(0);
-    for (size_t i = 1; i < axis.size(); ++i) {
-      if (reduce_group_ids[i] != reduce_group_ids[i - 1]) {
-        split_index.push_back(i);
-      }
-    }
-    split_index.push_back(axis.size());
+        reduce_group_ids = axis_reduce_group_ids_.at(axis[i]);
+      }
+      auto it = std::find(group_keys.begin(), group_keys.end(), reduce_group_ids);
+      auto group_index = static_cast<size_t>(it - group_keys.begin());
+      if (it == group_keys.end()) {
+        group_keys.push_back(reduce_group_ids);
+        group_last_index.push_back(i);
+        groups.push_back(Array<IterVar>());
+      }
+      groups[group_index].push_back(axis[i]);
+      group_last_index[group_index] = i;
+    }
+    std::vector<size_t> group_order(groups.size());
+    std::iota(group_order.begin(), group_order.end(), 0);
+    std::sort(group_order.begin(), group_order.end(),
+              [&group_last_index](size_t a, size_t b) { return group_last_index[a] < group_last_index[b]; });
     std::vector<Array<IterVar>> res;
-    for (size_t i = 0; i < split_index.size() - 1; ++i) {
-      Array<IterVar> cur_axis_group;
-      for (auto j = split_index[i]; j < split_index[i + 1]; ++j) {
-        cur_axis_group.push_back(axis[j]);
-      }
-      res.push_back(cur_axis_group);
+    for (auto index : group_order) {
+      res.push_back(groups[index]);
     }
     return res;
   }
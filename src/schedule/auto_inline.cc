@@ -125,6 +125,141 @@ void GetConvInputName(const Operation &op, std::unordered_set<std::string> &inpu
   }
 }
 
+// estimated cost of the arithmetic of one element of an injective op, reads of tensors are free.
+class OpCounter : public IRVisitor {
+ public:
+  void Visit(const NodeRef &node) final {
+    if (node.as<Add>() || node.as<Sub>() || node.as<Mul>() || node.as<Div>() || node.as<Mod>() ||
+        node.as<FloorDiv>() || node.as<FloorMod>() || node.as<Min>() || node.as<Max>() || node.as<EQ>() ||
+        node.as<NE>() || node.as<LT>() || node.as<LE>() || node.as<GT>() || node.as<GE>() || node.as<And>() ||
+        node.as<Or>() || node.as<Not>() || node.as<Select>() || node.as<Cast>()) {
+      ops_ += 1;
+    }
+    IRVisitor::Visit(node);
+  }
+
+  void Visit_(const Call *op) final {
+    if (op->call_type == Call::Halide) {
+      calls_[op->func] += 1;
+    } else if (op->call_type == Call::Extern || op->call_type == Call::PureExtern) {
+      // exp, log, sqrt, tanh... are computed by the special function units, many cycles each.
+      ops_ += kMathCallCost;
+    } else if (op->name != "tvm_if_then_else") {
+      ops_ += 1;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  static constexpr int64_t kMathCallCost = 8;
+  int64_t ops_{0};
+  // number of reads of each tensor for one element
+  std::unordered_map<FunctionRef, int64_t, NodeHash, NodeEqual> calls_;
+};
+
+/*
+ * Arithmetic intensity model of inlining on gpu. Keeping an op computes each element once and pays for writing its
+ * buffer and for every read of it; inlining pays for the arithmetic of the op at every read instead. The reads of an
+ * op are counted through the ops inlined into their consumers, so a producer of an op recomputed N times is read N
+ * times as well. Ops are decided from the outputs up, after all their consumers.
+ */
+class InlineCostModel {
+ public:
+  InlineCostModel(const Schedule &sch, const std::unordered_set<Operation> &candidates) {
+    for (const Stage &s : sch->stages) {
+      if (const auto compute = s->op.as<ComputeOpNode>()) {
+        OpCounter counter;
+        for (auto &e : compute->body) {
+          counter.Visit(e);
+        }
+        ops_[s->op] = counter.ops_;
+        // a reduction reads its inputs once per point of the reduce domain, not once per output element.
+        int64_t reduce_extent = 1;
+        for (const auto &axis : compute->reduce_axis) {
+          auto imm = axis->dom->extent.as<IntImm>();
+          reduce_extent = (imm == nullptr || reduce_extent < 0) ? -1 : reduce_extent * imm->value;
+        }
+        for (const auto &kv : counter.calls_) {
+          consumers_[kv.first].emplace_back(s->op, reduce_extent < 0 ? -1 : kv.second * reduce_extent);
+        }
+      }
+    }
+    for (auto it = sch->stages.rbegin(); it != sch->stages.rend(); ++it) {
+      Decide((*it)->op, candidates.count((*it)->op) > 0);
+    }
+  }
+
+  bool IsInline(const Operation &op) const { return inlined_.count(op) > 0; }
+
+  Map<std::string, Expr> GetDecision(const Operation &op) const {
+    return decisions_.count(op) ? decisions_.at(op) : Map<std::string, Expr>();
+  }
+
+ private:
+  static int64_t GetSize(const Operation &op) {
+    int64_t size = 1;
+    for (const auto &extent : op->output_shape(0)) {
+      auto imm = extent.as<IntImm>();
+      if (imm == nullptr) {
+        return -1;
+      }
+      size *= imm->value;
+    }
+    return size;
+  }
+
+  void Decide(const Operation &op, bool candidate) {
+    int64_t size = GetSize(op);
+    computed_[op] = size;
+    if (!candidate) {
+      return;
+    }
+    // elements computed for the consumers when the op is inlined
+    int64_t reads = 0;
+    bool known = size >= 0;
+    for (const auto &consumer : consumers_[op]) {
+      auto it = computed_.find(consumer.first);
+      if (it == computed_.end() || it->second < 0 || consumer.second < 0) {
+        known = false;
+        break;
+      }
+      reads += it->second * consumer.second;
+    }
+    if (!known) {
+      // dynamic shapes keep the fixed rules.
+      inlined_.insert(op);
+      computed_[op] = -1;
+      return;
+    }
+    int64_t ops = ops_[op];
+    int64_t bytes = op.output(0)->dtype.bytes();
+    int64_t recompute_cost = ops * reads;
+    int64_t keep_cost = ops * size + kGlobalByteCost * bytes * (size + reads);
+    bool is_inline = recompute_cost <= keep_cost;
+    if (is_inline) {
+      inlined_.insert(op);
+      computed_[op] = reads;
+    }
+    Map<std::string, Expr> decision;
+    decision.Set("inline", make_const(Int(32), is_inline));
+    decision.Set("ops", make_const(Int(64), ops));
+    decision.Set("fan_out", make_const(Int(64), static_cast<int64_t>(consumers_[op].size())));
+    decision.Set("reads", make_const(Int(64), reads));
+    decision.Set("recompute_cost", make_const(Int(64), recompute_cost));
+    decision.Set("keep_cost", make_const(Int(64), keep_cost));
+    decisions_[op] = decision;
+  }
+
+  // arithmetic ops that cost as much as one byte of global memory traffic
+  static constexpr int64_t kGlobalByteCost = 4;
+  std::unordered_map<Operation, int64_t> ops_;
+  // consumers of each tensor with their reads for one element they compute, -1 if unknown
+  std::unordered_map<FunctionRef, std::vector<std::pair<Operation, int64_t>>, NodeHash, NodeEqual> consumers_;
+  // elements of the op computed by the kernel, -1 if unknown
+  std::unordered_map<Operation, int64_t> computed_;
+  std::unordered_set<Operation> inlined_;
+  std::unordered_map<Operation, Map<std::string, Expr>> decisions_;
+};
+
 class CSE {
  public:
   std::unordered_set<Operation> FindCommonSubexpr(Schedule sch) {
@@ -187,7 +322,8 @@ class CSE {
   std::unordered_map<Operation, int> counter;
 };
 
-void AutoInline(Schedule sch, const Target &target ,bool enable_cse) {
+Map<std::string, Map<std::string, Expr>> AutoInline(Schedule sch, const Target &target, bool enable_cse,
+                                                    bool enable_cost_model) {
   // Note: do not support inline of hybrid ops
   std::unordered_set<Operation, NodeHash, NodeEqual> uninlinable;
   for (const Stage &s : sch->stages) {
@@ -212,13 +348,38 @@ void AutoInline(Schedule sch, const Target &target ,bool enable_cse) {
     common_subexpr = CSE().FindCommonSubexpr(sch);
   }
 
+  std::unordered_set<Operation> candidates;
   for (Stage s : sch->stages) {
     if (!s.is_scheduled() && (IsInjective(s->op) || air::schedule::IsElemWise(s->op)) && !CantInline(s->op, target) &&
         !s->is_output && uninlinable.count(s->op) == 0 && !(has_conv && !IsConvInline(s->op, conv_inputs)) &&
         (s->op->attrs.count("no_inline") == 0 && common_subexpr.count(s->op) == 0)) {
+      candidates.insert(s->op);
+    }
+  }
+
+  Map<std::string, Map<std::string, Expr>> decisions;
+  if (target->device_type == kDLGPU && enable_cost_model) {
+    InlineCostModel model(sch, candidates);
+    for (Stage s : sch->stages) {
+      if (candidates.count(s->op) == 0) {
+        continue;
+      }
+      auto decision = model.GetDecision(s->op);
+      if (!decision.empty()) {
+        decisions.Set(s->op->name, decision);
+      }
+      if (!model.IsInline(s->op)) {
+        candidates.erase(s->op);
+      }
+    }
+  }
+
+  for (Stage s : sch->stages) {
+    if (candidates.count(s->op)) {
       static_cast<void>(s.compute_inline());
     }
   }
+  return decisions;
 }
 }  // namespace schedule
 }  // namespace akg
@@ -0,0 +1,112 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+LOOP_EXTENT = 8
+THREADS = 32
+VECTOR = 4
+
+
+def _fetch_loop(copy=True):
+    # every thread copies 16 bytes of A into the shared buffer, then the loop body reads it back.
+    ib = akg.tvm.ir_builder.create()
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", THREADS)
+    a = ib.pointer("float32", name="A")
+    b = ib.pointer("float32", name="B")
+    s = ib.allocate("float32", (THREADS * VECTOR,), name="S", scope="shared")
+    with ib.for_range(0, LOOP_EXTENT, name="k") as k:
+        with ib.new_scope():
+            ib.scope_attr(s.asnode(), "double_buffer_scope", 1)
+            with ib.for_range(0, VECTOR, name="v") as v:
+                value = a[k * THREADS * VECTOR + tx * VECTOR + v]
+                s[tx * VECTOR + v] = value if copy else value * 2.0
+        b[k * THREADS + tx] = s[tx]
+    return ib.get()
+
+
+def _calls(stmt):
+    calls = {}
+
+    def visit(node):
+        if isinstance(node, akg.tvm.expr.Call):
+            calls.setdefault(node.name, []).append(node)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return calls
+
+
+def _allocate(stmt):
+    allocs = []
+
+    def visit(node):
+        if isinstance(node, akg.tvm.stmt.Allocate):
+            allocs.append(node)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return allocs
+
+
+def test_pipeline_three_stages():
+    res = akg.tvm.ir_pass.InjectAsyncCopyPipeline(_fetch_loop(), 3)
+    calls = _calls(res)
+    # two fetches in the prologue and one per iteration, each copies 16 bytes.
+    assert len(calls["akg_cp_async"]) == 3
+    assert all(call.args[2].value == 16 for call in calls["akg_cp_async"])
+    assert len(calls["akg_cp_async_commit"]) == 3
+    assert [call.args[0].value for call in calls["akg_cp_async_wait"]] == [2]
+    # one barrier before the prologue, one before each issue and one after each wait.
+    assert len(calls["tvm_storage_sync"]) == 3
+    assert all(call.args[0].value == "shared" for call in calls["tvm_storage_sync"])
+    allocs = _allocate(res)
+    assert len(allocs) == 1
+    assert [e.value for e in allocs[0].extents] == [3, THREADS * VECTOR]
+    # the loop body reads the stage of its own iteration.
+    assert "(k%3)*128" in str(res).replace(" ", "")
+
+
+def test_wait_after_issue_and_barriers():
+    res = akg.tvm.ir_pass.InjectAsyncCopyPipeline(_fetch_loop(), 2)
+    loop = [None]
+
+    def visit(node):
+        if isinstance(node, akg.tvm.stmt.For) and node.loop_var.name.startswith("k"):
+            loop[0] = node
+
+    akg.tvm.ir_pass.PostOrderVisit(res, visit)
+    assert loop[0] is not None
+    names = []
+
+    def visit_body(node):
+        if isinstance(node, akg.tvm.expr.Call) and node.name in ("akg_cp_async", "akg_cp_async_commit",
+                                                                  "akg_cp_async_wait", "tvm_storage_sync"):
+            names.append(node.name)
+
+    akg.tvm.ir_pass.PostOrderVisit(loop[0].body, visit_body)
+    assert names == ["tvm_storage_sync", "akg_cp_async", "akg_cp_async_commit", "akg_cp_async_wait",
+                     "tvm_storage_sync"]
+
+
+def test_skip_non_copy_fetch():
+    stmt = _fetch_loop(copy=False)
+    res = akg.tvm.ir_pass.InjectAsyncCopyPipeline(stmt, 3)
+    assert "akg_cp_async" not in _calls(res)
+    assert res.same_as(stmt)
+
+
+if __name__ == "__main__":
+    test_pipeline_three_stages()
+    test_wait_after_issue_and_barriers()
+    test_skip_non_copy_fetch()
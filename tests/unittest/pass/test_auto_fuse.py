@@ -0,0 +1,60 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg
+import akg.tvm
+
+
+def _leaf_names(sch, tensor):
+    names = [iv.var.name for iv in sch[tensor].leaf_iter_vars]
+    return names
+
+
+def test_reduce_feeding_broadcast_on_other_axis():
+    # the reduction over the middle axis is broadcast back along it, the outer and inner axes are fused in both stages.
+    shape = (16, 32, 64)
+    data = akg.tvm.placeholder(shape, name="data")
+    rj = akg.tvm.reduce_axis((0, shape[1]), name="rj")
+    reduce_j = akg.tvm.compute((shape[0], shape[2]), lambda i, k: akg.tvm.sum(data[i, rj, k], axis=rj),
+                               name="reduce_j")
+    out = akg.tvm.compute(shape, lambda i, j, k: data[i, j, k] - reduce_j[i, k], name="out")
+    sch = akg.tvm.create_schedule(out.op)
+    akg.tvm.schedule.AutoFuse(sch)
+
+    assert _leaf_names(sch, reduce_j) == ["i.k.fused", "rj"]
+    assert _leaf_names(sch, out) == ["j", "i.k.fused"]
+
+
+def test_reductions_over_different_axes():
+    # the total sum can not fuse its reduce axes as the column sum only reduces one of them, the batch axes of both
+    # reductions are still fused.
+    shape = (4, 8, 32, 64)
+    data = akg.tvm.placeholder(shape, name="data")
+    ri = akg.tvm.reduce_axis((0, shape[2]), name="ri")
+    col_sum = akg.tvm.compute((shape[0], shape[1], shape[3]),
+                              lambda b0, b1, j: akg.tvm.sum(data[b0, b1, ri, j], axis=ri), name="col_sum")
+    ti = akg.tvm.reduce_axis((0, shape[2]), name="ti")
+    tj = akg.tvm.reduce_axis((0, shape[3]), name="tj")
+    total = akg.tvm.compute((shape[0], shape[1]),
+                            lambda b0, b1: akg.tvm.sum(data[b0, b1, ti, tj], axis=[ti, tj]), name="total")
+    sch = akg.tvm.create_schedule([col_sum.op, total.op])
+    akg.tvm.schedule.AutoFuse(sch)
+
+    assert _leaf_names(sch, total) == ["b0.b1.fused", "ti", "tj"]
+    assert _leaf_names(sch, col_sum) == ["b0.b1.fused", "j", "ri"]
+
+
+if __name__ == "__main__":
+    test_reduce_feeding_broadcast_on_other_axis()
+    test_reductions_over_different_axes()
@@ -0,0 +1,75 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg
+import akg.tvm
+
+
+def _inline_decisions(out):
+    sch = akg.tvm.create_schedule(out.op)
+    decisions = akg.tvm.schedule.AutoInline(sch, akg.tvm.target.create("cuda"), False, True)
+    return {name: d["inline"].value for name, d in decisions.items()}
+
+
+def test_expensive_producer_with_fan_out():
+    # the transcendental producer is read by four consumers, recomputing it costs more than its buffer.
+    shape = (1024, 1024)
+    a = akg.tvm.placeholder(shape, name="a")
+    bias = akg.tvm.placeholder((shape[1],), name="bias")
+    expensive = akg.tvm.compute(
+        shape, lambda i, j: akg.tvm.exp(a[i, j]) * akg.tvm.log(a[i, j]) + akg.tvm.tanh(a[i, j]) * akg.tvm.sqrt(a[i, j])
+        + akg.tvm.exp(a[i, j] * 2), name="expensive")
+    broadcast = akg.tvm.compute(shape, lambda i, j: bias[j], name="broadcast")
+    consumers = [akg.tvm.compute(shape, lambda i, j, k=k: expensive[i, j] + broadcast[i, j] * float(k),
+                                 name="consumer_%d" % k) for k in range(4)]
+    out = akg.tvm.compute(shape, lambda i, j: consumers[0][i, j] + consumers[1][i, j] + consumers[2][i, j]
+                          + consumers[3][i, j], name="out")
+
+    decisions = _inline_decisions(out)
+    assert decisions["expensive"] == 0
+    assert decisions["broadcast"] == 1
+    for k in range(4):
+        assert decisions["consumer_%d" % k] == 1
+
+
+def test_single_consumer_chain():
+    shape = (256, 256)
+    a = akg.tvm.placeholder(shape, name="a")
+    mid = akg.tvm.compute(shape, lambda i, j: akg.tvm.exp(a[i, j]) + 1.0, name="mid")
+    out = akg.tvm.compute(shape, lambda i, j: mid[i, j] * 2.0, name="out")
+
+    decisions = _inline_decisions(out)
+    assert decisions["mid"] == 1
+
+
+def test_reduce_consumer():
+    # the matmul reads every element of the producer once per column of b, 64 times in all.
+    n = 64
+    a = akg.tvm.placeholder((n, n), name="a")
+    b = akg.tvm.placeholder((n, n), name="b")
+    expensive = akg.tvm.compute(
+        (n, n), lambda i, k: akg.tvm.exp(a[i, k]) * akg.tvm.log(a[i, k]) + akg.tvm.tanh(a[i, k]), name="expensive")
+    k = akg.tvm.reduce_axis((0, n), name="k")
+    out = akg.tvm.compute((n, n), lambda i, j: akg.tvm.sum(expensive[i, k] * b[k, j], axis=k), name="out")
+
+    sch = akg.tvm.create_schedule(out.op)
+    decisions = akg.tvm.schedule.AutoInline(sch, akg.tvm.target.create("cuda"), False, True)
+    assert decisions["expensive"]["reads"].value == n * n * n
+    assert decisions["expensive"]["inline"].value == 0
+
+
+if __name__ == "__main__":
+    test_expensive_producer_with_fan_out()
+    test_single_consumer_chain()
+    test_reduce_consumer()
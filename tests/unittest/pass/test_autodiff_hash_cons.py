@@ -0,0 +1,83 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg
+import akg.tvm
+
+SHAPE = (16, 16)
+# every adjoint part is a 16 x 16 float32 tensor
+PART_BYTES = 16 * 16 * 4
+
+
+def _scaled_sum(scale_a, scale_b, ad_attrs=None):
+    x = akg.tvm.placeholder(SHAPE, name="x", dtype="float32")
+    a = akg.tvm.compute(SHAPE, lambda i, j: x[i, j] * akg.tvm.const(scale_a, "float32"), name="a")
+    b = akg.tvm.compute(SHAPE, lambda i, j: x[i, j] * akg.tvm.const(scale_b, "float32"), name="b")
+    y = akg.tvm.compute(SHAPE, lambda i, j: a[i, j] + b[i, j], name="y")
+    head = akg.tvm.placeholder(SHAPE, name="head", dtype="float32")
+    res = akg.differentiate(y, [x], head, ad_attrs)
+    summands = res.adjoint_summands[x]
+    return summands[a], summands[b]
+
+
+def _float_consts(tensor):
+    consts = []
+
+    def visit(node):
+        if isinstance(node, akg.tvm.expr.FloatImm):
+            consts.append(node.value)
+
+    for body in tensor.op.body:
+        akg.tvm.ir_pass.PostOrderVisit(body, visit)
+    return consts
+
+
+def test_share_identical_parts():
+    part_a, part_b = _scaled_sum(2.0, 2.0)
+    assert part_a.same_as(part_b)
+
+
+def test_share_within_budget():
+    part_a, part_b = _scaled_sum(2.0, 2.0, {"ad_checkpoint_bytes": 64 * PART_BYTES})
+    assert part_a.same_as(part_b)
+
+
+def test_no_budget():
+    # a zero budget stores nothing, each consumer recomputes its part.
+    part_a, part_b = _scaled_sum(2.0, 2.0, {"ad_checkpoint_bytes": 0})
+    assert not part_a.same_as(part_b)
+    assert akg.tvm.ir_pass.Equal(part_a.op.body[0], part_b.op.body[0])
+
+
+def test_exceeded_budget():
+    # the budget is one byte short of a part, the duplicate part is recomputed instead of stored.
+    part_a, part_b = _scaled_sum(2.0, 2.0, {"ad_checkpoint_bytes": PART_BYTES - 1})
+    assert not part_a.same_as(part_b)
+
+
+def test_keep_near_equal_constants():
+    # both constants print as 2 with the default 6 digits, the parts must stay apart.
+    part_a, part_b = _scaled_sum(2.0, 2.000001)
+    assert str(akg.tvm.const(2.0, "float32")) == str(akg.tvm.const(2.000001, "float32"))
+    assert not part_a.same_as(part_b)
+    assert 2.000001 in _float_consts(part_b)
+    assert 2.000001 not in _float_consts(part_a)
+
+
+if __name__ == "__main__":
+    test_share_identical_parts()
+    test_share_within_budget()
+    test_no_budget()
+    test_exceeded_budget()
+    test_keep_near_equal_constants()
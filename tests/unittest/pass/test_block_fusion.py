@@ -0,0 +1,62 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def _part(name, blocks, threads, kind):
+    ib = akg.tvm.ir_builder.create()
+    bx = akg.tvm.thread_axis("blockIdx.x")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(bx, "thread_extent", blocks)
+    ib.scope_attr(tx, "thread_extent", threads)
+    buf = ib.pointer("float32", name=name)
+    idx = bx * threads + tx
+    if kind == "sync":
+        buf[idx] = buf[idx] + 1.0
+        ib.emit(akg.tvm.call_intrinsic("int32", "tvm_storage_sync", "shared"))
+        buf[idx] = buf[idx] * 2.0
+    elif kind == "warp":
+        buf[idx] = akg.tvm.call_pure_intrin("float32", "tvm_warp_shuffle", buf[idx], tx % 32)
+    else:
+        buf[idx] = buf[idx] + 1.0
+    return ib.get()
+
+
+def _extent(stmt):
+    assert isinstance(stmt, akg.tvm.stmt.AttrStmt) and stmt.attr_key == "thread_extent"
+    return stmt.value.value
+
+
+def test_remap_independent_part():
+    # the elementwise part runs 4 x 64 threads, flattened over the fused 256 threads it needs a single block.
+    # the parts with a barrier or a warp shuffle keep their own block shape.
+    parts = [_part("elem", 4, 64, "elem"), _part("sync", 2, 256, "sync"), _part("warp", 4, 64, "warp")]
+    res = akg.tvm.ir_pass.BlockFusion(parts)
+    assert _extent(res) == 1 + 2 + 4
+    assert _extent(res.body) == 256
+    assert "(threadIdx.x < 64)" in str(res)
+
+
+def test_keep_warp_shuffle_part():
+    parts = [_part("warp", 8, 32, "warp"), _part("elem", 1, 128, "elem")]
+    res = akg.tvm.ir_pass.BlockFusion(parts)
+    assert _extent(res) == 8 + 1
+    assert _extent(res.body) == 128
+    assert "(threadIdx.x < 32)" in str(res)
+
+
+if __name__ == "__main__":
+    test_remap_independent_part()
+    test_keep_warp_shuffle_part()
@@ -0,0 +1,77 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg
+import akg.tvm
+
+
+def _holds(conds, point):
+    for cond in conds:
+        value = akg.tvm.ir_pass.Simplify(akg.tvm.ir_pass.Substitute(cond, point))
+        if value.value == 0:
+            return False
+    return True
+
+
+def _equivalent(conds_a, conds_b, variables, vranges):
+    # both systems must accept exactly the same points of the bounding box.
+    points = [{}]
+    for var in variables:
+        rng = vranges[var]
+        points = [dict(list(p.items()) + [(var, akg.tvm.const(i, var.dtype))])
+                  for p in points for i in range(rng.min.value, rng.min.value + rng.extent.value)]
+    return all(_holds(conds_a, p) == _holds(conds_b, p) for p in points)
+
+
+def test_strided_conv_domain():
+    # the domain of a stride 2 convolution backprop: h = 2 * oh + kh. The python entry fails instead of falling back
+    # to fourier-motzkin, so a result means isl eliminated oh with its coefficient 2.
+    h = akg.tvm.var("h")
+    oh = akg.tvm.var("oh")
+    kh = akg.tvm.var("kh")
+    vranges = {h: akg.tvm.Range(0, 32), oh: akg.tvm.Range(0, 15), kh: akg.tvm.Range(0, 3)}
+    inequalities = [h == 2 * oh + kh, oh * 2 <= h]
+    variables = [oh, kh, h]
+    fm_res = akg.tvm.ir_pass.SolveSystemOfInequalitiesFourierMotzkin(inequalities, variables, vranges)
+    isl_res = akg.tvm.ir_pass.SolveSystemOfInequalitiesIsl(inequalities, variables, vranges)
+    assert _equivalent(list(fm_res), list(isl_res), variables, vranges)
+    assert _equivalent(inequalities, list(isl_res), variables, vranges)
+
+
+def test_empty_domain():
+    x = akg.tvm.var("x")
+    y = akg.tvm.var("y")
+    vranges = {x: akg.tvm.Range(0, 10), y: akg.tvm.Range(0, 10)}
+    inequalities = [x + y >= 19, x - y >= 2]
+    fm_res = akg.tvm.ir_pass.SolveSystemOfInequalitiesFourierMotzkin(inequalities, [x, y], vranges)
+    isl_res = akg.tvm.ir_pass.SolveSystemOfInequalitiesIsl(inequalities, [x, y], vranges)
+    assert _equivalent(list(fm_res), list(isl_res), [x, y], vranges)
+    assert any(akg.tvm.ir_pass.Equal(c, akg.tvm.const(0, "bool")) for c in isl_res)
+
+
+def test_reject_non_affine():
+    x = akg.tvm.var("x")
+    y = akg.tvm.var("y")
+    vranges = {x: akg.tvm.Range(0, 10), y: akg.tvm.Range(0, 10)}
+    try:
+        akg.tvm.ir_pass.SolveSystemOfInequalitiesIsl([x * y <= 5], [x, y], vranges)
+    except akg.tvm.TVMError:
+        return
+    assert False, "isl solved a non affine system"
+
+
+if __name__ == "__main__":
+    test_strided_conv_domain()
+    test_empty_domain()
+    test_reject_non_affine()
@@ -0,0 +1,99 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+THREADS = 256
+
+
+def _kernel(size, blocks, guard=True):
+    # every thread adds one to an element, the last block is partial when size is not a multiple of THREADS.
+    ib = akg.tvm.ir_builder.create()
+    bx = akg.tvm.thread_axis("blockIdx.x")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(bx, "thread_extent", blocks)
+    ib.scope_attr(tx, "thread_extent", THREADS)
+    buf = ib.pointer("float32", name="buf")
+    tmp = ib.allocate("float32", (1,), name="tmp", scope="local")
+    idx = bx * THREADS + tx
+    if guard:
+        with ib.if_scope(idx < size):
+            tmp[0] = buf[idx] + 1.0
+            buf[idx] = tmp[0]
+    else:
+        tmp[0] = buf[idx] + 1.0
+        buf[idx] = tmp[0]
+    return ib.get()
+
+
+def _collect(stmt, node_type):
+    nodes = []
+
+    def visit(node):
+        if isinstance(node, node_type):
+            nodes.append(node)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return nodes
+
+
+def _block_x(kernel):
+    assert isinstance(kernel, akg.tvm.stmt.AttrStmt) and kernel.attr_key == "thread_extent"
+    assert kernel.node.thread_tag == "blockIdx.x"
+    return kernel
+
+
+def _holds(cond, values):
+    vmap = {var: akg.tvm.const(values[var.name], var.dtype) for var in _collect(cond, akg.tvm.expr.Var)}
+    return akg.tvm.ir_pass.Simplify(akg.tvm.ir_pass.Substitute(cond, vmap)).value != 0
+
+
+def test_split_main_and_tail():
+    res = akg.tvm.ir_pass.SpecializeKernelVersion(_kernel(1000, 4))
+    assert isinstance(res, akg.tvm.stmt.Block)
+    main, tail = _block_x(res.first), _block_x(res.rest)
+    # the first 3 blocks are full and run without the guard.
+    assert main.value.value == 3
+    assert not _collect(main, akg.tvm.stmt.IfThenElse)
+    # the tail block keeps the guard, shifted to the last block: 1000 - 3 * 256 = 232 threads are active.
+    assert tail.value.value == 1
+    guards = _collect(tail, akg.tvm.stmt.IfThenElse)
+    assert len(guards) == 1
+    cond = guards[0].condition
+    assert _holds(cond, {"blockIdx.x": 0, "threadIdx.x": 231})
+    assert not _holds(cond, {"blockIdx.x": 0, "threadIdx.x": 232})
+    # the tail kernel allocates its own buffers.
+    main_allocs = [a.buffer_var.name for a in _collect(main, akg.tvm.stmt.Allocate)]
+    tail_allocs = [a.buffer_var.name for a in _collect(tail, akg.tvm.stmt.Allocate)]
+    assert main_allocs == ["tmp"]
+    assert tail_allocs == ["tmp_tail"]
+
+
+def test_keep_kernel_without_tail_guard():
+    # the guard holds on every block, there is nothing to specialize.
+    stmt = _kernel(1024, 4)
+    assert akg.tvm.ir_pass.SpecializeKernelVersion(stmt).same_as(stmt)
+    stmt = _kernel(1024, 4, guard=False)
+    assert akg.tvm.ir_pass.SpecializeKernelVersion(stmt).same_as(stmt)
+
+
+def test_keep_single_block_kernel():
+    stmt = _kernel(200, 1)
+    assert akg.tvm.ir_pass.SpecializeKernelVersion(stmt).same_as(stmt)
+
+
+if __name__ == "__main__":
+    test_split_main_and_tail()
+    test_keep_kernel_without_tail_guard()
+    test_keep_single_block_kernel()
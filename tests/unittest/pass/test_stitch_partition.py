@@ -0,0 +1,73 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import json
+from akg import tvm
+from akg.composite import build_module
+
+SOFTMAX_CASE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../operators/ci_gpu/stitch_cases",
+                            "Fused_Cast_LessEqual_Cast_Mul_TensorAdd_ReduceMax_Sub_Exp_ReduceSum_RealDiv_Mul.json")
+
+
+def _stitch_partition(desc_d):
+    stitch_op = tvm.get_global_func("composite_stitch_partition")(json.dumps(desc_d))
+    return [[node.value for node in nodes] for nodes in stitch_op]
+
+
+def test_softmax_without_fusion_info():
+    # the graph kernel stitches the two reduce outputs that are broadcast back to the rows, the search has to
+    # choose them as well, in topological order.
+    with open(SOFTMAX_CASE, "r") as f:
+        desc_d = json.loads(f.read())
+    expect = desc_d.pop("buffer_stitch")["stitch_op"]
+    stitch_op = _stitch_partition(desc_d)
+    stitch_nodes = [nodes[0] for nodes in stitch_op]
+    assert all(len(nodes) == 1 for nodes in stitch_op)
+    must = [nodes[0] for nodes in expect]
+    assert [name for name in stitch_nodes if name in must] == must
+    # optional nodes are intermediates with several consumers.
+    assert set(stitch_nodes) - set(must) <= {"output_0_4", "output_0_7"}
+
+
+def test_elemwise_graph_is_not_stitched():
+    with open(SOFTMAX_CASE, "r") as f:
+        desc_d = json.loads(f.read())
+    desc_d.pop("buffer_stitch")
+    # keep the injective prefix of the graph, before the first reduce.
+    ops = []
+    for op in desc_d["op_desc"]:
+        if op["name"] == "ReduceMax":
+            break
+        ops.append(op)
+    desc_d["op_desc"] = ops
+    desc_d["output_desc"] = [ops[-1]["output_desc"][0], ops[2]["output_desc"][0]]
+    assert _stitch_partition(desc_d) == []
+
+
+def test_stitch_partition_is_opt_in():
+    with open(SOFTMAX_CASE, "r") as f:
+        desc_s = f.read()
+    desc_d = json.loads(desc_s)
+    desc_d.pop("buffer_stitch")
+    build_module._stitch_partition(json.dumps(desc_d), desc_d, {"dim": ""})
+    assert "buffer_stitch" not in desc_d
+    build_module._stitch_partition(json.dumps(desc_d), desc_d, {"enable_stitch_partition": True})
+    assert desc_d["buffer_stitch"]["stitch_op"] == _stitch_partition(desc_d)
+
+
+if __name__ == "__main__":
+    test_softmax_without_fusion_info()
+    test_elemwise_graph_is_not_stitched()
+    test_stitch_partition_is_opt_in()
@@ -312,4 +312,80 @@ TEST_F(AutoPolyTest3, RunPass) {
   ASSERT_EQ(infos_lhs.size(), 1);
   EXPECT_EQ(std::get<2>(infos_lhs[0]), 2 * 1024);
 }
+
+/* AutoPolyTest4: test for the double buffer footprint in auto tiling
+ * Input pattern:
+ * for (i0, 0, 1200) {
+ *   for (i1, 0, 2048) {
+ *     out(i0, i1) = a(i0, i1) + b(i0, i1)
+ *   }
+ * }
+ *
+ * A row of each buffer takes 4KB of the 256KB local buffer. With half of it reserved for double buffer, 3 buffers
+ * of 10 rows are the largest tile without tail. Counting the second copies of a_local_UB and b_local_UB instead,
+ * 5 buffers of 12 rows take 240KB and still fit, so the tile has no reason to fail in storage rewrite.
+ *
+ * IR Check:
+ *   rows of a_local_UB: 12
+ */
+class AutoPolyTest4 : public AutoPolyTestBase {
+ public:
+  AutoPolyTest4() {
+    Construct();
+  }
+  ~AutoPolyTest4() = default;
+  void Construct() {
+    vp_.AddVars({"i0", "i1"});
+    a_ = UTExprBuilder::PlaceholderOpNode("a", {1200, 2048}, air::Float(16));
+    b_ = UTExprBuilder::PlaceholderOpNode("b", {1200, 2048}, air::Float(16));
+    out_ = UTExprBuilder::PlaceholderOpNode("out", {1200, 2048}, air::Float(16));
+    stmt_ = air::ir::AttrStmt::make(
+        out_, "realize_scope", air::ir::StringImm::make(""),
+        UTStmtBuilder::CreateRealizeByPlaceholderOp(
+            out_,
+            air::ir::ProducerConsumer::make(out_, true,
+                UTStmtBuilder::CreateFor(
+                    vp_.GetVar("i0"), 0, 1200,
+                    UTStmtBuilder::CreateFor(
+                        vp_.GetVar("i1"), 0, 2048,
+                        UTStmtBuilder::CreateProvideBinary<air::ir::Add>(
+                            out_, vp_.GetVars({"i0", "i1"}),
+                            UTExprBuilder::ElementOf(a_, vp_.GetVars({"i0", "i1"})),
+                            UTExprBuilder::ElementOf(b_, vp_.GetVars({"i0", "i1"}))))))));
+    t_a_ = UTExprBuilder::CreateTensorByPlaceholder(a_);
+    t_b_ = UTExprBuilder::CreateTensorByPlaceholder(b_);
+    t_out_ = UTExprBuilder::CreateTensorByPlaceholder(out_);
+    RegisterTensor(t_a_);
+    RegisterTensor(t_b_);
+    RegisterTensor(t_out_);
+  }
+
+  // first extent of the realize of the buffer, i.e. the rows of a tile
+  static int64_t RealizeRows(const air::NodeRef &stmt, const std::string &name) {
+    int64_t rows = 0;
+    air::ir::PostOrderVisit(stmt, [&rows, &name](const air::NodeRef &node) {
+      const auto realize = node.as<air::ir::Realize>();
+      if (realize != nullptr && realize->func->func_name() == name && !realize->bounds.empty()) {
+        rows = UTIRCheckHelper::GetValueFromImm(realize->bounds[0]->extent);
+      }
+    });
+    return rows;
+  }
+
+  UTVariablePool vp_;
+  air::Operation a_;
+  air::Operation b_;
+  air::Tensor t_a_;
+  air::Tensor t_b_;
+  air::Operation out_;
+  air::Tensor t_out_;
+  air::Stmt stmt_;
+};  // class AutoPolyTest4
+
+TEST_F(AutoPolyTest4, RunPass) {
+  SetRunMode("cloud");
+  air::Array<air::NodeRef> stmts_out = ir::AutoPoly(stmt_, binds_, "cce", global_attrs_, false, false);
+  ASSERT_EQ(stmts_out.size(), 2);
+  EXPECT_EQ(RealizeRows(stmts_out[0], "a_local_UB"), 12);
+}
 }  // namespace akg
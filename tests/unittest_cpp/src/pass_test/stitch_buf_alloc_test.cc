@@ -0,0 +1,215 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include "composite/stitch_fusion.h"
+
+namespace akg {
+namespace {
+StitchBufferInterval MakeInterval(int start, int end, uint64_t size) {
+  StitchBufferInterval interval;
+  interval.start = start;
+  interval.end = end;
+  interval.size = size;
+  return interval;
+}
+
+GridBlockDims MakeDims(int grid_x, int grid_y, int block_x, int block_y) {
+  GridBlockDims dims;
+  dims.griddim_x = grid_x;
+  dims.griddim_y = grid_y;
+  dims.blockdim_x = block_x;
+  dims.blockdim_y = block_y;
+  return dims;
+}
+
+Stmt LowerNothing(const StringImm *, const Map<std::string, NodeRef> &, bool, bool) { return Evaluate::make(0); }
+
+constexpr int BLOCKS = 4;
+
+/* // attr [blockIdx.x] thread_extent = 4
+ * // attr [shared] storage_scope = "shared"      (only with a shared buffer)
+ * allocate shared[float32 * shared_size]
+ * read(0) + shared(0) ...
+ * write(0) = ...
+ */
+Stmt MakeStitchIr(const std::vector<std::string> &reads, const std::string &write, const std::string &shared = "",
+                  int shared_size = 0) {
+  Expr value = FloatImm::make(Float(32), 0);
+  for (const auto &name : reads) {
+    value = value + Load::make(Float(32), Var(name, air::Handle()), 0, air::const_true());
+  }
+  Stmt body;
+  if (!shared.empty()) {
+    Var shared_var(shared, air::Handle());
+    body = Store::make(shared_var, value, 0, air::const_true());
+    value = Load::make(Float(32), shared_var, 0, air::const_true());
+  }
+  Stmt store = Store::make(Var(write, air::Handle()), value, 0, air::const_true());
+  body = body.defined() ? Block::make(body, store) : store;
+  if (!shared.empty()) {
+    Var shared_var(shared, air::Handle());
+    body = Allocate::make(shared_var, Float(32), {shared_size}, air::const_true(), body);
+    body = AttrStmt::make(shared_var, air::ir::attr::storage_scope, StringImm::make("shared"), body);
+  }
+  auto block_idx = air::IterVarNode::make(Range(0, BLOCKS), Var("blockIdx.x"), air::kThreadIndex, "blockIdx.x");
+  return AttrStmt::make(block_idx, air::ir::attr::thread_extent, BLOCKS, body);
+}
+
+// a stitch buffer of size elements per block for output, which may reuse the buffer of reused.
+Array<NodeRef> StitchAlloc(const std::string &reused, int size) {
+  return {StringImm::make(reused), IntImm::make(Int(32), size * BLOCKS)};
+}
+
+// output op_i is passed to the kernel as input_i.
+std::unordered_map<std::string, NodeRef> MakeOutputs2Args(int outputs) {
+  std::unordered_map<std::string, NodeRef> outputs2args;
+  for (int i = 0; i < outputs; ++i) {
+    outputs2args["op_" + std::to_string(i)] = air::decl_buffer({1024}, Float(32), "input_" + std::to_string(i));
+  }
+  return outputs2args;
+}
+}  // namespace
+
+TEST(TestStitchBufAlloc, ColorBufferIntervals) {
+  std::vector<StitchBufferInterval> intervals = {MakeInterval(1, 2, 256), MakeInterval(1, 1, 128),
+                                                 MakeInterval(2, 3, 128), MakeInterval(3, 4, 512),
+                                                 MakeInterval(4, 4, 64)};
+  auto slots = ColorBufferIntervals(intervals);
+  std::vector<size_t> expect = {0, 1, 1, 0, 1};
+  EXPECT_EQ(slots, expect);
+
+  // buffers used by the same ir never share storage.
+  for (size_t i = 0; i < intervals.size(); ++i) {
+    for (size_t j = i + 1; j < intervals.size(); ++j) {
+      bool overlap = intervals[i].start <= intervals[j].end && intervals[j].start <= intervals[i].end;
+      if (overlap) {
+        EXPECT_NE(slots[i], slots[j]) << "interval " << i << " and " << j;
+      }
+    }
+  }
+}
+
+TEST(TestStitchBufAlloc, ColorBufferIntervalsBestFit) {
+  // the buffer of 64 elements takes the smallest free buffer that holds it.
+  std::vector<StitchBufferInterval> intervals = {MakeInterval(1, 1, 512), MakeInterval(1, 1, 64),
+                                                 MakeInterval(2, 2, 64)};
+  auto slots = ColorBufferIntervals(intervals);
+  EXPECT_EQ(slots[2], slots[1]);
+  EXPECT_NE(slots[0], slots[1]);
+}
+
+// op_0 is dead once op_1 is written, both stitch buffers are placed in one slot.
+TEST(TestStitchBufAlloc, BufferAllocReuseDisjoint) {
+  std::vector<Stmt> irs = {MakeStitchIr({}, "input_0"), MakeStitchIr({"input_0"}, "out_0"),
+                           MakeStitchIr({}, "input_1"), MakeStitchIr({"input_1"}, "out_1")};
+  Map<std::string, Array<NodeRef>> alloc_map;
+  alloc_map.Set("op_0", StitchAlloc("", 256));
+  alloc_map.Set("op_1", StitchAlloc("", 128));
+  StitchBufAlloc buf_alloc;
+  buf_alloc.BufferAllocReuse(irs, alloc_map, {}, {}, MakeOutputs2Args(2));
+  ASSERT_TRUE(buf_alloc.stitch_buffer_map.count("input_0"));
+  ASSERT_TRUE(buf_alloc.stitch_buffer_map.count("input_1"));
+  auto first = buf_alloc.stitch_buffer_map["input_0"];
+  auto second = buf_alloc.stitch_buffer_map["input_1"];
+  EXPECT_EQ(first.type, StorageType::Shared);
+  EXPECT_EQ(first.buf_name, "input_0_shared_stitch");
+  EXPECT_EQ(second.buf_name, first.buf_name);
+  EXPECT_EQ(second.alloc_size, 256U);
+  EXPECT_TRUE(buf_alloc.allocate_revoke.empty());
+}
+
+// the op of a reused buffer keeps op_1 in shared memory, its allocation is revoked and moves into the stitch slot.
+TEST(TestStitchBufAlloc, BufferAllocReuseRevoke) {
+  std::vector<Stmt> irs = {MakeStitchIr({}, "input_0"), MakeStitchIr({"input_0"}, "out_0"),
+                           MakeStitchIr({}, "input_1", "input_1_shared", 512), MakeStitchIr({"input_1"}, "out_1")};
+  Map<std::string, Array<NodeRef>> alloc_map;
+  alloc_map.Set("op_0", StitchAlloc("", 256));
+  Map<std::string, Array<NodeRef>> reuse_map;
+  reuse_map.Set("op_1", StitchAlloc("op_0", 256));
+  StitchBufAlloc buf_alloc;
+  buf_alloc.BufferAllocReuse(irs, alloc_map, reuse_map, {}, MakeOutputs2Args(2));
+  ASSERT_EQ(buf_alloc.allocate_revoke.size(), 1U);
+  EXPECT_EQ(buf_alloc.allocate_revoke[0], "input_1_shared");
+  ASSERT_TRUE(buf_alloc.stitch_buffer_map.count("input_1_shared"));
+  auto revoked = buf_alloc.stitch_buffer_map["input_1_shared"];
+  EXPECT_EQ(revoked.type, StorageType::Shared);
+  EXPECT_EQ(revoked.buf_name, "input_0_shared_stitch");
+  // the slot holds the larger shared buffer of the op.
+  EXPECT_EQ(revoked.alloc_size, 512U);
+  EXPECT_EQ(buf_alloc.stitch_buffer_map["input_0"].buf_name, revoked.buf_name);
+  EXPECT_EQ(buf_alloc.stitch_buffer_map["input_1"].buf_name, revoked.buf_name);
+}
+
+// without a suggested reuse, the shared buffer of the op is the stitch buffer.
+TEST(TestStitchBufAlloc, BufferAllocReuseKeepWithinOp) {
+  std::vector<Stmt> irs = {MakeStitchIr({}, "input_0", "input_0_shared", 512), MakeStitchIr({"input_0"}, "out_0")};
+  Map<std::string, Array<NodeRef>> alloc_map;
+  alloc_map.Set("op_0", StitchAlloc("", 256));
+  StitchBufAlloc buf_alloc;
+  buf_alloc.BufferAllocReuse(irs, alloc_map, {}, {}, MakeOutputs2Args(1));
+  EXPECT_TRUE(buf_alloc.allocate_revoke.empty());
+  ASSERT_TRUE(buf_alloc.stitch_buffer_map.count("input_0"));
+  EXPECT_EQ(buf_alloc.stitch_buffer_map["input_0"].buf_name, "input_0_shared");
+  EXPECT_FALSE(buf_alloc.stitch_buffer_map.count("input_0_shared"));
+}
+
+// an elemwise ir is stitched before matmul, the epilogue still takes the dims of the matmul ir.
+TEST(TestStitchBufAlloc, MatmulEpilogueDims) {
+  BufferStitchAttr matmul(LowerNothing);
+  matmul.dims = MakeDims(4, 2, 32, 4);
+  matmul.iter_shape = {Expr(64), Expr(256)};
+  std::vector<StitchOpType> type_array = {StitchOpType::Elem};
+  std::vector<GridBlockDims> dim_array = {MakeDims(128, 1, 256, 1), matmul.dims};
+  StitchAttrInfo stitch_attr;
+  auto matmul_attr =
+    GetIRAttr(StitchOpType::Matmul, matmul, type_array, dim_array, stitch_attr, false, Map<std::string, NodeRef>());
+  stitch_attr.matmul_dims = matmul_attr.dims;
+  type_array.push_back(StitchOpType::Matmul);
+
+  BufferStitchAttr epilogue(LowerNothing);
+  epilogue.dims = MakeDims(64, 1, 256, 1);
+  epilogue.iter_shape = {Expr(64), Expr(256)};
+  dim_array.push_back(epilogue.dims);
+  auto attr =
+    GetIRAttr(StitchOpType::Elem, epilogue, type_array, dim_array, stitch_attr, true, Map<std::string, NodeRef>());
+  EXPECT_EQ(attr.dims.griddim_x, 4);
+  EXPECT_EQ(attr.dims.griddim_y, 2);
+  EXPECT_EQ(attr.grid_dims, 8);
+  EXPECT_EQ(attr.block_dims, 128);
+  // blockIdx.x splits the 256 columns and blockIdx.y the 64 rows.
+  ASSERT_TRUE(attr.attrs.count("dim"));
+  EXPECT_EQ(attr.attrs["dim"].as<StringImm>()->value, "0 0 32 32 0 1 64 64");
+  EXPECT_FALSE(attr.attrs.count("enable_atomic_add"));
+}
+
+// the partial sums of a reduction split between blocks can not be combined in a shared stitch buffer.
+TEST(TestStitchBufAlloc, MatmulEpilogueReduce) {
+  StitchAttrInfo stitch_attr;
+  stitch_attr.matmul_dims = MakeDims(4, 2, 32, 4);
+  std::vector<StitchOpType> type_array = {StitchOpType::Matmul};
+  std::vector<GridBlockDims> dim_array = {stitch_attr.matmul_dims};
+  BufferStitchAttr reduce(LowerNothing);
+  reduce.dims = MakeDims(64, 1, 256, 1);
+  reduce.iter_shape = {Expr(64), Expr(256)};
+  dim_array.push_back(reduce.dims);
+
+  auto attr =
+    GetIRAttr(StitchOpType::Reduce2D_X, reduce, type_array, dim_array, stitch_attr, true, Map<std::string, NodeRef>());
+  ASSERT_TRUE(attr.attrs.count("enable_atomic_add"));
+  EXPECT_ANY_THROW(GetIRAttr(StitchOpType::Reduce2D_X, reduce, type_array, dim_array, stitch_attr, false,
+                             Map<std::string, NodeRef>()));
+}
+}  // namespace akg
@@ -0,0 +1,159 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir_pass.h>
+#include <tvm/lowered_func.h>
+#include "gtest/gtest.h"
+#include "base/expr_builder.h"
+#include "codegen/codegen_cuda.h"
+#include "poly/gpu_emit/emit_pass.h"
+
+namespace akg {
+namespace {
+constexpr int FRAG = 16;
+constexpr int COLS = 64;
+
+Expr AddressOf(const Expr &elem) { return Call::make(air::Handle(), "&", {elem}, Call::Extern); }
+
+Expr FragmentElem(int index) { return Call::make(air::Float(32), "akg_fragment_elem", {index}, Call::Extern); }
+
+/* buffer_bind_scope(C_local)
+ *   tvm_store_matrix_sync(C_local, 16, 16, 8, 0, &C_shared(wm * 16, wn * 16), 64, "row_major")
+ * for (i, 0, 16)
+ *   for (j, 0, 16)
+ *     out(wm * 16 + i, wn * 16 + j) = C_shared(wm * 16 + i, wn * 16 + j) + operand
+ */
+struct MatmulEpilogue {
+  air::Operation shared = UTExprBuilder::PlaceholderOpNode("C_shared", {COLS, COLS}, air::Float(32));
+  air::Operation out = UTExprBuilder::PlaceholderOpNode("out", {COLS, COLS}, air::Float(32));
+  air::Operation bias = UTExprBuilder::PlaceholderOpNode("bias", {COLS}, air::Float(32));
+  air::Operation scale = UTExprBuilder::PlaceholderOpNode("scale", {COLS}, air::Float(32));
+  VarExpr frag{"C_local", air::Handle()};
+  VarExpr wm{"wm"};
+  VarExpr wn{"wn"};
+  VarExpr i{"i"};
+  VarExpr j{"j"};
+
+  Array<Expr> Origin() const { return {wm * FRAG, wn * FRAG}; }
+
+  Array<Expr> Index() const { return {wm * FRAG + i, wn * FRAG + j}; }
+
+  Stmt Make(const Expr &operand) const {
+    Buffer buffer = air::BufferNode::make(frag, air::Float(32), {FRAG, FRAG}, {}, 0, "C_local", "wmma.accumulator", 0,
+                                          0, air::kDefault);
+    Expr dst = AddressOf(Call::make(air::Float(32), "C_shared", Origin(), Call::Halide, shared, 0));
+    Stmt store = Evaluate::make(Call::make(air::Handle(), air::ir::intrinsic::tvm_store_matrix_sync,
+                                           {frag, FRAG, FRAG, 8, 0, dst, COLS, StringImm::make("row_major")},
+                                           Call::Intrinsic));
+    Expr tuple = Call::make(air::Handle(), air::ir::intrinsic::tvm_tuple, {0, FRAG, 0, FRAG}, Call::Intrinsic);
+    Array<NodeRef> bind{buffer, UTExprBuilder::CreateTensorByPlaceholder(shared)};
+    store = AttrStmt::make(bind, air::ir::attr::buffer_bind_scope, tuple, store);
+
+    Expr read = Call::make(air::Float(32), "C_shared", Index(), Call::Halide, shared, 0);
+    Stmt loops = Provide::make(out, 0, read + operand, Index());
+    loops = For::make(j, 0, FRAG, ForType::Serial, DeviceAPI::None, loops);
+    loops = For::make(i, 0, FRAG, ForType::Serial, DeviceAPI::None, loops);
+    return air::ir::Block::make(store, loops);
+  }
+
+  Stmt Fuse(const Stmt &stmt) const {
+    ir::poly::TensorCoreInfo info;
+    info.wmma_scope_ = "nvcuda";
+    return ir::poly::FragmentEpilogueFusion(stmt, info);
+  }
+};
+
+const Call *FindEpilogue(const Stmt &stmt) {
+  const Call *epilogue = nullptr;
+  air::ir::PostOrderVisit(stmt, [&epilogue](const NodeRef &node) {
+    auto call = node.as<Call>();
+    if (call != nullptr && call->name == "akg_fragment_epilogue") {
+      epilogue = call;
+    }
+  });
+  return epilogue;
+}
+
+bool HasProvide(const Stmt &stmt) {
+  bool found = false;
+  air::ir::PostOrderVisit(stmt, [&found](const NodeRef &node) { found = found || node.as<Provide>() != nullptr; });
+  return found;
+}
+}  // namespace
+
+// a bias broadcast along the rows is loaded at the columns of the fragment with a zero leading dimension.
+TEST(TestGpuMmaEpilogue, BiasBroadcast) {
+  MatmulEpilogue mm;
+  Expr bias = Call::make(air::Float(32), "bias", {mm.wn * FRAG + mm.j}, Call::Halide, mm.bias, 0);
+  Stmt stmt = mm.Fuse(mm.Make(bias));
+  EXPECT_FALSE(HasProvide(stmt));
+  const Call *epilogue = FindEpilogue(stmt);
+  ASSERT_NE(epilogue, nullptr);
+  ASSERT_EQ(epilogue->args.size(), 10U);
+  EXPECT_TRUE(air::ir::Equal(epilogue->args[5], FragmentElem(0) + FragmentElem(1)));
+  Expr out = Call::make(air::Float(32), "out", mm.Origin(), Call::Halide, mm.out, 0);
+  EXPECT_TRUE(air::ir::Equal(epilogue->args[6], AddressOf(out)));
+  EXPECT_TRUE(air::is_const_int(epilogue->args[7], COLS));
+  Expr bias_origin = Call::make(air::Float(32), "bias", {mm.wn * FRAG}, Call::Halide, mm.bias, 0);
+  EXPECT_TRUE(air::ir::Equal(epilogue->args[8], AddressOf(bias_origin)));
+  EXPECT_TRUE(air::is_const_int(epilogue->args[9], 0));
+}
+
+// an operand broadcast along the columns changes along the row of the fragment, it can not be loaded as a fragment.
+TEST(TestGpuMmaEpilogue, ColumnBroadcastNotFused) {
+  MatmulEpilogue mm;
+  Expr scale = Call::make(air::Float(32), "scale", {mm.wm * FRAG + mm.i}, Call::Halide, mm.scale, 0);
+  Stmt stmt = mm.Make(scale);
+  Stmt res = mm.Fuse(stmt);
+  EXPECT_TRUE(res.same_as(stmt));
+  EXPECT_EQ(FindEpilogue(res), nullptr);
+}
+
+// the generated CUDA loads the bias with a zero leading dimension and stores the accumulator to the output.
+TEST(TestGpuMmaEpilogue, CodegenCuda) {
+  VarExpr acc("acc", air::Handle());
+  VarExpr out("out", air::Handle());
+  VarExpr bias("bias", air::Handle());
+  auto address = [](const VarExpr &buf) {
+    return AddressOf(air::ir::Load::make(air::Float(32), buf, FRAG, air::const_true()));
+  };
+  Stmt body = Evaluate::make(Call::make(
+    air::Float(32), "akg_fragment_epilogue",
+    {acc, 0, FRAG, FRAG, 8, FragmentElem(0) + FragmentElem(1), address(out), COLS, address(bias), 0}, Call::Extern));
+  body = AttrStmt::make(Expr("INFO"), "wmma_scope", StringImm::make("nvcuda"), body);
+
+  auto func = air::make_node<air::LoweredFuncNode>();
+  func->name = "epilogue";
+  func->args = {acc, out, bias};
+  func->handle_data_type = {{acc, air::make_zero(air::Float(32))},
+                            {out, air::make_zero(air::Float(32))},
+                            {bias, air::make_zero(air::Float(32))}};
+  func->func_type = air::kDeviceFunc;
+  func->body = body;
+  air::codegen::CodeGenCUDA cg;
+  cg.Init(false);
+  cg.AddFunction(air::LoweredFunc(func));
+  std::string code = cg.Finish();
+
+  EXPECT_NE(code.find("auto akg_acc = acc[0];"), std::string::npos);
+  EXPECT_NE(code.find("auto akg_epi_1 = akg_acc;"), std::string::npos);
+  EXPECT_NE(code.find("nvcuda::wmma::load_matrix_sync(akg_epi_1, &(bias[16]), 0, nvcuda::wmma::mem_row_major);"),
+            std::string::npos);
+  EXPECT_NE(code.find("akg_acc.x[akg_e] = (akg_acc.x[akg_e] + akg_epi_1.x[akg_e]);"), std::string::npos);
+  EXPECT_NE(code.find("nvcuda::wmma::store_matrix_sync(&(out[16]), akg_acc, 64, nvcuda::wmma::mem_row_major);"),
+            std::string::npos);
+}
+}  // namespace akg
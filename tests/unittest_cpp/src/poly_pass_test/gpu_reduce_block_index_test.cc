@@ -0,0 +1,118 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir_pass.h>
+#include "gtest/gtest.h"
+#include "poly/gpu_isl_emitter.h"
+
+namespace akg {
+namespace {
+struct BlockDims {
+  VarExpr bz{"blockIdx.z"};
+  VarExpr by{"blockIdx.y"};
+  VarExpr bx{"blockIdx.x"};
+
+  std::vector<std::pair<VarExpr, int>> Extents(int z, int y, int x) const { return {{bz, z}, {by, y}, {bx, x}}; }
+};
+
+ir::poly::UserConfig CudaConfig(const Map<std::string, NodeRef> &attrs) {
+  ir::poly::UserConfig config;
+  config.SetTarget("cuda");
+  config.SetAttrs(attrs);
+  return config;
+}
+}  // namespace
+
+// blockIdx.x selects the output element, the 4 blocks along blockIdx.y reduce into it.
+TEST(TestGpuReduceBlockIndex, UnusedBlockDim) {
+  BlockDims dims;
+  VarExpr tx("threadIdx.x");
+  Expr block_idx;
+  int64_t reduce_blocks = 0;
+  EXPECT_TRUE(ir::poly::MakeReduceBlockIndex({dims.bx * 32 + tx}, {}, dims.Extents(1, 4, 8), &block_idx,
+                                             &reduce_blocks));
+  EXPECT_EQ(reduce_blocks, 4);
+  EXPECT_TRUE(air::ir::Equal(block_idx, dims.by));
+}
+
+// the output index reads blockIdx.x through the bounds of its loop.
+TEST(TestGpuReduceBlockIndex, UsedThroughLoopBound) {
+  BlockDims dims;
+  VarExpr cc("cc");
+  std::unordered_map<const Variable *, Expr> bounds{{cc.get(), dims.bx * 32}};
+  Expr block_idx;
+  int64_t reduce_blocks = 0;
+  EXPECT_TRUE(ir::poly::MakeReduceBlockIndex({cc}, bounds, dims.Extents(2, 4, 8), &block_idx, &reduce_blocks));
+  EXPECT_EQ(reduce_blocks, 8);
+  EXPECT_TRUE(air::ir::Equal(block_idx, air::ir::Simplify(dims.bz * 4 + dims.by)));
+}
+
+TEST(TestGpuReduceBlockIndex, WholeReduction) {
+  BlockDims dims;
+  VarExpr tx("threadIdx.x");
+  Expr block_idx;
+  int64_t reduce_blocks = 0;
+  EXPECT_TRUE(ir::poly::MakeReduceBlockIndex({tx}, {}, dims.Extents(1, 1, 16), &block_idx, &reduce_blocks));
+  EXPECT_EQ(reduce_blocks, 16);
+  EXPECT_TRUE(air::ir::Equal(block_idx, dims.bx));
+}
+
+// blockIdx.x runs over 8 outputs of 4 reduce blocks each, its blocks can not be numbered per output element.
+TEST(TestGpuReduceBlockIndex, MixedBlockDim) {
+  BlockDims dims;
+  Expr block_idx;
+  int64_t reduce_blocks = 0;
+  EXPECT_FALSE(ir::poly::MakeReduceBlockIndex({air::floordiv(dims.bx, 4)}, {}, dims.Extents(1, 1, 32), &block_idx,
+                                              &reduce_blocks));
+  EXPECT_FALSE(ir::poly::MakeReduceBlockIndex({air::floormod(dims.bx, 8)}, {}, dims.Extents(1, 1, 32), &block_idx,
+                                              &reduce_blocks));
+  VarExpr cc("cc");
+  std::unordered_map<const Variable *, Expr> bounds{{cc.get(), air::floordiv(dims.by, 2) * 16}};
+  EXPECT_FALSE(ir::poly::MakeReduceBlockIndex({cc}, bounds, dims.Extents(1, 4, 8), &block_idx, &reduce_blocks));
+}
+
+// a folded block dim of extent 1 selects nothing.
+TEST(TestGpuReduceBlockIndex, FoldedUnitBlockDim) {
+  BlockDims dims;
+  Expr block_idx;
+  int64_t reduce_blocks = 0;
+  EXPECT_TRUE(ir::poly::MakeReduceBlockIndex({air::floordiv(dims.bx, 4)}, {}, dims.Extents(1, 2, 1), &block_idx,
+                                             &reduce_blocks));
+  EXPECT_EQ(reduce_blocks, 2);
+  EXPECT_TRUE(air::ir::Equal(block_idx, dims.by));
+}
+
+TEST(TestGpuDeterministicReduce, SupportedConfig) {
+  ir::poly::UserConfig config = CudaConfig({{"enable_deterministic_reduce", Expr(1)}});
+  EXPECT_TRUE(config.GetEnableDeterministicReduce());
+  EXPECT_FALSE(config.GetEnableAtomicAdd());
+}
+
+// without the deterministic return the reduction only spans blocks with atomic add, as tiling and mapping read it.
+TEST(TestGpuDeterministicReduce, UnsupportedConfigFallsBack) {
+  ir::poly::UserConfig paris = CudaConfig({{"enable_deterministic_reduce", Expr(1)},
+                                           {"reduce_lib_type", StringImm::make("paris")}});
+  EXPECT_FALSE(paris.GetEnableDeterministicReduce());
+  EXPECT_FALSE(paris.GetEnableAtomicAdd());
+  ir::poly::UserConfig tile_c0 = CudaConfig({{"enable_deterministic_reduce", Expr(1)}, {"enable_tile_c0", Expr(1)}});
+  EXPECT_FALSE(tile_c0.GetEnableDeterministicReduce());
+  ir::poly::UserConfig atomic = CudaConfig({{"enable_deterministic_reduce", Expr(1)},
+                                            {"enable_tile_c0", Expr(1)},
+                                            {"enable_atomic_add", Expr(1)}});
+  EXPECT_FALSE(atomic.GetEnableDeterministicReduce());
+  EXPECT_TRUE(atomic.GetEnableAtomicAdd());
+}
+}  // namespace akg
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir_pass.h>
+#include "gtest/gtest.h"
+#include "base/expr_builder.h"
+#include "poly/gpu_isl_emitter.h"
+
+namespace akg {
+namespace {
+constexpr int ROWS = 32;
+constexpr int COLS = 64;
+constexpr int VECTOR = 4;
+
+/* thread_extent(threadIdx.x, 16)
+ * for (row, 0, 32)
+ *   for (v, 0, 4)
+ *     S(row, threadIdx.x * 4 + v) = A(row, threadIdx.x * 4 + v)
+ */
+struct SharedCopy {
+  air::Operation shared = UTExprBuilder::PlaceholderOpNode("S", {ROWS, COLS}, air::Float(32));
+  air::Operation global = UTExprBuilder::PlaceholderOpNode("A", {ROWS, COLS}, air::Float(32));
+  VarExpr row{"row"};
+  VarExpr v{"v"};
+  air::IterVar tx = air::IterVarNode::make(air::Range(0, COLS / VECTOR), VarExpr("threadIdx.x"),
+                                           air::IterVarType::kThreadIndex, "threadIdx.x");
+
+  Stmt Make(const Stmt &body) const {
+    Stmt loops = For::make(v, 0, VECTOR, ForType::Serial, DeviceAPI::None, body);
+    loops = For::make(row, 0, ROWS, ForType::Serial, DeviceAPI::None, loops);
+    return AttrStmt::make(tx, air::ir::attr::thread_extent, COLS / VECTOR, loops);
+  }
+
+  Array<Expr> Index() const { return {row, tx->var * VECTOR + v}; }
+
+  Stmt Copy() const {
+    Expr value = Call::make(air::Float(32), "A", Index(), Call::Halide, global, 0);
+    return Make(Provide::make(shared, 0, value, Index()));
+  }
+};
+
+const Provide *FindProvide(const Stmt &stmt) {
+  const Provide *provide = nullptr;
+  air::ir::PostOrderVisit(stmt, [&provide](const NodeRef &node) {
+    if (node.as<Provide>() != nullptr) {
+      provide = node.as<Provide>();
+    }
+  });
+  return provide;
+}
+}  // namespace
+
+// the groups of 4 words of a row are permuted by the row index, the lane of the vector stays an addend.
+TEST(TestGpuSharedSwizzle, VectorGroup) {
+  SharedCopy copy;
+  Stmt stmt = copy.Copy();
+  ASSERT_TRUE(ir::poly::SwizzleSharedTensor(copy.shared, 0, VECTOR, 1, &stmt));
+  const Provide *provide = FindProvide(stmt);
+  ASSERT_NE(provide, nullptr);
+  ASSERT_EQ(provide->args.size(), 2U);
+  EXPECT_TRUE(air::ir::Equal(provide->args[0], copy.row));
+  Expr inner = provide->args[1];
+  const auto add = inner.as<air::ir::Add>();
+  ASSERT_NE(add, nullptr);
+  EXPECT_TRUE(air::ir::Equal(add->b, copy.v));
+  EXPECT_FALSE(air::ir::ExprUseVar(add->a, copy.v));
+  // the group index threadIdx.x is xor-ed with the row, modulo the 8 groups of a row of banks
+  const auto mul = add->a.as<air::ir::Mul>();
+  ASSERT_NE(mul, nullptr);
+  EXPECT_TRUE(air::is_const_int(mul->b, VECTOR));
+  const auto group = mul->a.as<Call>();
+  ASSERT_NE(group, nullptr);
+  EXPECT_TRUE(group->is_intrinsic(Call::bitwise_xor));
+  EXPECT_TRUE(air::ir::Equal(group->args[0], copy.tx->var));
+  EXPECT_TRUE(air::ir::ExprUseVar(group->args[1], copy.row));
+}
+
+// the reads of the shared tensor are swizzled the same way as its writes.
+TEST(TestGpuSharedSwizzle, ReadAndWrite) {
+  SharedCopy copy;
+  Expr read = Call::make(air::Float(32), "S", copy.Index(), Call::Halide, copy.shared, 0);
+  Stmt stmt = copy.Make(Provide::make(copy.global, 0, read, copy.Index()));
+  ASSERT_TRUE(ir::poly::SwizzleSharedTensor(copy.shared, 0, VECTOR, 1, &stmt));
+  Stmt copied = copy.Copy();
+  ASSERT_TRUE(ir::poly::SwizzleSharedTensor(copy.shared, 0, VECTOR, 1, &copied));
+  const Provide *provide = FindProvide(stmt);
+  ASSERT_NE(provide, nullptr);
+  const auto call = provide->value.as<Call>();
+  ASSERT_NE(call, nullptr);
+  EXPECT_TRUE(air::ir::Equal(call->args[1], FindProvide(copied)->args[1]));
+}
+
+// a call that takes the address of the shared tensor reads it linearly, the layout is kept.
+TEST(TestGpuSharedSwizzle, PointerPassedToCall) {
+  SharedCopy copy;
+  Expr elem = Call::make(air::Float(32), "S", {0, 0}, Call::Halide, copy.shared, 0);
+  Expr address = Call::make(air::Handle(), air::ir::intrinsic::tvm_address_of, {elem}, Call::PureIntrinsic);
+  Stmt reduce = Evaluate::make(Call::make(air::Int(32), "akg_reduce::AkgReduce", {address}, Call::Extern));
+  Stmt stmt = air::ir::Block::make(copy.Copy(), reduce);
+  Stmt origin = stmt;
+  EXPECT_FALSE(ir::poly::SwizzleSharedTensor(copy.shared, 0, VECTOR, 1, &stmt));
+  EXPECT_TRUE(stmt.same_as(origin));
+}
+}  // namespace akg
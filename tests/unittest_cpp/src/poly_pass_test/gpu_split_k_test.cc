@@ -0,0 +1,59 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "poly/tiling/tiling_strategy_manager.h"
+
+namespace akg {
+namespace {
+constexpr int64_t V100_SM_COUNT = 80;
+constexpr int64_t T4_SM_COUNT = 40;
+
+int64_t KTiles(int64_t k) {
+  return (k + ir::poly::GemmStrategy::BLOCK_TILE - 1) / ir::poly::GemmStrategy::BLOCK_TILE;
+}
+}  // namespace
+
+// a 64 x 64 output is one block, the 128 k tiles are shared by as many blocks as keep 4 k tiles each.
+TEST(TestGpuSplitK, SkinnyMatmulLargeK) {
+  int64_t split_k = ir::poly::GemmStrategy::SplitKFactor(1, 64, 64, 8192, V100_SM_COUNT, 0);
+  EXPECT_EQ(split_k, 32);
+  EXPECT_EQ(KTiles(8192) % split_k, 0);
+  EXPECT_GE(KTiles(8192) / split_k, ir::poly::GemmStrategy::MIN_K_TILES_PER_SPLIT);
+}
+
+// the split fills the streaming multiprocessors of the target, so it follows sm_count.
+TEST(TestGpuSplitK, FollowSmCount) {
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 128, 128, 8192, V100_SM_COUNT, 0), 16);
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 128, 128, 8192, T4_SM_COUNT, 0), 8);
+}
+
+TEST(TestGpuSplitK, NoSplit) {
+  // the m and n tiles already occupy every streaming multiprocessor
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 1024, 1024, 8192, V100_SM_COUNT, 0), 1);
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(80, 64, 64, 8192, V100_SM_COUNT, 0), 1);
+  // 7 k tiles can not give two splits of 4 k tiles
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 64, 64, 448, V100_SM_COUNT, 0), 1);
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 64, 64, 512, V100_SM_COUNT, 0), 2);
+}
+
+// a requested split is kept to a divisor of the k tiles, so every block reads the same number of k tiles.
+TEST(TestGpuSplitK, RequestedSplit) {
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 1024, 1024, 8192, V100_SM_COUNT, 4), 4);
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 64, 64, 8192, V100_SM_COUNT, 6), 4);
+  EXPECT_EQ(ir::poly::GemmStrategy::SplitKFactor(1, 64, 64, 128, V100_SM_COUNT, 8), 2);
+}
+}  // namespace akg
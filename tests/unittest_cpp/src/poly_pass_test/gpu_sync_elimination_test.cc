@@ -0,0 +1,116 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir_pass.h>
+#include "gtest/gtest.h"
+#include "base/expr_builder.h"
+#include "poly/gpu_isl_emitter.h"
+
+namespace akg {
+namespace {
+constexpr int THREADS = 32;
+
+struct Kernel {
+  air::Operation in = UTExprBuilder::PlaceholderOpNode("in", {THREADS}, air::Float(32));
+  air::Operation in2 = UTExprBuilder::PlaceholderOpNode("in2", {THREADS}, air::Float(32));
+  air::Operation shared = UTExprBuilder::PlaceholderOpNode("A_shared", {THREADS + 1}, air::Float(32));
+  air::Operation out = UTExprBuilder::PlaceholderOpNode("out", {THREADS}, air::Float(32));
+  VarExpr tx{"threadIdx.x"};
+
+  static Expr Read(const air::Operation &op, const Expr &index) {
+    return Call::make(air::Float(32), op->name, {index}, Call::Halide, op, 0);
+  }
+
+  // A_shared(tx) = in(tx)
+  Stmt WriteShared() const { return Provide::make(shared, 0, Read(in, tx), {tx}); }
+
+  // out(tx) = A_shared(tx + 1), the element written by the next thread
+  Stmt ReadShared() const { return Provide::make(out, 0, Read(shared, tx + 1), {tx}); }
+
+  // out(tx) = in2(tx)
+  Stmt ReadInput() const { return Provide::make(out, 0, Read(in2, tx), {tx}); }
+};
+
+Stmt BlockSync() {
+  return Evaluate::make(
+    Call::make(Int(32), ir::STORAGE_SYNC, {StringImm::make(ir::SYNC_SCOP_SHARED)}, Call::Intrinsic));
+}
+
+Stmt WarpSync() { return Evaluate::make(Call::make(Int(32), ir::WARP_SYNC, {}, Call::Extern)); }
+
+int CountCalls(const Stmt &stmt, const std::string &name) {
+  int count = 0;
+  air::ir::PostOrderVisit(stmt, [&count, &name](const NodeRef &node) {
+    auto call = node.as<Call>();
+    if (call != nullptr && call->name == name) {
+      ++count;
+    }
+  });
+  return count;
+}
+
+int CountBlockSyncs(const Stmt &stmt) { return CountCalls(stmt, ir::STORAGE_SYNC); }
+
+int CountWarpSyncs(const Stmt &stmt) { return CountCalls(stmt, ir::WARP_SYNC); }
+}  // namespace
+
+// the sync orders the write of A_shared before the read of the next thread.
+TEST(TestGpuSyncElimination, KeepConflictingSync) {
+  Kernel k;
+  Stmt stmt = air::ir::Block::make({k.WriteShared(), BlockSync(), k.ReadShared()});
+  EXPECT_EQ(CountBlockSyncs(ir::poly::EliminateSyncs(stmt)), 1);
+}
+
+// nothing after the sync touches A_shared.
+TEST(TestGpuSyncElimination, RemoveSyncWithoutConflict) {
+  Kernel k;
+  Stmt stmt = air::ir::Block::make({k.WriteShared(), BlockSync(), k.ReadInput()});
+  Stmt res = ir::poly::EliminateSyncs(stmt);
+  EXPECT_EQ(CountBlockSyncs(res), 0);
+  EXPECT_TRUE(air::ir::Equal(res, air::ir::Block::make(k.WriteShared(), k.ReadInput())));
+}
+
+// the sync at the end of the loop body orders the read of one iteration before the write of the next one.
+TEST(TestGpuSyncElimination, KeepLoopCarriedSync) {
+  Kernel k;
+  Stmt body = air::ir::Block::make({k.WriteShared(), BlockSync(), k.ReadShared(), BlockSync()});
+  VarExpr i("i");
+  Stmt loop = For::make(i, 0, 4, ForType::Serial, DeviceAPI::None, body);
+  EXPECT_EQ(CountBlockSyncs(ir::poly::EliminateSyncs(loop)), 2);
+
+  // without the loop nothing follows the last sync.
+  EXPECT_EQ(CountBlockSyncs(ir::poly::EliminateSyncs(body)), 1);
+}
+
+TEST(TestGpuSyncElimination, WarpSync) {
+  Kernel k;
+  Stmt stmt = air::ir::Block::make({k.WriteShared(), WarpSync(), k.ReadShared()});
+  Stmt res = ir::poly::EliminateSyncs(stmt);
+  EXPECT_EQ(CountWarpSyncs(res), 1);
+
+  // the block sync right before already orders the warp.
+  stmt = air::ir::Block::make({k.WriteShared(), BlockSync(), WarpSync(), k.ReadShared()});
+  res = ir::poly::EliminateSyncs(stmt);
+  EXPECT_EQ(CountBlockSyncs(res), 1);
+  EXPECT_EQ(CountWarpSyncs(res), 0);
+
+  // a warp sync does not end the accesses a block sync orders.
+  stmt = air::ir::Block::make({k.WriteShared(), WarpSync(), k.ReadInput(), BlockSync(), k.ReadShared()});
+  res = ir::poly::EliminateSyncs(stmt);
+  EXPECT_EQ(CountWarpSyncs(res), 0);
+  EXPECT_EQ(CountBlockSyncs(res), 1);
+}
+}  // namespace akg
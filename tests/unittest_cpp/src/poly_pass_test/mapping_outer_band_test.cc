@@ -48,4 +48,49 @@ TEST(TestMappingOuterBand, TestCase1) {
 
   EXPECT_TRUE(SCH_EQUAL(input_sch, expect_ouput_sch));
 }
+
+TEST(TestMappingOuterBand, CountWarpSectors) {
+  const int64_t uncoalesced = 1 << 16;
+  EXPECT_EQ(ir::poly::CountWarpSectors({1, 32}, {32, 8}, 4), 4);
+  EXPECT_EQ(ir::poly::CountWarpSectors({32, 1}, {32, 8}, 4), 32);
+  EXPECT_EQ(ir::poly::CountWarpSectors({0, 0}, {32, 8}, 4), 1);
+  EXPECT_EQ(ir::poly::CountWarpSectors({1, 64}, {8, 32}, 4), 4);
+  EXPECT_EQ(ir::poly::CountWarpSectors({uncoalesced, 1}, {4, 8}, 2), 4);
+}
+
+TEST(TestMappingOuterBand, CoalescedThreadOrder) {
+  // B[j, i] = A[j, i], the innermost band member j walks the outermost tensor dim.
+  std::string input_str =
+    "{ domain: \"{ S_0[i, j] : 0 <= i <= 1023 and 0 <= j <= 1023 }\", child: { "
+    "schedule: \"[{ S_0[i, j] -> [(floor((i)/32))] }, { S_0[i, j] -> [(floor((j)/32))] }]\", "
+    "permutable: 1, coincident: [ 1, 1 ], child: { "
+    "schedule: \"[{ S_0[i, j] -> [((i) mod 32)] }, { S_0[i, j] -> [((j) mod 32)] }]\", "
+    "permutable: 1, coincident: [ 1, 1 ] } } }";
+  isl_schedule *in_ss = isl_schedule_read_from_str(isl_ctx_alloc(), input_str.c_str());
+  CHECK(in_ss != nullptr) << "fail to read string";
+  isl::schedule input_sch = isl::manage(in_ss);
+
+  auto test_ctx = input_sch.ctx();
+  ir::poly::ScopInfo scop_info(test_ctx);
+  scop_info.user_config_.SetBlockConfig("32 32");
+  scop_info.user_config_.SetThreadConfig("32 8");
+  scop_info.user_config_.SetEnableCoalescedThreadOrder(true);
+  scop_info.analysis_result_.RecordReads(isl::union_map(test_ctx, "{ [S_0[i, j] -> __poly_ref_1[]] -> A[j, i] }"));
+  scop_info.analysis_result_.RecordWrites(isl::union_map(test_ctx, "{ [S_0[i, j] -> __poly_ref_0[]] -> B[j, i] }"));
+  ir::poly::PassInfo pass_info;
+
+  input_sch = ir::poly::MappingOuterBand(pass_info, scop_info).Run(input_sch);
+
+  auto decisions = scop_info.analysis_result_.GetThreadOrderDecisions();
+  ASSERT_EQ(decisions.size(), 1U);
+  auto decision = decisions[0];
+  ASSERT_EQ(decision.orders.size(), 2U);
+  // the default order maps j to threadIdx.x, every lane of a warp touches its own sector.
+  EXPECT_EQ(decision.orders[0], std::vector<int>({1, 0}));
+  EXPECT_EQ(decision.transactions[0], 512);
+  // i goes to threadIdx.x instead, a warp reads one contiguous sector of each tensor.
+  EXPECT_EQ(decision.best, 1U);
+  EXPECT_EQ(decision.orders[1], std::vector<int>({0, 1}));
+  EXPECT_EQ(decision.transactions[1], 16);
+}
 }  // namespace akg
@@ -0,0 +1,153 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "poly/tiling/tiling_cost_model.h"
+
+namespace akg {
+namespace {
+constexpr int64_t CORE_NUM = 32;
+constexpr int64_t FP16_BYTES = 2;
+constexpr int64_t FP32_BYTES = 4;
+// half of the 256KB UB, the rest is left to double buffer
+constexpr int64_t UB_LIMIT = 128 * 1024;
+// half of the 64KB L0A and L0B
+constexpr int64_t L0_LIMIT = 32 * 1024;
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// tile of rows x cols of a row major [height, width] elementwise kernel reading `inputs` tensors
+ir::poly::NpuTileFeature ElemwiseFeature(int64_t height, int64_t width, int64_t rows, int64_t cols, int64_t inputs,
+                                         int64_t dtype_bytes) {
+  int64_t tile_bytes = rows * cols * dtype_bytes;
+  int64_t run = cols == width ? tile_bytes : cols * dtype_bytes;
+  int64_t tile_count = CeilDiv(height, rows) * CeilDiv(width, cols);
+  return ir::poly::NpuTileFeature{tile_count, CORE_NUM, inputs * tile_bytes, tile_bytes, run, 0, tile_bytes, run, 0,
+                                  true};
+}
+
+// tile of m x n x k of a [m, k] x [k, n] fp16 matmul with fp32 accumulation
+ir::poly::NpuTileFeature MatmulFeature(int64_t size, int64_t m, int64_t n, int64_t k) {
+  int64_t operand_bytes = (m * k + k * n) * FP16_BYTES;
+  // the result is written out once all the k tiles are accumulated
+  int64_t out_bytes = m * n * FP32_BYTES * k / size;
+  int64_t run = std::min(k, n) * FP16_BYTES;
+  int64_t tile_count = CeilDiv(size, m) * CeilDiv(size, n) * CeilDiv(size, k);
+  return ir::poly::NpuTileFeature{tile_count, CORE_NUM, operand_bytes, out_bytes, run, operand_bytes, 0, 0, m * n * k,
+                                  true};
+}
+
+size_t ChooseByCost(const std::vector<ir::poly::NpuTileFeature> &features) {
+  ir::poly::NpuCostModel cost_model;
+  size_t best = 0;
+  for (size_t i = 1; i < features.size(); ++i) {
+    if (cost_model.Estimate(features[i]) < cost_model.Estimate(features[best])) {
+      best = i;
+    }
+  }
+  return best;
+}
+}  // namespace
+
+TEST(TestNpuTilingCostModel, BurstAndRepeat) {
+  ir::poly::NpuCostModel cost_model;
+  // the same bytes in 32 byte bursts pay the burst latency 32 times more than in one burst
+  EXPECT_GT(cost_model.MteCycles(1024, 32), cost_model.MteCycles(1024, 1024) * 8);
+  // a 16 byte burst still moves a whole 32 byte block
+  EXPECT_DOUBLE_EQ(cost_model.MteCycles(512, 16), cost_model.MteCycles(1024, 32));
+  // one instruction repeats over 255 blocks of 256 bytes
+  EXPECT_LT(cost_model.VectorCycles(8192, 8192), cost_model.VectorCycles(8192, 256));
+  EXPECT_DOUBLE_EQ(cost_model.CubeCycles(16 * 16 * 16), 1.0);
+}
+
+// the largest rows that fit keep all the cores busy, the cost model agrees with the memory rule.
+TEST(TestNpuTilingCostModel, ElemwiseLargeShape) {
+  const int64_t height = 1024;
+  const int64_t width = 4096;
+  std::vector<int64_t> rows = {4, 2, 1};
+  std::vector<ir::poly::NpuTileFeature> features;
+  for (auto r : rows) {
+    ASSERT_LE(3 * r * width * FP16_BYTES, UB_LIMIT);
+    features.emplace_back(ElemwiseFeature(height, width, r, width, 2, FP16_BYTES));
+  }
+  EXPECT_EQ(rows[ChooseByCost(features)], 4);
+}
+
+// 64 rows in tiles of 4 rows occupy 16 of the 32 cores, smaller tiles are faster.
+TEST(TestNpuTilingCostModel, ElemwiseSmallShape) {
+  const int64_t height = 64;
+  const int64_t width = 4096;
+  std::vector<int64_t> rows = {4, 2, 1};
+  std::vector<ir::poly::NpuTileFeature> features;
+  for (auto r : rows) {
+    features.emplace_back(ElemwiseFeature(height, width, r, width, 2, FP16_BYTES));
+  }
+  auto chosen = rows[ChooseByCost(features)];
+  EXPECT_LT(chosen, 4);
+  EXPECT_GE(CeilDiv(height, chosen), CORE_NUM);
+  ir::poly::NpuCostModel cost_model;
+  EXPECT_LT(cost_model.Estimate(features[1]), cost_model.Estimate(features[0]) * 0.6);
+}
+
+// the memory rule tiles the outer axis first and cuts the reduce axis of [1024, 16] fp16 to 8 elements,
+// the cost model keeps the 32 byte rows at the same footprint.
+TEST(TestNpuTilingCostModel, ReduceInnerAxis) {
+  const int64_t height = 1024;
+  const int64_t width = 16;
+  std::vector<std::pair<int64_t, int64_t>> tiles = {{64, 8}, {32, 16}};
+  std::vector<ir::poly::NpuTileFeature> features;
+  for (const auto &t : tiles) {
+    auto feature = ElemwiseFeature(height, width, t.first, t.second, 1, FP16_BYTES);
+    feature.mte_out_bytes = t.first * FP16_BYTES;
+    features.emplace_back(feature);
+  }
+  EXPECT_EQ(features[0].tile_count, features[1].tile_count);
+  auto chosen = tiles[ChooseByCost(features)];
+  EXPECT_EQ(chosen.second * FP16_BYTES, 32);
+}
+
+// the memory rule gives the whole 1024 of k to one tile and leaves 16 x 16 to m and n, the cost model prefers a
+// balanced tile that reads longer bursts and reuses each operand more.
+TEST(TestNpuTilingCostModel, Matmul) {
+  const int64_t size = 1024;
+  std::vector<std::vector<int64_t>> tiles;
+  for (int64_t m = 16; m <= 256; m *= 2) {
+    for (int64_t n = 16; n <= 256; n *= 2) {
+      for (int64_t k = 16; k <= size; k *= 2) {
+        if (m * k * FP16_BYTES <= L0_LIMIT && k * n * FP16_BYTES <= L0_LIMIT && m * n * FP32_BYTES <= L0_LIMIT) {
+          tiles.push_back({m, n, k});
+        }
+      }
+    }
+  }
+  std::vector<ir::poly::NpuTileFeature> features;
+  size_t greedy = tiles.size();
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    features.emplace_back(MatmulFeature(size, tiles[i][0], tiles[i][1], tiles[i][2]));
+    if (tiles[i][0] == 16 && tiles[i][1] == 16 && tiles[i][2] == size) {
+      greedy = i;
+    }
+  }
+  ASSERT_LT(greedy, tiles.size());
+  auto chosen = ChooseByCost(features);
+  ir::poly::NpuCostModel cost_model;
+  EXPECT_LT(cost_model.Estimate(features[chosen]), cost_model.Estimate(features[greedy]));
+  EXPECT_LE(std::max(tiles[chosen][0], tiles[chosen][1]), 2 * std::min(tiles[chosen][0], tiles[chosen][1]));
+  EXPECT_GT(std::min(tiles[chosen][0], tiles[chosen][1]), 16);
+}
+}  // namespace akg
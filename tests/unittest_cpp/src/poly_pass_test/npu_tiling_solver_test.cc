@@ -0,0 +1,123 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+#include <tvm/operation.h>
+#include <tvm/schedule_pass.h>
+#include "gtest/gtest.h"
+#include "poly/isl_ctx_pool.h"
+#include "poly/scop.h"
+
+namespace akg {
+namespace {
+/*
+ * Runs the npu schedule passes on the kernel computing out and returns the tile sizes chosen by TraverseSolver,
+ * with or without the tiling cost model.
+ */
+ir::poly::TileSizes SolveTiling(const air::Tensor &out, const std::vector<air::Tensor> &inputs, bool cost_model) {
+  air::Schedule sch = air::create_schedule({out->op});
+  auto bounds = air::schedule::InferBound(sch);
+  Stmt stmt = air::schedule::ScheduleOps(sch, bounds, false);
+  Map<air::Tensor, air::Buffer> binds;
+  for (const auto &t : inputs) {
+    binds.Set(t, air::decl_buffer(t->shape, t->dtype, t->op->name));
+  }
+  binds.Set(out, air::decl_buffer(out->shape, out->dtype, out->op->name));
+  Map<std::string, NodeRef> attrs;
+  attrs.Set("enable_tiling_cost_model", IntImm::make(Int(32), cost_model ? 1 : 0));
+
+  ir::poly::TileSizes tile_sizes;
+  isl::ctx ctx = ir::poly::IslCtxPool::Local().Acquire();
+  {
+    ir::poly::Scop scop(stmt, ctx);
+    scop.ParseUserConfig("cce", attrs, binds, false, false, false, sch);
+    static_cast<void>(scop.Transform(scop.GenIsl()));
+    tile_sizes = scop.info_.analysis_result_.GetTileSizes();
+    scop.info_.user_config_.FreeReplaceConfig();
+  }
+  ir::poly::IslCtxPool::Local().Release(ctx);
+  return tile_sizes;
+}
+
+std::string DimString(const ir::poly::TileSizes &tile_sizes) {
+  std::string dim;
+  for (const auto &info : tile_sizes) {
+    dim += std::to_string(info.index) + " " + info.axis + " " + std::to_string(info.c1_tiling_size) + " " +
+           std::to_string(info.c0_tiling_size) + " ";
+  }
+  return dim;
+}
+
+/*
+ * The cost model only changes the factor of an axis, never which axes are tiled, and every factor stays within the
+ * extent of its axis. The factors depend on the core number of the product, so the current and the chosen ones are
+ * recorded as test properties rather than pinned.
+ */
+void CompareWithCurrentTiling(const air::Tensor &out, const std::vector<air::Tensor> &inputs,
+                              const std::vector<int64_t> &extents) {
+  auto current = SolveTiling(out, inputs, false);
+  auto chosen = SolveTiling(out, inputs, true);
+  ::testing::Test::RecordProperty("current_dim", DimString(current));
+  ::testing::Test::RecordProperty("cost_model_dim", DimString(chosen));
+  ASSERT_FALSE(current.empty());
+  ASSERT_EQ(chosen.size(), current.size());
+  for (size_t i = 0; i < chosen.size(); ++i) {
+    EXPECT_EQ(chosen[i].index, current[i].index);
+    EXPECT_EQ(chosen[i].axis, current[i].axis);
+    EXPECT_GE(chosen[i].c1_tiling_size, 1);
+    if (i < extents.size()) {
+      EXPECT_LE(chosen[i].c1_tiling_size, extents[i]) << "axis " << i;
+      EXPECT_LE(current[i].c1_tiling_size, extents[i]) << "axis " << i;
+    }
+  }
+  // the candidates are tried in a fixed order, so the choice does not change between runs.
+  EXPECT_EQ(DimString(SolveTiling(out, inputs, true)), DimString(chosen));
+}
+}  // namespace
+
+TEST(TestNpuTilingSolver, Elemwise) {
+  const int64_t height = 4096;
+  const int64_t width = 1024;
+  auto a = air::placeholder({Expr(height), Expr(width)}, Float(16), "input_a");
+  auto b = air::placeholder({Expr(height), Expr(width)}, Float(16), "input_b");
+  auto out = air::compute(
+    {Expr(height), Expr(width)}, [&a, &b](const Var &i, const Var &j) { return a(i, j) + b(i, j); }, "out");
+  CompareWithCurrentTiling(out, {a, b}, {height, width});
+}
+
+TEST(TestNpuTilingSolver, ReduceInnerAxis) {
+  const int64_t height = 1024;
+  const int64_t width = 2048;
+  auto a = air::placeholder({Expr(height), Expr(width)}, Float(32), "input_a");
+  auto k = air::reduce_axis(Range(0, Expr(width)), "k");
+  auto out = air::compute(
+    {Expr(height)}, [&a, &k](const Var &i) { return air::sum(a(i, k->var), {k}); }, "out");
+  CompareWithCurrentTiling(out, {a}, {height, width});
+}
+
+// a matmul written as a plain reduction, tiled for the vector unit.
+TEST(TestNpuTilingSolver, Matmul) {
+  const int64_t size = 256;
+  auto a = air::placeholder({Expr(size), Expr(size)}, Float(32), "input_a");
+  auto b = air::placeholder({Expr(size), Expr(size)}, Float(32), "input_b");
+  auto k = air::reduce_axis(Range(0, Expr(size)), "k");
+  auto out = air::compute(
+    {Expr(size), Expr(size)},
+    [&a, &b, &k](const Var &i, const Var &j) { return air::sum(a(i, k->var) * b(k->var, j), {k}); }, "out");
+  CompareWithCurrentTiling(out, {a, b}, {size, size, size});
+}
+}  // namespace akg
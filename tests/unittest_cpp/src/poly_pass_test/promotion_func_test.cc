@@ -16,6 +16,7 @@
 
 #include "gtest/gtest.h"
 #include "poly/schedule_tree_util.h"
+#include "poly/schedule_pass_gpu/shared_memory_manager.h"
 #include <vector>
 
 namespace akg {
@@ -38,4 +39,45 @@ TEST(TestPromotionFunc, TestCaseFilter) {
   EXPECT_EQ(expect_output, output);
 }
 
+TEST(TestPromotionFunc, TestCaseSelectPromotions) {
+  // first fit would spend the budget on the low reuse tensor that comes first.
+  std::vector<ir::poly::PromotionCandidate> candidates{{40000, 100}, {30000, 5000}, {16000, 4000}};
+  EXPECT_EQ(ir::poly::SelectPromotions(candidates, 49151), std::vector<size_t>({1, 2}));
+  EXPECT_EQ(ir::poly::SelectPromotions(candidates, 40000), std::vector<size_t>({1}));
+  EXPECT_EQ(ir::poly::SelectPromotions(candidates, 15999), std::vector<size_t>());
+
+  std::vector<ir::poly::PromotionCandidate> small{{8, 10}, {8, 10}, {16, 15}};
+  EXPECT_EQ(ir::poly::SelectPromotions(small, 16), std::vector<size_t>({0, 1}));
+  EXPECT_EQ(ir::poly::SelectPromotions({}, 16), std::vector<size_t>());
+}
+
+TEST(TestPromotionFunc, TestCasePlanPromotions) {
+  // the required reduce cluster comes first-fit, the knapsack then skips the low reuse cluster before the others.
+  std::vector<ir::poly::PromotionCandidate> clusters{{40000, 100}, {8192, 8192}, {20000, 5000}, {24000, 4000}};
+  std::vector<bool> required{false, true, false, false};
+  size_t remaining_memory = 49152;
+  EXPECT_EQ(ir::poly::PlanPromotions(clusters, required, &remaining_memory), std::vector<size_t>({1, 2}));
+  EXPECT_EQ(remaining_memory, 49152U - 8192U - 20000U);
+
+  // a required cluster that does not fit is dropped and leaves the memory to the others.
+  required = {true, false, false, false};
+  remaining_memory = 36000;
+  EXPECT_EQ(ir::poly::PlanPromotions(clusters, required, &remaining_memory), std::vector<size_t>({1, 2}));
+  EXPECT_EQ(remaining_memory, 36000U - 8192U - 20000U);
+}
+
+TEST(TestPromotionFunc, TestCaseSavedBlockAccesses) {
+  // C[i, j] += A[i, k] * B[k, j] with 32 x 32 blocks: a block reads its 32 x 1024 slice of A once for every j.
+  auto ctx = isl_ctx_alloc();
+  isl::union_map outer_schedule(ctx, "{ S_0[i, j, k] -> [floor(i / 32), floor(j / 32)] : "
+                                     "0 <= i <= 1023 and 0 <= j <= 1023 and 0 <= k <= 1023 }");
+  isl::union_map access(ctx, "{ S_0[i, j, k] -> A[i, k] : 0 <= i <= 1023 and 0 <= j <= 1023 and 0 <= k <= 1023 }");
+  EXPECT_EQ(ir::poly::SavedBlockAccesses(outer_schedule, access, 32 * 1024), 32 * 32 * 1024 - 32 * 1024);
+
+  // the instances of a block are unbounded along n.
+  isl::union_map param_schedule(ctx, "[n] -> { S_0[i, j] -> [floor(i / 32)] : 0 <= i <= 1023 and 0 <= j < n }");
+  isl::union_map param_access(ctx, "[n] -> { S_0[i, j] -> A[i] : 0 <= i <= 1023 and 0 <= j < n }");
+  EXPECT_EQ(ir::poly::SavedBlockAccesses(param_schedule, param_access, 32), 32);
+}
+
 }  // namespace akg
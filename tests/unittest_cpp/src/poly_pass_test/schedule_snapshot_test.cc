@@ -0,0 +1,180 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+#include "gtest/gtest.h"
+#include "base/schedule_tree_helper.h"
+#include "poly/dump_log.h"
+#include "poly/schedule_pass.h"
+#include "poly/schedule_pass_mgr.h"
+#include "poly/schedule_snapshot.h"
+
+namespace akg {
+namespace {
+double ElapsedMs(const std::chrono::high_resolution_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+size_t FileSize(const std::string &filename) {
+  std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+  return in.is_open() ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+// a fresh directory under TMPDIR, removed with the files the test names in it.
+class TempDir {
+ public:
+  TempDir() {
+    const char *tmp = std::getenv("TMPDIR");
+    std::string pattern = std::string(tmp != nullptr ? tmp : "/tmp") + "/akg_snapshot_XXXXXX";
+    std::vector<char> buf(pattern.begin(), pattern.end());
+    buf.push_back('\0');
+    CHECK(mkdtemp(buf.data()) != nullptr) << "failed to create a temp dir";
+    path_ = buf.data();
+  }
+  ~TempDir() {
+    for (const auto &file : files_) {
+      static_cast<void>(std::remove(file.c_str()));
+    }
+    static_cast<void>(rmdir(path_.c_str()));
+  }
+
+  const std::string &Path() const { return path_; }
+
+  std::string File(const std::string &name) {
+    files_.push_back(path_ + "/" + name);
+    return files_.back();
+  }
+
+ private:
+  std::string path_;
+  std::vector<std::string> files_;
+};
+
+// records the schedule it is run on.
+class RecordPass : public ir::poly::SchedulePass {
+ public:
+  explicit RecordPass(const std::string &name) { pass_name_ = name; }
+
+  isl::schedule Run(isl::schedule sch) override {
+    input = sch;
+    return sch;
+  }
+
+  isl::schedule input;
+};
+}  // namespace
+
+TEST(TestScheduleSnapshot, RoundTrip) {
+  isl::schedule input_schedule;
+  isl::schedule expect_schedule;
+  std::tie(input_schedule, expect_schedule) = ScheduleTreeHelper("reschedule_case").Prepare();
+
+  ir::poly::ScheduleSnapshot snapshot;
+  snapshot.schedule = input_schedule;
+  snapshot.reads = isl::union_map(input_schedule.ctx(), "{ S_34[ax0, ax1] -> input_0[ax0, ax1] : 0 <= ax0 <= 1023 }");
+  snapshot.transfer_stmt = isl::union_set(input_schedule.ctx(), "{ S_0[]; S_1[] }");
+
+  std::string data = ir::poly::SerializeScheduleSnapshot(snapshot);
+  ir::poly::ScheduleSnapshot loaded;
+  ASSERT_TRUE(ir::poly::DeserializeScheduleSnapshot(input_schedule.ctx(), data, loaded));
+  EXPECT_TRUE(SCH_EQUAL(loaded.schedule, input_schedule));
+  EXPECT_TRUE(loaded.reads.is_equal(snapshot.reads));
+  EXPECT_TRUE(loaded.transfer_stmt.is_equal(snapshot.transfer_stmt));
+  EXPECT_TRUE(loaded.writes.is_null());
+
+  EXPECT_FALSE(ir::poly::DeserializeScheduleSnapshot(input_schedule.ctx(), data.substr(0, data.size() / 2), loaded));
+  EXPECT_FALSE(ir::poly::DeserializeScheduleSnapshot(input_schedule.ctx(), "not a snapshot", loaded));
+}
+
+// a snapshot in the dump dir replaces the input schedule of the pass and the access relations it reads.
+TEST(TestScheduleSnapshot, LoadOverride) {
+  isl::schedule input_schedule;
+  isl::schedule expect_schedule;
+  std::tie(input_schedule, expect_schedule) = ScheduleTreeHelper("reschedule_case").Prepare();
+  TempDir dir;
+  ir::poly::ScheduleSnapshot snapshot;
+  snapshot.schedule = expect_schedule;
+  snapshot.reads = isl::union_map(input_schedule.ctx(), "{ S_34[ax0, ax1] -> input_0[ax0, ax1] : 0 <= ax0 <= 1023 }");
+  ASSERT_TRUE(ir::poly::DumpScheduleSnapshotToFile(dir.File(std::string("RecordPass") + ir::poly::SNAPSHOT_SUFFIX),
+                                                   snapshot));
+
+  ir::poly::ScopInfo scop_info(input_schedule.ctx());
+  Map<std::string, NodeRef> attrs;
+  attrs.Set("dump_poly_dir", StringImm::make(dir.Path()));
+  scop_info.user_config_.SetAttrs(attrs);
+  auto pass = std::make_shared<RecordPass>("RecordPass");
+  ir::poly::SchedulePassMgr mgr(scop_info);
+  static_cast<void>(mgr.Run(input_schedule, {pass}));
+  EXPECT_TRUE(SCH_EQUAL(pass->input, expect_schedule));
+  EXPECT_TRUE(scop_info.analysis_result_.GetReads().is_equal(snapshot.reads));
+  // relations missing from the snapshot are left as they were.
+  EXPECT_TRUE(scop_info.analysis_result_.GetWrites().is_null());
+}
+
+// compares the pretty printed text dumps of the schedule trees with the binary snapshots, the timings are recorded
+// as test properties.
+TEST(TestScheduleSnapshot, TextAndBinaryDumpTime) {
+  isl::schedule input_schedule;
+  isl::schedule expect_schedule;
+  std::tie(input_schedule, expect_schedule) = ScheduleTreeHelper("reschedule_case").Prepare();
+  TempDir dir;
+  const std::string text_file = dir.File("schedule_snapshot_bench.txt");
+  const std::string binary_file = dir.File(std::string("schedule_snapshot_bench") + ir::poly::SNAPSHOT_SUFFIX);
+  const int repeat = 20;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    std::ofstream of(text_file);
+    of << ir::poly::PrettyPrintSchTree(input_schedule);
+  }
+  double text_dump_ms = ElapsedMs(start);
+  start = std::chrono::high_resolution_clock::now();
+  isl::schedule text_schedule = input_schedule;
+  for (int i = 0; i < repeat; ++i) {
+    ASSERT_TRUE(ir::poly::LoadScheduleTreeFromFile(text_file, text_schedule));
+  }
+  double text_load_ms = ElapsedMs(start);
+
+  ir::poly::ScheduleSnapshot snapshot;
+  snapshot.schedule = input_schedule;
+  start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    ASSERT_TRUE(ir::poly::DumpScheduleSnapshotToFile(binary_file, snapshot));
+  }
+  double binary_dump_ms = ElapsedMs(start);
+  start = std::chrono::high_resolution_clock::now();
+  ir::poly::ScheduleSnapshot loaded;
+  for (int i = 0; i < repeat; ++i) {
+    ASSERT_TRUE(ir::poly::LoadScheduleSnapshotFromFile(binary_file, input_schedule.ctx(), loaded));
+  }
+  double binary_load_ms = ElapsedMs(start);
+
+  RecordProperty("text_bytes", static_cast<int>(FileSize(text_file)));
+  RecordProperty("text_dump_us", static_cast<int>(text_dump_ms * 1000 / repeat));
+  RecordProperty("text_load_us", static_cast<int>(text_load_ms * 1000 / repeat));
+  RecordProperty("binary_bytes", static_cast<int>(FileSize(binary_file)));
+  RecordProperty("binary_dump_us", static_cast<int>(binary_dump_ms * 1000 / repeat));
+  RecordProperty("binary_load_us", static_cast<int>(binary_load_ms * 1000 / repeat));
+  EXPECT_TRUE(SCH_EQUAL(text_schedule, input_schedule));
+  EXPECT_TRUE(SCH_EQUAL(loaded.schedule, input_schedule));
+  EXPECT_LT(FileSize(binary_file), FileSize(text_file));
+}
+}  // namespace akg
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "reduce_lib_test/akg_reduce_host.h"
+#include "akg_reduce/algorithm/deterministic_return.cuh"
+
+namespace akg {
+namespace {
+struct SumOp {
+  template <typename T>
+  T operator()(T a, T b) const {
+    return a + b;
+  }
+};
+
+// One launch of OutputSize x ReduceBlocks blocks, partials[out][block] is the partial result of a block.
+template <typename T, size_t OutputSize, size_t ReduceBlocks>
+struct Launch {
+  std::vector<std::vector<T>> partials;
+  std::vector<T> output;
+
+  explicit Launch(const std::vector<std::vector<T>> &partials) : partials(partials), output(OutputSize, T(-1)) {}
+
+  // every block returns on its own host thread after a random delay, so that blocks arrive in any order.
+  void AddBlocks(std::vector<std::thread> *blocks, std::mt19937 *rng) {
+    for (size_t out = 0; out < OutputSize; ++out) {
+      for (size_t block = 0; block < ReduceBlocks; ++block) {
+        int delay = std::uniform_int_distribution<int>(0, 200)(*rng);
+        blocks->emplace_back([this, out, block, delay]() {
+          std::this_thread::sleep_for(std::chrono::microseconds(delay));
+          akg_reduce::AkgDeterministicReturn<T, SumOp, OutputSize, ReduceBlocks>(
+            partials[out][block], &output[out], SumOp(), static_cast<int>(out), static_cast<int>(block));
+        });
+      }
+    }
+  }
+
+  void Run(std::mt19937 *rng) {
+    std::vector<std::thread> blocks;
+    AddBlocks(&blocks, rng);
+    for (auto &block : blocks) {
+      block.join();
+    }
+  }
+};
+
+bool NoLaunchInFlight() {
+  const akg_reduce::DeterministicLaunches &launches = akg_reduce::GetDeterministicLaunches();
+  for (int i = 0; i < akg_reduce::MAX_DETERMINISTIC_LAUNCHES; ++i) {
+    if (launches.keys[i] != 0 || launches.workspaces[i] != nullptr) {
+      return false;
+    }
+  }
+  return launches.lock == 0;
+}
+}  // namespace
+
+TEST(TestAkgReduceDeterministicReturn, Sum) {
+  std::mt19937 rng(7);
+  std::vector<std::vector<int>> partials(3, std::vector<int>(11));
+  std::vector<int> expect(3, 0);
+  for (size_t out = 0; out < partials.size(); ++out) {
+    for (size_t block = 0; block < partials[out].size(); ++block) {
+      partials[out][block] = static_cast<int>(1U << block) + static_cast<int>(out);
+      expect[out] += partials[out][block];
+    }
+  }
+  for (int repeat = 0; repeat < 4; ++repeat) {
+    Launch<int, 3, 11> launch(partials);
+    launch.Run(&rng);
+    EXPECT_EQ(launch.output, expect);
+    EXPECT_TRUE(NoLaunchInFlight());
+  }
+}
+
+// the float result only depends on the partial results, never on the order the blocks arrive in.
+TEST(TestAkgReduceDeterministicReturn, IndependentOfArrivalOrder) {
+  std::mt19937 rng(11);
+  std::vector<std::vector<float>> partials = {{1e8f, 1.0f, -1e8f, 1.0f, 3.5f, 1e-3f, 7.0f},
+                                              {-3.0f, 1e7f, 0.25f, -1e7f, 1e-4f, 2.0f, 1.0f}};
+  Launch<float, 2, 7> first(partials);
+  first.Run(&rng);
+  for (int repeat = 0; repeat < 8; ++repeat) {
+    Launch<float, 2, 7> launch(partials);
+    launch.Run(&rng);
+    EXPECT_EQ(launch.output, first.output);
+  }
+  EXPECT_TRUE(NoLaunchInFlight());
+}
+
+// launches of the same kernel on different streams write different outputs and keep their own workspaces.
+TEST(TestAkgReduceDeterministicReturn, ConcurrentLaunches) {
+  std::mt19937 rng(13);
+  std::vector<std::vector<int>> partials_a(4, std::vector<int>(5, 1));
+  std::vector<std::vector<int>> partials_b(4, std::vector<int>(5, 100));
+  for (int repeat = 0; repeat < 4; ++repeat) {
+    Launch<int, 4, 5> launch_a(partials_a);
+    Launch<int, 4, 5> launch_b(partials_b);
+    std::vector<std::thread> blocks;
+    launch_a.AddBlocks(&blocks, &rng);
+    launch_b.AddBlocks(&blocks, &rng);
+    for (auto &block : blocks) {
+      block.join();
+    }
+    EXPECT_EQ(launch_a.output, std::vector<int>(4, 5));
+    EXPECT_EQ(launch_b.output, std::vector<int>(4, 500));
+    EXPECT_TRUE(NoLaunchInFlight());
+  }
+}
+}  // namespace akg
@@ -0,0 +1,180 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UT_REDUCE_LIB_TEST_AKG_REDUCE_HOST_H_
+#define UT_REDUCE_LIB_TEST_AKG_REDUCE_HOST_H_
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Runs the device functions of akg_reduce on the host, every thread of one cuda block is a host thread.
+ * The cuda only headers of akg_reduce are skipped, the reduce algorithms only need utils/index.cuh.
+ * Device atomics and fences are the host ones, blocks that only meet in global memory are host threads as well.
+ */
+#define __device__
+#define __forceinline__ inline
+#define AKG_REDUCE_UTIL_H
+#define AKG_REDUCE_REDUCE_OPERATORS_H
+#include "akg_reduce/utils/index.cuh"
+
+namespace akg {
+class HostBlock {
+ public:
+  explicit HostBlock(int threads) : threads_(threads), block_barrier_(threads) {
+    for (int warp = 0; warp * akg_reduce::WARPSIZE < threads; ++warp) {
+      warps_.emplace_back(new Warp(std::min(akg_reduce::WARPSIZE, threads - warp * akg_reduce::WARPSIZE)));
+    }
+  }
+
+  // Runs kernel(tid) on every thread of the block, false when a thread waited for a sync the others never reached.
+  bool Run(const std::function<void(int)> &kernel) {
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < threads_; ++tid) {
+      threads.emplace_back([this, &kernel, tid]() {
+        Current() = this;
+        Tid() = tid;
+        kernel(tid);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    bool complete = !block_barrier_.Broken();
+    for (const auto &warp : warps_) {
+      complete = complete && !warp->barrier.Broken();
+    }
+    return complete;
+  }
+
+  void SyncThreads() { block_barrier_.Wait(); }
+
+  // __shfl_down_sync with a full mask, every thread of the warp has to call it.
+  template <typename T>
+  T ShflDown(T var, unsigned int delta, int width) {
+    static_assert(sizeof(T) <= sizeof(uint64_t), "shfl funcs move at most 64 bits");
+    Warp &warp = *warps_[Tid() / akg_reduce::WARPSIZE];
+    int lane = Tid() % akg_reduce::WARPSIZE;
+    std::memcpy(&warp.slots[lane], &var, sizeof(T));
+    warp.barrier.Wait();
+    int src = lane % width + static_cast<int>(delta) < width ? lane + static_cast<int>(delta) : lane;
+    T res = var;
+    if (src < warp.lanes) {
+      std::memcpy(&res, &warp.slots[src], sizeof(T));
+    }
+    warp.barrier.Wait();
+    return res;
+  }
+
+  static HostBlock *&Current() {
+    static thread_local HostBlock *block = nullptr;
+    return block;
+  }
+
+ private:
+  class Barrier {
+   public:
+    explicit Barrier(int count) : count_(count) {}
+
+    void Wait() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (broken_) {
+        return;
+      }
+      int generation = generation_;
+      if (++arrived_ == count_) {
+        arrived_ = 0;
+        ++generation_;
+        cv_.notify_all();
+        return;
+      }
+      // the threads of the block run concurrently, a barrier that is not complete by then never will be.
+      if (!cv_.wait_for(lock, std::chrono::seconds(2), [this, generation]() {
+            return broken_ || generation != generation_;
+          })) {
+        broken_ = true;
+        cv_.notify_all();
+      }
+    }
+
+    bool Broken() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return broken_;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int count_;
+    int arrived_{0};
+    int generation_{0};
+    bool broken_{false};
+  };
+
+  struct Warp {
+    explicit Warp(int lanes) : lanes(lanes), slots(akg_reduce::WARPSIZE), barrier(lanes) {}
+    int lanes;
+    std::vector<uint64_t> slots;
+    Barrier barrier;
+  };
+
+  static int &Tid() {
+    static thread_local int tid = 0;
+    return tid;
+  }
+
+  int threads_;
+  Barrier block_barrier_;
+  std::vector<std::unique_ptr<Warp>> warps_;
+};
+}  // namespace akg
+
+inline void __syncthreads() { akg::HostBlock::Current()->SyncThreads(); }
+
+inline void __threadfence() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+inline void __trap() { std::abort(); }
+
+template <typename T>
+T atomicAdd(T *address, T val) {
+  return __atomic_fetch_add(address, val, __ATOMIC_SEQ_CST);
+}
+
+template <typename T>
+T atomicCAS(T *address, T compare, T val) {
+  __atomic_compare_exchange_n(address, &compare, val, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return compare;
+}
+
+template <typename T>
+T atomicExch(T *address, T val) {
+  return __atomic_exchange_n(address, val, __ATOMIC_SEQ_CST);
+}
+
+template <typename T>
+T __shfl_down_sync(unsigned int mask, T var, unsigned int delta, int width = akg_reduce::WARPSIZE) {
+  return akg::HostBlock::Current()->ShflDown(var, delta, width);
+}
+
+#endif  // UT_REDUCE_LIB_TEST_AKG_REDUCE_HOST_H_
@@ -0,0 +1,47 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "gtest/gtest.h"
+#include "akg_reduce/utils/index.cuh"
+
+namespace akg {
+TEST(TestAkgReduceIndex, UpperBound) {
+  EXPECT_TRUE(akg_reduce::IsPowOfTwo(1));
+  EXPECT_TRUE(akg_reduce::IsPowOfTwo(32));
+  EXPECT_FALSE(akg_reduce::IsPowOfTwo(24));
+  EXPECT_EQ(akg_reduce::GetUpperBound(1), 1);
+  EXPECT_EQ(akg_reduce::GetUpperBound(32), 32);
+  EXPECT_EQ(akg_reduce::GetUpperBound(33), 32);
+  EXPECT_EQ(akg_reduce::GetUpperBound(1023), 512);
+  static_assert(akg_reduce::GetUpperBound(100) == 64, "GetUpperBound must stay a constant expression");
+}
+
+TEST(TestAkgReduceIndex, WarpRowReducible) {
+  EXPECT_TRUE(akg_reduce::IsWarpRowReducible(32, 256, 4));
+  EXPECT_TRUE(akg_reduce::IsWarpRowReducible(8, 32, 2));
+  EXPECT_FALSE(akg_reduce::IsWarpRowReducible(64, 256, 4));
+  EXPECT_FALSE(akg_reduce::IsWarpRowReducible(12, 48, 4));
+  EXPECT_FALSE(akg_reduce::IsWarpRowReducible(8, 16, 4));
+  EXPECT_FALSE(akg_reduce::IsWarpRowReducible(16, 64, 1));
+}
+
+TEST(TestAkgReduceIndex, AlignedSlotStride) {
+  EXPECT_EQ(akg_reduce::AlignedSlotStride(1, 4), 32U);
+  EXPECT_EQ(akg_reduce::AlignedSlotStride(32, 4), 32U);
+  EXPECT_EQ(akg_reduce::AlignedSlotStride(33, 4), 64U);
+  EXPECT_EQ(akg_reduce::AlignedSlotStride(100, 2), 128U);
+  EXPECT_EQ(akg_reduce::AlignedSlotStride(3, 8), 16U);
+}
+}  // namespace akg
@@ -0,0 +1,103 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vector>
+#include "gtest/gtest.h"
+#include "reduce_lib_test/akg_reduce_host.h"
+#include "akg_reduce/algorithm/shared_reduce.cuh"
+
+namespace akg {
+namespace {
+struct SumOp {
+  template <typename T>
+  T operator()(T a, T b) const {
+    return a + b;
+  }
+};
+
+std::vector<int> RowSums(const std::vector<int> &values, const int width) {
+  std::vector<int> sums(values.size() / width, 0);
+  for (size_t i = 0; i < values.size(); ++i) {
+    sums[i / width] += values[i];
+  }
+  return sums;
+}
+
+// rows of Width threads in a block of 64 threads, the first lane of every row gets the row sum.
+template <size_t Width>
+void CheckWarpRowReduce() {
+  const int threads = 64;
+  std::vector<int> values(threads);
+  for (int tid = 0; tid < threads; ++tid) {
+    values[tid] = tid * tid + 1;
+  }
+  std::vector<int> result(threads);
+  HostBlock block(threads);
+  ASSERT_TRUE(block.Run(
+    [&values, &result](int tid) { result[tid] = akg_reduce::WarpRowReduce<SumOp, Width>(values[tid], SumOp()); }));
+  std::vector<int> sums = RowSums(values, Width);
+  for (size_t row = 0; row < sums.size(); ++row) {
+    EXPECT_EQ(result[row * Width], sums[row]) << "width " << Width << ", row " << row;
+  }
+}
+
+// rows of BlockDimX threads, the result of every row is left at the head of the row in the shared buffer.
+template <size_t BlockDimX>
+void CheckHalvedReduce2DX(const int rows) {
+  const int threads = rows * static_cast<int>(BlockDimX);
+  std::vector<int> values(threads);
+  for (int tid = 0; tid < threads; ++tid) {
+    values[tid] = tid % 7 + 1;
+  }
+  std::vector<int> shared_buf(threads);
+  HostBlock block(threads);
+  ASSERT_TRUE(block.Run([&values, &shared_buf](int tid) {
+    akg_reduce::HalvedReduce2DX<SumOp, BlockDimX>(shared_buf.data(), values[tid], SumOp(),
+                                                  akg_reduce::RowLane(tid, BlockDimX),
+                                                  akg_reduce::RowIndex(tid, BlockDimX));
+  })) << "blockDim.x " << BlockDimX;
+  std::vector<int> sums = RowSums(values, BlockDimX);
+  for (int row = 0; row < rows; ++row) {
+    EXPECT_EQ(shared_buf[row * BlockDimX], sums[row]) << "blockDim.x " << BlockDimX << ", row " << row;
+  }
+}
+}  // namespace
+
+TEST(TestAkgReduceSharedReduce, WarpRowReduce) {
+  CheckWarpRowReduce<1>();
+  CheckWarpRowReduce<2>();
+  CheckWarpRowReduce<4>();
+  CheckWarpRowReduce<8>();
+  CheckWarpRowReduce<16>();
+  CheckWarpRowReduce<32>();
+}
+
+TEST(TestAkgReduceSharedReduce, HalvedReduce2DXPowOfTwo) {
+  CheckHalvedReduce2DX<1>(4);
+  CheckHalvedReduce2DX<8>(8);
+  CheckHalvedReduce2DX<32>(4);
+  CheckHalvedReduce2DX<64>(4);
+  CheckHalvedReduce2DX<256>(2);
+}
+
+// rows that are not a power of two wide do not line up with warps.
+TEST(TestAkgReduceSharedReduce, HalvedReduce2DXIrregular) {
+  CheckHalvedReduce2DX<3>(16);
+  CheckHalvedReduce2DX<12>(8);
+  CheckHalvedReduce2DX<24>(4);
+  CheckHalvedReduce2DX<48>(4);
+  CheckHalvedReduce2DX<100>(2);
+}
+}  // namespace akg
@@ -54,6 +54,21 @@
  *     Print offset shared memory when use total shared_memory of VisitStmt_(const Allocate* op)
  */
 
+/*
+ * 2021.3.10
+ *   Add function PrintCpAsync.
+ *   Modify the functions:
+ *     VisitStmt_(const Evaluate *op)
+ */
+
+/*
+ * 2021.3.15
+ *   Add function PrintFragmentEpilogue.
+ *   Modify the functions:
+ *     VisitStmt_(const Evaluate *op)
+ *     VisitExpr_(const Call *op, std::ostream& os)
+ */
+
 #include <tvm/base.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/packed_func_ext.h>
@@ -515,6 +530,14 @@ void CodeGenCUDA::VisitExpr_(const Call *op, std::ostream& os) {
       os << ")";
       return;
     }
+
+    if (op->name == AKG_FRAGMENT_ELEM) {
+      CHECK_EQ(op->args.size(), 1U);
+      const IntImm* index = op->args[0].as<IntImm>();
+      CHECK(index);
+      os << (index->value == 0 ? std::string("akg_acc") : "akg_epi_" + std::to_string(index->value)) << ".x[akg_e]";
+      return;
+    }
     CodeGenC::VisitExpr_(op, os);
   } else {
     CodeGenC::VisitExpr_(op, os);
@@ -621,11 +644,109 @@ void CodeGenCUDA::VisitStmt_(const Evaluate *op) {
     stream << "  " << vid_global_barrier_expect_ << " = 0;\n";
     PrintIndent();
     stream << "}\n";
+  } else if (call && (call->name == AKG_CP_ASYNC || call->name == AKG_CP_ASYNC_COMMIT ||
+                      call->name == AKG_CP_ASYNC_WAIT)) {
+    PrintCpAsync(call);
+  } else if (call && call->name == AKG_FRAGMENT_EPILOGUE) {
+    PrintFragmentEpilogue(call);
   } else {
     CodeGenC::VisitStmt_(op);
   }
 }
 
+void CodeGenCUDA::PrintCpAsync(const Call* op) {
+  std::string fallback;
+  std::string dst;
+  std::string src;
+  if (op->name == AKG_CP_ASYNC) {
+    CHECK_EQ(op->args.size(), 3U);
+    const IntImm* bytes = op->args[2].as<IntImm>();
+    CHECK(bytes && (bytes->value == 4 || bytes->value == 8 || bytes->value == 16));
+    dst = PrintExpr(op->args[0]);
+    src = PrintExpr(op->args[1]);
+    std::string type = bytes->value == 16 ? "uint4" : (bytes->value == 8 ? "uint2" : "unsigned");
+    fallback = "*(" + type + "*)(" + dst + ") = *(const " + type + "*)(" + src + ");\n";
+  }
+  stream << "#if defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 800)\n";
+  PrintIndent();
+  if (op->name == AKG_CP_ASYNC) {
+    stream << "asm volatile(\"cp.async.ca.shared.global [%0], [%1], " << PrintExpr(op->args[2])
+           << ";\\n\" :: \"r\"((unsigned)__cvta_generic_to_shared(" << dst << ")), \"l\"(" << src << "));\n";
+  } else if (op->name == AKG_CP_ASYNC_COMMIT) {
+    stream << "asm volatile(\"cp.async.commit_group;\\n\" ::);\n";
+  } else {
+    CHECK_EQ(op->args.size(), 1U);
+    stream << "asm volatile(\"cp.async.wait_group " << PrintExpr(op->args[0]) << ";\\n\" ::);\n";
+  }
+  if (!fallback.empty()) {
+    stream << "#else\n";
+    PrintIndent();
+    stream << fallback;
+  }
+  stream << "#endif\n";
+}
+
+void CodeGenCUDA::PrintFragmentEpilogue(const Call* op) {
+  // args: fragment, fragment index, m, n, k, value, output address, output ldm, then (address, ldm) of each operand.
+  CHECK_GE(op->args.size(), 8U);
+  CHECK_EQ(op->args.size() % 2, 0U);
+  need_mma_h_ = true;
+  const Call* dst = op->args[6].as<Call>();
+  CHECK(dst && dst->name == "&" && dst->args.size() == 1U);
+  Type out_type = dst->args[0].type();
+  std::string layout = "nvcuda::wmma::mem_row_major";
+
+  PrintIndent();
+  stream << "{\n";
+  int scope = BeginScope();
+  PrintIndent();
+  stream << "auto akg_acc = " << PrintExpr(op->args[0]) << "[" << PrintExpr(op->args[1]) << "];\n";
+  for (size_t i = 8; i < op->args.size(); i += 2) {
+    std::string epi = "akg_epi_" + std::to_string((i - 8) / 2 + 1);
+    PrintIndent();
+    stream << "auto " << epi << " = akg_acc;\n";
+    PrintIndent();
+    stream << wmma_scope << "::wmma::load_matrix_sync(" << epi << ", " << PrintExpr(op->args[i]) << ", "
+           << PrintExpr(op->args[i + 1]) << ", " << layout << ");\n";
+  }
+  std::string value = PrintExpr(op->args[5]);
+  PrintIndent();
+  stream << "#pragma unroll\n";
+  PrintIndent();
+  stream << "for (int akg_e = 0; akg_e < akg_acc.num_elements; ++akg_e) {\n";
+  PrintIndent();
+  stream << "  akg_acc.x[akg_e] = " << value << ";\n";
+  PrintIndent();
+  stream << "}\n";
+
+  std::string frag = "akg_acc";
+  if (out_type != op->type && wmma_scope != "akg") {
+    // nvcuda fragments do not convert on store, the converted copy shares the element layout of the accumulator.
+    frag = "akg_out";
+    PrintIndent();
+    stream << "nvcuda::wmma::fragment<nvcuda::wmma::accumulator, " << PrintExpr(op->args[2]) << ", "
+           << PrintExpr(op->args[3]) << ", " << PrintExpr(op->args[4]) << ", ";
+    PrintType(out_type, stream);
+    stream << "> akg_out;\n";
+    PrintIndent();
+    stream << "#pragma unroll\n";
+    PrintIndent();
+    stream << "for (int akg_e = 0; akg_e < akg_out.num_elements; ++akg_e) {\n";
+    PrintIndent();
+    stream << "  akg_out.x[akg_e] = (";
+    PrintType(out_type, stream);
+    stream << ")akg_acc.x[akg_e];\n";
+    PrintIndent();
+    stream << "}\n";
+  }
+  PrintIndent();
+  stream << wmma_scope << "::wmma::store_matrix_sync(" << PrintExpr(op->args[6]) << ", " << frag << ", "
+         << PrintExpr(op->args[7]) << ", " << layout << ");\n";
+  EndScope(scope);
+  PrintIndent();
+  stream << "}\n";
+}
+
 void CodeGenCUDA::VisitExpr_(const Ramp* op, std::ostream& os) {
   os << "((make_int" << op->lanes << ")(";
   for (int i = 0; i < op->lanes; i++) {
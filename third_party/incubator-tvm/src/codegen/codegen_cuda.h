@@ -61,6 +61,11 @@ constexpr auto PARIS_REDUCE = "paris_reduce::ParisReduce";
 constexpr auto PARIS_ATOMIC_RETURN = "paris_reduce::ParisReturn";
 constexpr auto ORIGIN_REDUCE_LIB = "origin";
 constexpr auto PARIS_REDUCE_LIB = "paris";
+constexpr auto AKG_CP_ASYNC = "akg_cp_async";
+constexpr auto AKG_CP_ASYNC_COMMIT = "akg_cp_async_commit";
+constexpr auto AKG_CP_ASYNC_WAIT = "akg_cp_async_wait";
+constexpr auto AKG_FRAGMENT_EPILOGUE = "akg_fragment_epilogue";
+constexpr auto AKG_FRAGMENT_ELEM = "akg_fragment_elem";
 
 class CodeGenCUDA final : public CodeGenC {
  public:
@@ -96,6 +101,10 @@ class CodeGenCUDA final : public CodeGenC {
   void VisitStmt_(const AttrStmt *op) final;
 
  private:
+  // Print the asynchronous global to shared copies, they fall back to plain copies before sm_80.
+  void PrintCpAsync(const Call* op);
+  // Print an elementwise epilogue evaluated on the accumulator fragment, followed by its store to the output.
+  void PrintFragmentEpilogue(const Call* op);
   // Handle volatile loads.
   void HandleVolatileLoads(const std::string& value, const Load* op,
                            std::ostream& os) final;